@@ -9,7 +9,14 @@ MAX_PACKET_SIZE = 48
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ProfilerControl = 3,
+    ProfilerDump = 4
+
+class ProfilerCommand(enum.IntEnum):
+    Disable = 0,
+    Enable = 1,
+    Reset = 2
 
 CITRA_PORT = 45987
 
@@ -90,6 +97,35 @@ class Citra:
                 return False
         return True
 
+    def _profiler_request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        return self._read_and_validate_header(raw_reply, request_id, request_type)
+
+    def set_profiler_enabled(self, enabled):
+        """
+        Starts or stops recording SVC and HLE service call timings.
+        """
+        command = ProfilerCommand.Enable if enabled else ProfilerCommand.Disable
+        return None != self._profiler_request(RequestType.ProfilerControl, struct.pack("I", command))
+
+    def reset_profiler(self):
+        return None != self._profiler_request(RequestType.ProfilerControl,
+                                              struct.pack("I", ProfilerCommand.Reset))
+
+    def dump_profiler(self):
+        """
+        Writes the recorded call timings as JSON to hle_profile.json in the log directory and
+        returns the number of bytes written.
+        """
+        reply_data = self._profiler_request(RequestType.ProfilerDump, bytes())
+        if reply_data and len(reply_data) == 4:
+            return struct.unpack("I", reply_data)[0]
+        return None
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
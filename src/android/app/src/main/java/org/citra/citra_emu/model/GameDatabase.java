@@ -146,7 +146,7 @@ public final class GameDatabase extends SQLiteOpenHelper {
                 null);    // Order of folders is irrelevant.
 
         Set<String> allowedExtensions = new HashSet<String>(Arrays.asList(
-                ".3ds", ".3dsx", ".elf", ".axf", ".cci", ".cxi", ".app", ".rar", ".zip", ".7z", ".torrent", ".tar", ".gz"));
+                ".3ds", ".3dsx", ".elf", ".axf", ".cci", ".cxi", ".app", ".z3ds", ".zcci", ".zcxi", ".rar", ".zip", ".7z", ".torrent", ".tar", ".gz"));
 
         // Possibly overly defensive, but ensures that moveToNext() does not skip a row.
         folderCursor.moveToPosition(-1);
@@ -187,7 +187,8 @@ public final class GameDatabase extends SQLiteOpenHelper {
         for (CheapDocument file : files) {
             if (file.isDirectory()) {
                 Set<String> newExtensions = new HashSet<>(Arrays.asList(
-                        ".3ds", ".3dsx", ".elf", ".axf", ".cci", ".cxi", ".app"));
+                        ".3ds", ".3dsx", ".elf", ".axf", ".cci", ".cxi", ".app", ".z3ds", ".zcci",
+                        ".zcxi"));
                 CheapDocument[] children = FileUtil.listFiles(mContext, file.getUri());
                 this.addGamesRecursive(database, children, newExtensions, depth - 1);
             } else {
@@ -135,6 +135,8 @@ void Config::ReadValues() {
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
+    Settings::values.texture_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "texture_cache_budget", 0));
     Settings::values.use_disk_shader_cache =
         sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
     Settings::values.use_vsync_new = sdl2_config->GetBoolean("Renderer", "use_vsync_new", true);
@@ -197,6 +199,8 @@ void Config::ReadValues() {
     Settings::values.custom_textures = sdl2_config->GetBoolean("Utility", "custom_textures", false);
     Settings::values.preload_textures =
         sdl2_config->GetBoolean("Utility", "preload_textures", false);
+    Settings::values.custom_textures_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Utility", "custom_textures_budget", 1024));
 
     // Audio
     Settings::values.audio_emulation =
@@ -152,6 +152,11 @@ use_disk_shader_cache =
 # factor for the 3DS resolution
 resolution_factor =
 
+# Host memory budget of the texture cache in MiB. Surfaces that have not been used recently are
+# evicted once it is exceeded.
+# 0 (default): Unlimited, Otherwise the budget in MiB
+texture_cache_budget =
+
 # Whether to enable V-Sync (caps the framerate at 60FPS) or not.
 # 0 (default): Off, 1: On
 vsync_enabled =
@@ -237,6 +242,11 @@ custom_textures =
 # 0 (default): Off, 1: On
 preload_textures =
 
+# Host memory budget of decoded custom textures in MiB. The least recently used ones are dropped
+# once it is exceeded, and preloading stops when it is filled.
+# 0: Unlimited, Otherwise the budget in MiB. 1024 (default)
+custom_textures_budget =
+
 [Audio]
 # Whether or not to enable DSP LLE
 # 0 (default): No, 1: Yes
@@ -64,9 +64,8 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     std::size_t frames_written;
     if (perform_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
+        const std::size_t num_in = fifo.Pop(stretch_input.data(), stretch_input.size() / 2);
+        frames_written = time_stretcher.Process(stretch_input.data(), num_in, buffer, num_frames);
     } else if (flushing_time_stretcher) {
         time_stretcher.Flush();
         frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
@@ -100,6 +100,11 @@ public:
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
 
+    /// Returns the latency and processing time counters of audio stretching
+    TimeStretcher::Stats GetStretchingStats() const {
+        return time_stretcher.GetStats();
+    }
+
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
@@ -111,6 +116,8 @@ private:
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
+    /// Scratch space the output callback pops into when stretching, to avoid allocating per pop
+    std::array<s16, 0x2000 * 2> stretch_input{};
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <thread>
+#include <utility>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
@@ -145,8 +147,15 @@ struct DspLle::Impl final {
     std::atomic<bool> stop_signal = false;
     std::size_t stop_generation;
 
+    /// DSP cycles already run by synchronous waits that the next periodic slice can skip. Never
+    /// more than one slice, so a long wait cannot starve the periodic slices that follow it.
+    u32 cycles_ahead = 0;
+
     static constexpr u32 DspDataOffset = 0x40000;
     static constexpr u32 TeakraSlice = 16384;
+    /// First step of a synchronous wait. Most register handshakes complete within it, longer
+    /// waits double the step up to a whole slice.
+    static constexpr u32 TeakraSyncSlice = 2048;
 
     void TeakraThread() {
         while (true) {
@@ -169,11 +178,35 @@ struct DspLle::Impl final {
         }
     }
 
+    /**
+     * Runs the DSP until the given condition holds. In single-threaded mode the wait starts with a
+     * short step and doubles it up to a whole slice, so handshakes stay short while long waits
+     * run in full batches. The cycles spent are credited against the next periodic slice, up to
+     * one slice, so pipe and register traffic does not make the DSP run ahead of the emulated
+     * clock.
+     */
+    template <typename Condition>
+    void RunTeakraUntil(Condition&& condition) {
+        u32 step = TeakraSyncSlice;
+        while (!condition()) {
+            if (multithread) {
+                teakra_slice_barrier.Sync();
+                continue;
+            }
+            teakra.Run(step);
+            cycles_ahead = std::min(cycles_ahead + step, TeakraSlice);
+            step = std::min(step * 2, TeakraSlice);
+        }
+    }
+
     void RunTeakraSlice() {
         if (multithread) {
             teakra_slice_barrier.Sync();
-        } else {
-            teakra.Run(TeakraSlice);
+            return;
+        }
+        const u32 credit = std::exchange(cycles_ahead, 0);
+        if (credit < TeakraSlice) {
+            teakra.Run(TeakraSlice - credit);
         }
     }
 
@@ -250,8 +283,7 @@ struct DspLle::Impl final {
         }
         if (need_update) {
             UpdatePipeStatus(pipe_status);
-            while (!teakra.SendDataIsEmpty(2))
-                RunTeakraSlice();
+            RunTeakraUntil([this] { return teakra.SendDataIsEmpty(2); });
             teakra.SendData(2, pipe_status.slot_index);
         }
     }
@@ -287,8 +319,7 @@ struct DspLle::Impl final {
         }
         if (need_update) {
             UpdatePipeStatus(pipe_status);
-            while (!teakra.SendDataIsEmpty(2))
-                RunTeakraSlice();
+            RunTeakraUntil([this] { return teakra.SendDataIsEmpty(2); });
             teakra.SendData(2, pipe_status.slot_index);
         }
         return data;
@@ -325,6 +356,7 @@ struct DspLle::Impl final {
 
         // TODO: load special segment
 
+        cycles_ahead = 0;
         Core::System::GetInstance().CoreTiming().ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
 
         if (multithread) {
@@ -335,15 +367,13 @@ struct DspLle::Impl final {
         if (dsp.recv_data_on_start) {
             for (u8 i = 0; i < 3; ++i) {
                 do {
-                    while (!teakra.RecvDataIsReady(i))
-                        RunTeakraSlice();
+                    RunTeakraUntil([this, i] { return teakra.RecvDataIsReady(i); });
                 } while (teakra.RecvData(i) != 1);
             }
         }
 
         // Get pipe base address
-        while (!teakra.RecvDataIsReady(2))
-            RunTeakraSlice();
+        RunTeakraUntil([this] { return teakra.RecvDataIsReady(2); });
         pipe_base_waddr = teakra.RecvData(2);
 
         loaded = true;
@@ -359,14 +389,12 @@ struct DspLle::Impl final {
 
         // Send finalization signal via command/reply register 2
         constexpr u16 FinalizeSignal = 0x8000;
-        while (!teakra.SendDataIsEmpty(2))
-            RunTeakraSlice();
+        RunTeakraUntil([this] { return teakra.SendDataIsEmpty(2); });
 
         teakra.SendData(2, FinalizeSignal);
 
         // Wait for completion
-        while (!teakra.RecvDataIsReady(2))
-            RunTeakraSlice();
+        RunTeakraUntil([this] { return teakra.RecvDataIsReady(2); });
 
         teakra.RecvData(2); // discard the value
 
@@ -376,9 +404,9 @@ struct DspLle::Impl final {
 };
 
 u16 DspLle::RecvData(u32 register_number) {
-    while (!impl->teakra.RecvDataIsReady(register_number)) {
-        impl->RunTeakraSlice();
-    }
+    impl->RunTeakraUntil([this, register_number] {
+        return impl->teakra.RecvDataIsReady(static_cast<u8>(register_number));
+    });
     return impl->teakra.RecvData(static_cast<u8>(register_number));
 }
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <memory>
@@ -13,12 +14,24 @@
 
 namespace AudioCore {
 
+namespace {
+constexpr double MaxLatency = 0.25; // seconds
+
+// Hysteresis for switching between SoundTouch and the rate-only resampler.
+constexpr double EnterRateOnlyDeviation = 0.005;
+constexpr double LeaveRateOnlyDeviation = 0.02;
+} // Anonymous namespace
+
 TimeStretcher::TimeStretcher()
     : sample_rate(native_sample_rate), sound_touch(std::make_unique<soundtouch::SoundTouch>()) {
     sound_touch->setChannels(2);
     sound_touch->setSampleRate(native_sample_rate);
     sound_touch->setPitch(1.0);
     sound_touch->setTempo(1.0);
+    // The quick seek search is several times cheaper with no audible difference for game audio.
+    sound_touch->setSetting(SETTING_USE_QUICKSEEK, 1);
+
+    rate_backlog.reserve(static_cast<std::size_t>(native_sample_rate * MaxLatency * 4.0) * 2 * 2);
 }
 
 TimeStretcher::~TimeStretcher() = default;
@@ -30,12 +43,12 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
 
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
+    const auto start_time = std::chrono::steady_clock::now();
     const double time_delta = static_cast<double>(num_out) / sample_rate; // seconds
     double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
 
-    const double max_latency = 0.25; // seconds
-    const double max_backlog = sample_rate * max_latency;
-    const double backlog_fullness = sound_touch->numSamples() / max_backlog;
+    const double max_backlog = sample_rate * MaxLatency;
+    const double backlog_fullness = BackloggedFrames() / max_backlog;
     if (backlog_fullness > 4.0) {
         // Too many samples in backlog: Don't push anymore on
         num_in = 0;
@@ -57,21 +70,130 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     // Place a lower limit of 5% speed. When a game boots up, there will be
     // many silence samples. These do not need to be timestretched.
     stretch_ratio = std::max(stretch_ratio, 0.05);
-    sound_touch->setTempo(stretch_ratio);
 
-    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f}", num_in, num_out, stretch_ratio,
-              backlog_fullness);
+    const double deviation = std::abs(stretch_ratio - 1.0);
+    if (rate_only && deviation > LeaveRateOnlyDeviation) {
+        LeaveRateOnly();
+    } else if (!rate_only && deviation < EnterRateOnlyDeviation) {
+        EnterRateOnly();
+    }
+
+    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f} rate_only:{}", num_in, num_out,
+              stretch_ratio, backlog_fullness, rate_only);
+
+    std::size_t frames_written;
+    if (rate_only) {
+        frames_written = ProcessRateOnly(in, num_in, out, num_out);
+        frames_resampled += frames_written;
+    } else {
+        sound_touch->setTempo(stretch_ratio);
+        sound_touch->putSamples(in, static_cast<u32>(num_in));
+        frames_written = sound_touch->receiveSamples(out, static_cast<u32>(num_out));
+        frames_stretched += frames_written;
+    }
 
-    sound_touch->putSamples(in, static_cast<u32>(num_in));
-    return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
+    latency_ms = BackloggedFrames() * 1000.0 / sample_rate;
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+    process_time_us += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    return frames_written;
+}
+
+std::size_t TimeStretcher::ProcessRateOnly(const s16* in, std::size_t num_in, s16* out,
+                                           std::size_t num_out) {
+    if (rate_backlog.size() + num_in * 2 > rate_backlog.capacity()) {
+        CompactRateBacklog();
+    }
+    const std::size_t space = (rate_backlog.capacity() - rate_backlog.size()) / 2;
+    num_in = std::min(num_in, space);
+    if (num_in > 0) {
+        rate_backlog.insert(rate_backlog.end(), in, in + num_in * 2);
+    }
+
+    // Linear interpolation needs one frame of lookahead.
+    const std::size_t num_frames = rate_backlog.size() / 2 - rate_start;
+    std::size_t frames_written = 0;
+    while (frames_written < num_out && rate_position + 1.0 < static_cast<double>(num_frames)) {
+        const auto index = static_cast<std::size_t>(rate_position);
+        const double frac = rate_position - static_cast<double>(index);
+        const s16* frame = &rate_backlog[(rate_start + index) * 2];
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const double sample = frame[channel] + frac * (frame[channel + 2] - frame[channel]);
+            *out++ = static_cast<s16>(sample);
+        }
+        rate_position += stretch_ratio;
+        frames_written++;
+    }
+
+    // Consumed frames are only dropped once their space is needed, see CompactRateBacklog.
+    const auto consumed = std::min(static_cast<std::size_t>(rate_position), num_frames);
+    rate_start += consumed;
+    rate_position -= static_cast<double>(consumed);
+    if (rate_start * 2 == rate_backlog.size()) {
+        rate_backlog.clear();
+        rate_start = 0;
+    }
+
+    return frames_written;
+}
+
+void TimeStretcher::CompactRateBacklog() {
+    rate_backlog.erase(rate_backlog.begin(), rate_backlog.begin() + rate_start * 2);
+    rate_start = 0;
+}
+
+void TimeStretcher::EnterRateOnly() {
+    // Hand over the output SoundTouch has ready. The input it has not processed yet stays in
+    // SoundTouch, ahead of anything LeaveRateOnly puts back, so no audio is dropped or padded.
+    CompactRateBacklog();
+    const std::size_t space = (rate_backlog.capacity() - rate_backlog.size()) / 2;
+    const auto num_frames =
+        static_cast<u32>(std::min<std::size_t>(sound_touch->numSamples(), space));
+    const std::size_t old_size = rate_backlog.size();
+    rate_backlog.resize(old_size + num_frames * 2);
+    const u32 received = sound_touch->receiveSamples(rate_backlog.data() + old_size, num_frames);
+    rate_backlog.resize(old_size + received * 2);
+    rate_only = true;
+    mode_switches++;
+}
+
+void TimeStretcher::LeaveRateOnly() {
+    const std::size_t num_frames = rate_backlog.size() / 2 - rate_start;
+    const auto start = rate_start + std::min(static_cast<std::size_t>(rate_position), num_frames);
+    sound_touch->putSamples(rate_backlog.data() + start * 2,
+                            static_cast<u32>(rate_backlog.size() / 2 - start));
+    rate_backlog.clear();
+    rate_start = 0;
+    rate_position = 0.0;
+    rate_only = false;
+    mode_switches++;
+}
+
+std::size_t TimeStretcher::BackloggedFrames() const {
+    return sound_touch->numSamples() + rate_backlog.size() / 2 - rate_start;
 }
 
 void TimeStretcher::Clear() {
     sound_touch->clear();
+    rate_backlog.clear();
+    rate_start = 0;
+    rate_position = 0.0;
 }
 
 void TimeStretcher::Flush() {
+    if (rate_only) {
+        LeaveRateOnly();
+    }
     sound_touch->flush();
 }
 
+TimeStretcher::Stats TimeStretcher::GetStats() const {
+    return {
+        .frames_stretched = frames_stretched,
+        .frames_resampled = frames_resampled,
+        .mode_switches = mode_switches,
+        .process_time_us = process_time_us,
+        .latency_ms = latency_ms,
+    };
+}
+
 } // namespace AudioCore
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include "common/common_types.h"
 
 namespace soundtouch {
@@ -17,6 +19,15 @@ namespace AudioCore {
 
 class TimeStretcher {
 public:
+    /// Counters accumulated since construction
+    struct Stats {
+        u64 frames_stretched{}; ///< Output frames produced by SoundTouch
+        u64 frames_resampled{}; ///< Output frames produced by the rate-only resampler
+        u64 mode_switches{};    ///< Switches between SoundTouch and the rate-only resampler
+        u64 process_time_us{};  ///< Host time spent processing audio
+        double latency_ms{};    ///< Audio buffered in the stretcher after the last call
+    };
+
     TimeStretcher();
     ~TimeStretcher();
 
@@ -33,10 +44,44 @@ public:
 
     void Flush();
 
+    /// Returns the counters. Safe to call from any thread.
+    Stats GetStats() const;
+
 private:
+    /// Cheap linear resampler used instead of SoundTouch while the stretch ratio is close to 1.0.
+    /// This changes pitch by at most the ratio deviation, which is inaudible in that range.
+    std::size_t ProcessRateOnly(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+
+    /// Moves the audio SoundTouch has finished processing into the rate-only resampler
+    void EnterRateOnly();
+
+    /// Drops the consumed frames from the front of rate_backlog to make room at its end
+    void CompactRateBacklog();
+
+    /// Moves any audio buffered by the rate-only resampler into SoundTouch
+    void LeaveRateOnly();
+
+    /// @returns Number of frames buffered in either processing path
+    std::size_t BackloggedFrames() const;
+
     unsigned int sample_rate;
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+
+    bool rate_only = false;
+    /// Interleaved stereo frames awaiting rate-only resampling. Capacity is reserved up front so
+    /// that the output path does not allocate.
+    std::vector<s16> rate_backlog;
+    /// First frame of rate_backlog that has not been consumed yet
+    std::size_t rate_start = 0;
+    /// Fractional read position relative to rate_start, in frames
+    double rate_position = 0.0;
+
+    std::atomic<u64> frames_stretched = 0;
+    std::atomic<u64> frames_resampled = 0;
+    std::atomic<u64> mode_switches = 0;
+    std::atomic<u64> process_time_us = 0;
+    std::atomic<double> latency_ms = 0.0;
 };
 
 } // namespace AudioCore
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -20,6 +21,7 @@
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "common/string_util.h"
+#include "common/zstd_seekable.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
 #include "core/frontend/applets/default_applets.h"
@@ -55,6 +57,8 @@ static void PrintHelp(const char* argv0) {
               << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER Enable gdb stub on port NUMBER\n"
                  "-i, --install=FILE    Installs a specified CIA file\n"
+                 "-z, --compress=FILE   Compresses a .3ds, .cci, .cxi or .cia file for loading\n"
+                 "                      as .z3ds, .zcci, .zcxi or .zcia\n"
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
@@ -66,6 +70,44 @@ static void PrintHelp(const char* argv0) {
                  "-v, --version        Output version information and exit\n";
 }
 
+/// Packs a ROM into the seekable compressed container next to it
+static bool CompressRom(const std::string& source_path) {
+    std::string extension;
+    Common::SplitPath(source_path, nullptr, nullptr, &extension);
+    const std::string dest_path =
+        source_path.substr(0, source_path.size() - extension.size()) + ".z" +
+        extension.substr(std::min<std::size_t>(1, extension.size()));
+    if (!Common::Compression::IsCompressedRomPath(dest_path)) {
+        std::cout << "Only .3ds, .cci, .cxi and .cia files can be compressed\n";
+        return false;
+    }
+
+    FileUtil::IOFile source(source_path, "rb");
+    FileUtil::IOFile dest(dest_path, "wb");
+    if (!source.IsOpen() || !dest.IsOpen()) {
+        LOG_ERROR(Frontend, "Failed to open {} or {}", source_path, dest_path);
+        return false;
+    }
+
+    const auto progress = [](u64 processed, u64 total) {
+        LOG_INFO(Frontend, "{:02d}%", processed * 100 / total);
+    };
+    // Frames decompress at the same speed at any level, so favour a smaller file
+    constexpr s32 CompressionLevel = 19;
+    if (!Common::Compression::CompressFileSeekable(source, dest, CompressionLevel,
+                                                   Common::Compression::DefaultSeekableFrameSize,
+                                                   progress)) {
+        LOG_ERROR(Frontend, "Failed to compress {}", source_path);
+        dest.Close();
+        FileUtil::Delete(dest_path);
+        return false;
+    }
+
+    LOG_INFO(Frontend, "Compressed {} to {}, {} -> {} bytes", source_path, dest_path,
+             source.GetSize(), dest.GetSize());
+    return true;
+}
+
 static void PrintVersion() {
     std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
 }
@@ -216,6 +258,7 @@ int main(int argc, char** argv) {
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'},
         {"install", required_argument, 0, 'i'},
+        {"compress", required_argument, 0, 'z'},
         {"multiplayer", required_argument, 0, 'm'},
         {"movie-record", required_argument, 0, 'r'},
         {"movie-record-author", required_argument, 0, 'a'},
@@ -228,7 +271,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:z:m:r:p:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -253,6 +296,8 @@ int main(int argc, char** argv) {
                     exit(1);
                 break;
             }
+            case 'z':
+                return CompressRom(std::string(optarg)) ? 0 : 1;
             case 'm': {
                 use_multiplayer = true;
                 const std::string str_arg(optarg);
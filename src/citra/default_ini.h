@@ -136,6 +136,11 @@ use_disk_shader_cache =
 # factor for the 3DS resolution
 resolution_factor =
 
+# Host memory budget of the texture cache in MiB. Surfaces that have not been used recently are
+# evicted once it is exceeded.
+# 0 (default): Unlimited, Otherwise the budget in MiB
+texture_cache_budget =
+
 # Texture filter name
 texture_filter_name =
 
@@ -235,6 +240,11 @@ custom_textures =
 # 0 (default): Off, 1: On
 preload_textures =
 
+# Host memory budget of decoded custom textures in MiB. The least recently used ones are dropped
+# once it is exceeded, and preloading stops when it is filled.
+# 0: Unlimited, Otherwise the budget in MiB. 1024 (default)
+custom_textures_budget =
+
 [Audio]
 # Whether or not to enable DSP LLE
 # 0 (default): No, 1: Yes
@@ -344,6 +354,13 @@ web_api_url = https://api.citra-emu.org
 citra_username =
 citra_token =
 
+[Multiplayer]
+# Whether to exchange local wireless frames directly with other room members that enable this too,
+# instead of relaying them through the room. Your IP address is shared with those members. Only
+# works in rooms that allow it, e.g. citra-room with --allow-direct-connections.
+# 0 (default): No, 1: Yes
+enable_direct_connections =
+
 [Video Dumping]
 # Format of the video to output, default: webm
 output_format =
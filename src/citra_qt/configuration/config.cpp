@@ -440,6 +440,10 @@ void Config::ReadUtilityValues() {
     ReadGlobalSetting(Settings::values.custom_textures);
     ReadGlobalSetting(Settings::values.preload_textures);
 
+    if (global) {
+        ReadBasicSetting(Settings::values.custom_textures_budget);
+    }
+
     qt_config->endGroup();
 }
 
@@ -553,6 +557,8 @@ void Config::ReadMultiplayerValues() {
     UISettings::values.game_id = ReadSetting(QStringLiteral("game_id"), 0).toULongLong();
     UISettings::values.room_description =
         ReadSetting(QStringLiteral("room_description"), QString{}).toString();
+    NetSettings::values.enable_direct_connections =
+        ReadSetting(QStringLiteral("enable_direct_connections"), false).toBool();
     // Read ban list back
     int size = qt_config->beginReadArray(QStringLiteral("username_ban_list"));
     UISettings::values.ban_list.first.resize(size);
@@ -653,6 +659,7 @@ void Config::ReadRendererValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
+        ReadBasicSetting(Settings::values.texture_cache_budget);
     }
 
     qt_config->endGroup();
@@ -961,6 +968,10 @@ void Config::SaveUtilityValues() {
     WriteGlobalSetting(Settings::values.custom_textures);
     WriteGlobalSetting(Settings::values.preload_textures);
 
+    if (global) {
+        WriteBasicSetting(Settings::values.custom_textures_budget);
+    }
+
     qt_config->endGroup();
 }
 
@@ -1063,6 +1074,8 @@ void Config::SaveMultiplayerValues() {
     WriteSetting(QStringLiteral("game_id"), UISettings::values.game_id, 0);
     WriteSetting(QStringLiteral("room_description"), UISettings::values.room_description,
                  QString{});
+    WriteSetting(QStringLiteral("enable_direct_connections"),
+                 NetSettings::values.enable_direct_connections, false);
     // Write ban list
     qt_config->beginWriteArray(QStringLiteral("username_ban_list"));
     for (std::size_t i = 0; i < UISettings::values.ban_list.first.size(); ++i) {
@@ -1137,6 +1150,7 @@ void Config::SaveRendererValues() {
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
                      true);
+        WriteBasicSetting(Settings::values.texture_cache_budget);
     }
 
     qt_config->endGroup();
@@ -15,6 +15,7 @@
 #include "citra_qt/uisettings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/zstd_seekable.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
@@ -86,6 +87,11 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
                 return true;
             }
 
+            // Compressed ROMs are listed with the size of the ROM they hold
+            const u64 size = Common::Compression::IsCompressedRomPath(physical_name)
+                                 ? FileUtil::IOFile(physical_name, "rb").GetSize()
+                                 : FileUtil::GetSize(physical_name);
+
             auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
             // The game list uses this as compatibility number for untested games
@@ -101,7 +107,7 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
                     new GameListItemRegion(smdh),
                     new GameListItem(
                         QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
+                    new GameListItemSize(size),
                 },
                 parent_dir);
 
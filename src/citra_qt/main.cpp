@@ -1134,7 +1134,7 @@ bool GMainWindow::LoadROM(const QString& filename) {
 }
 
 void GMainWindow::BootGame(const QString& filename) {
-    if (filename.endsWith(QStringLiteral(".cia"))) {
+    if (filename.endsWith(QStringLiteral(".cia")) || filename.endsWith(QStringLiteral(".zcia"))) {
         const auto answer = QMessageBox::question(
             this, tr("CIA must be installed before usage"),
             tr("Before using this CIA, you must install it. Do you want to install it now?"),
@@ -1655,7 +1655,8 @@ void GMainWindow::OnMenuLoadFile() {
 void GMainWindow::OnMenuInstallCIA() {
     QStringList filepaths = QFileDialog::getOpenFileNames(
         this, tr("Load Files"), UISettings::values.roms_path,
-        tr("3DS Installation File (*.CIA*)") + QStringLiteral(";;") + tr("All Files (*.*)"));
+        tr("3DS Installation File (*.CIA* *.ZCIA*)") + QStringLiteral(";;") +
+            tr("All Files (*.*)"));
 
     if (filepaths.isEmpty()) {
         return;
@@ -2499,8 +2500,8 @@ static bool IsSingleFileDropEvent(const QMimeData* mime) {
     return mime->hasUrls() && mime->urls().length() == 1;
 }
 
-static const std::array<std::string, 8> AcceptedExtensions = {"cci",  "3ds", "cxi", "bin",
-                                                              "3dsx", "app", "elf", "axf"};
+static const std::array<std::string, 11> AcceptedExtensions = {
+    "cci", "3ds", "cxi", "bin", "3dsx", "app", "elf", "axf", "zcci", "z3ds", "zcxi"};
 
 static bool IsCorrectFileExtension(const QMimeData* mime) {
     const QString& filename = mime->urls().at(0).toLocalFile();
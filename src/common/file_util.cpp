@@ -14,6 +14,7 @@
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/zstd_seekable.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -1042,6 +1043,8 @@ void IOFile::Swap(IOFile& other) noexcept {
     std::swap(m_file, other.m_file);
     std::swap(m_fd, other.m_fd);
     std::swap(m_good, other.m_good);
+    std::swap(seekable, other.seekable);
+    std::swap(seekable_pos, other.seekable_pos);
     std::swap(filename, other.filename);
     std::swap(openmode, other.openmode);
     std::swap(flags, other.flags);
@@ -1094,10 +1097,28 @@ bool IOFile::Open() {
     m_good = m_file != nullptr;
 #endif
 
+    if (m_good && openmode == "rb" && Common::Compression::IsCompressedRomPath(filename)) {
+        // The reader takes over the raw handle, or shares the one of another file on this path
+        IOFile raw;
+        std::swap(raw.m_file, m_file);
+        std::swap(raw.m_fd, m_fd);
+        raw.filename = filename;
+        raw.openmode = openmode;
+        seekable = Common::Compression::SeekableReader::Open(filename, std::move(raw));
+        seekable_pos = 0;
+        m_good = seekable != nullptr;
+    }
+
     return m_good;
 }
 
 bool IOFile::Close() {
+    if (seekable) {
+        seekable.reset();
+        seekable_pos = 0;
+        return m_good;
+    }
+
     if (!IsOpen() || 0 != std::fclose(m_file))
         m_good = false;
 
@@ -1106,6 +1127,9 @@ bool IOFile::Close() {
 }
 
 u64 IOFile::GetSize() const {
+    if (seekable)
+        return seekable->GetSize();
+
     if (IsOpen())
         return FileUtil::GetSize(m_file);
 
@@ -1113,6 +1137,18 @@ u64 IOFile::GetSize() const {
 }
 
 bool IOFile::Seek(s64 off, int origin) {
+    if (seekable) {
+        const s64 base = origin == SEEK_CUR   ? static_cast<s64>(seekable_pos)
+                         : origin == SEEK_END ? static_cast<s64>(seekable->GetSize())
+                                              : 0;
+        if (base + off < 0) {
+            m_good = false;
+        } else {
+            seekable_pos = static_cast<u64>(base + off);
+        }
+        return m_good;
+    }
+
     if (!IsOpen() || 0 != fseeko(m_file, off, origin))
         m_good = false;
 
@@ -1120,6 +1156,9 @@ bool IOFile::Seek(s64 off, int origin) {
 }
 
 u64 IOFile::Tell() const {
+    if (seekable)
+        return seekable_pos;
+
     if (IsOpen())
         return ftello(m_file);
 
@@ -1127,6 +1166,9 @@ u64 IOFile::Tell() const {
 }
 
 bool IOFile::Flush() {
+    if (seekable)
+        return m_good;
+
     if (!IsOpen() || 0 != std::fflush(m_file))
         m_good = false;
 
@@ -1145,11 +1187,17 @@ std::size_t IOFile::ReadImpl(void* data, std::size_t length, std::size_t data_si
 
     DEBUG_ASSERT(data != nullptr);
 
+    if (seekable) {
+        const std::size_t read = seekable->Read(seekable_pos, data, length * data_size);
+        seekable_pos += read;
+        return read / data_size;
+    }
+
     return std::fread(data, data_size, length, m_file);
 }
 
 std::size_t IOFile::WriteImpl(const void* data, std::size_t length, std::size_t data_size) {
-    if (!IsOpen()) {
+    if (!IsOpen() || seekable) {
         m_good = false;
         return std::numeric_limits<std::size_t>::max();
     }
@@ -1164,7 +1212,7 @@ std::size_t IOFile::WriteImpl(const void* data, std::size_t length, std::size_t
 }
 
 bool IOFile::Resize(u64 size) {
-    if (!IsOpen() || 0 !=
+    if (!IsOpen() || seekable || 0 !=
 #ifdef _WIN32
                          // ector: _chsize sucks, not 64-bit safe
                          // F|RES: changed to _chsize_s. i think it is 64-bit safe
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -22,6 +23,10 @@
 #include "common/string_util.h"
 #endif
 
+namespace Common::Compression {
+class SeekableReader;
+}
+
 namespace FileUtil {
 
 // User paths for GetUserPath
@@ -264,6 +269,10 @@ enum class DirectorySeparator {
 // simple wrapper for cstdlib file functions to
 // hopefully will make error checking easier
 // and make forgetting an fclose() harder
+/**
+ * A file handle. Compressed ROMs (see Common::Compression::IsCompressedRomPath) opened read-only
+ * are transparently decompressed: reads, seeks and sizes refer to the uncompressed data.
+ */
 class IOFile : public NonCopyable {
 public:
     IOFile();
@@ -329,7 +338,7 @@ public:
     }
 
     [[nodiscard]] bool IsOpen() const {
-        return nullptr != m_file;
+        return nullptr != m_file || seekable != nullptr;
     }
 
     // m_good is set to false when a read, write or other function fails
@@ -361,7 +370,9 @@ public:
     // clear error state
     void Clear() {
         m_good = true;
-        std::clearerr(m_file);
+        if (m_file) {
+            std::clearerr(m_file);
+        }
     }
 
 private:
@@ -374,6 +385,10 @@ private:
     int m_fd = -1;
     bool m_good = true;
 
+    // Set instead of m_file for compressed ROMs
+    std::shared_ptr<Common::Compression::SeekableReader> seekable;
+    u64 seekable_pos = 0;
+
     std::string filename;
     std::string openmode;
     u32 flags;
@@ -4,36 +4,50 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
+#include <type_traits>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
+#include "common/assert.h"
 #include "common/common_types.h"
 
 namespace Common {
 
+/**
+ * Links an element into a ThreadQueueList. Queued types embed one of these as a member named
+ * queue_hook, so that queueing and removing never allocates and removal doesn't need a search.
+ */
+template <class T>
+struct ThreadQueueHook {
+    T* prev = nullptr;
+    T* next = nullptr;
+    unsigned int priority = 0;
+    bool queued = false;
+};
+
+/**
+ * Priority ordered FIFO queues of pointers to elements with a ThreadQueueHook. A bitmap of the
+ * non-empty levels makes finding the best ready element a single bit scan.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+    static_assert(std::is_pointer_v<T>, "ThreadQueueList stores pointers to hooked elements");
+    static_assert(N <= 64, "The non-empty level bitmap only has 64 bits");
 
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
-
     // Only for debugging, returns priority level.
     [[nodiscard]] Priority contains(const T& uid) const {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
+            for (T cur = queues[i].head; cur != nullptr; cur = cur->queue_hook.next) {
+                if (cur == uid) {
+                    return i;
+                }
             }
         }
 
@@ -41,167 +55,162 @@ struct ThreadQueueList {
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        if (non_empty == 0) {
+            return T();
         }
-
-        return T();
+        return queues[std::countr_zero(non_empty)].head;
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (non_empty == 0) {
+            return T();
         }
-
-        return T();
+        return pop_front(static_cast<Priority>(std::countr_zero(non_empty)));
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        const u64 better = non_empty & ((u64{1} << priority) - 1);
+        if (better == 0) {
+            return T();
         }
-
-        return T();
+        return pop_front(static_cast<Priority>(std::countr_zero(better)));
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        auto& hook = thread_id->queue_hook;
+        ASSERT_MSG(!hook.queued, "Element is already queued");
+        Queue& cur = queues[priority];
+        hook = {nullptr, cur.head, priority, true};
+        if (cur.head != nullptr) {
+            cur.head->queue_hook.prev = thread_id;
+        } else {
+            cur.tail = thread_id;
+            non_empty |= u64{1} << priority;
+        }
+        cur.head = thread_id;
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        auto& hook = thread_id->queue_hook;
+        ASSERT_MSG(!hook.queued, "Element is already queued");
+        Queue& cur = queues[priority];
+        hook = {cur.tail, nullptr, priority, true};
+        if (cur.tail != nullptr) {
+            cur.tail->queue_hook.next = thread_id;
+        } else {
+            cur.head = thread_id;
+            non_empty |= u64{1} << priority;
+        }
+        cur.tail = thread_id;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+        auto& hook = thread_id->queue_hook;
+        if (!hook.queued || hook.priority != priority) {
+            return;
+        }
+
+        Queue& cur = queues[priority];
+        if (hook.prev != nullptr) {
+            hook.prev->queue_hook.next = hook.next;
+        } else {
+            cur.head = hook.next;
+        }
+        if (hook.next != nullptr) {
+            hook.next->queue_hook.prev = hook.prev;
+        } else {
+            cur.tail = hook.prev;
+        }
+        if (cur.head == nullptr) {
+            non_empty &= ~(u64{1} << priority);
+        }
+        hook = {};
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        const Queue& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.head != cur.tail) {
+            push_back(priority, pop_front(priority));
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Priority i = 0; i < NUM_QUEUES; ++i) {
+            while (queues[i].head != nullptr) {
+                pop_front(i);
+            }
+        }
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return queues[priority].head == nullptr;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T head = nullptr;
+        T tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    T pop_front(Priority priority) {
+        T front = queues[priority].head;
+        remove(priority, front);
+        return front;
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
-    }
-
-    // The first queue that's ever been used.
-    Queue* first;
+    // Bit i is set when the queue of priority level i is not empty.
+    u64 non_empty = 0;
     // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
-        } else {
-            return q - queues.data();
-        }
-    }
-
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
-        }
-    }
+    std::array<Queue, NUM_QUEUES> queues{};
 
+    // Savestates keep the layout of the previous implementation, which chained the levels that had
+    // ever been used (-1 marks an unused level and -2 the end of the chain) and stored a deque per
+    // level. Only the deques matter when loading.
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
-        for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+        const auto next_index = [this](Priority priority) -> s64 {
+            const u64 after = priority + 1 < 64 ? non_empty >> (priority + 1) << (priority + 1) : 0;
+            return after == 0 ? -2 : std::countr_zero(after);
+        };
+
+        const s64 first = non_empty == 0 ? -2 : std::countr_zero(non_empty);
+        ar << first;
+        for (Priority i = 0; i < NUM_QUEUES; i++) {
+            const s64 next = empty(i) ? -1 : next_index(i);
+            ar << next;
+            std::deque<T> data;
+            for (T cur = queues[i].head; cur != nullptr; cur = cur->queue_hook.next) {
+                data.push_back(cur);
+            }
+            const std::deque<T>& const_data = data;
+            ar << const_data;
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
+        // The elements queued before loading belong to the discarded state, so they are forgotten
+        // rather than unlinked.
+        queues.fill(Queue());
+        non_empty = 0;
+
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
-        for (std::size_t i = 0; i < NUM_QUEUES; i++) {
+        for (Priority i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            std::deque<T> data;
+            ar >> data;
+            for (const T& thread_id : data) {
+                thread_id->queue_hook = {};
+                push_back(i, thread_id);
+            }
         }
     }
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <memory>
 #include <zstd.h>
 
 #include "common/assert.h"
@@ -48,4 +49,13 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+std::size_t DecompressDataZSTD(const u8* compressed, std::size_t compressed_size, u8* dest,
+                               std::size_t dest_size) {
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context{ZSTD_createDCtx(),
+                                                                              ZSTD_freeDCtx};
+    const std::size_t result =
+        ZSTD_decompressDCtx(context.get(), dest, dest_size, compressed, compressed_size);
+    return ZSTD_isError(result) ? 0 : result;
+}
+
 } // namespace Common::Compression
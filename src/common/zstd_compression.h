@@ -42,4 +42,18 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a single Zstandard frame into a caller provided buffer. The decompression context
+ * is reused by later calls on the same thread.
+ *
+ * @param compressed the compressed frame.
+ * @param compressed_size the size in bytes of the compressed frame.
+ * @param dest the buffer receiving the uncompressed data.
+ * @param dest_size the size in bytes of the buffer.
+ *
+ * @return the number of decompressed bytes, or 0 if decompression failed.
+ */
+[[nodiscard]] std::size_t DecompressDataZSTD(const u8* compressed, std::size_t compressed_size,
+                                             u8* dest, std::size_t dest_size);
+
 } // namespace Common::Compression
@@ -0,0 +1,369 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "common/thread_worker.h"
+#include "common/zstd_compression.h"
+#include "common/zstd_seekable.h"
+
+namespace Common::Compression {
+
+namespace {
+
+// Seek table layout from the Zstandard seekable format specification
+constexpr u32 SkippableFrameMagic = 0x184D2A5E;
+constexpr u32 SeekableMagic = 0x8F92EAB1;
+constexpr std::size_t SkippableHeaderSize = 8;
+constexpr std::size_t SeekTableFooterSize = 9;
+constexpr u8 ChecksumFlag = 0x80;
+constexpr u8 ReservedDescriptorBits = 0x7C;
+
+/// Decompressed frames kept per reader, in bytes
+constexpr std::size_t CacheBudget = 32 * 1024 * 1024;
+/// Frames decompressed ahead of a sequential read
+constexpr std::size_t PrefetchFrames = 4;
+
+void AppendU32(std::vector<u8>& data, u32 value) {
+    for (u32 shift = 0; shift < 32; shift += 8) {
+        data.push_back(static_cast<u8>(value >> shift));
+    }
+}
+
+u32 ReadU32(const u8* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<u32>(data[3]) << 24);
+}
+
+} // Anonymous namespace
+
+bool CompressFileSeekable(FileUtil::IOFile& source, FileUtil::IOFile& dest, s32 compression_level,
+                          std::size_t frame_size, const std::function<void(u64, u64)>& progress) {
+    if (frame_size == 0 || frame_size > std::numeric_limits<u32>::max()) {
+        LOG_ERROR(Common_Filesystem, "Invalid seekable frame size {}", frame_size);
+        return false;
+    }
+
+    const u64 total = source.GetSize() - source.Tell();
+    const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 1U);
+    Common::ThreadWorker workers(num_workers, "SeekableZstd");
+
+    // Frames are compressed in batches on the workers and written in order
+    std::vector<std::vector<u8>> inputs(num_workers * 2);
+    std::vector<std::vector<u8>> outputs(inputs.size());
+    std::vector<u8> seek_table;
+    u32 num_frames = 0;
+    u64 processed = 0;
+
+    while (processed < total) {
+        std::size_t batch_frames = 0;
+        for (; batch_frames < inputs.size() && processed < total; ++batch_frames) {
+            auto& input = inputs[batch_frames];
+            input.resize(static_cast<std::size_t>(std::min<u64>(frame_size, total - processed)));
+            if (source.ReadBytes(input.data(), input.size()) != input.size()) {
+                LOG_ERROR(Common_Filesystem, "Failed to read {} bytes at offset {}", input.size(),
+                          processed);
+                return false;
+            }
+            processed += input.size();
+        }
+
+        for (std::size_t i = 0; i < batch_frames; ++i) {
+            workers.QueueWork([&inputs, &outputs, compression_level, i] {
+                outputs[i] =
+                    CompressDataZSTD(inputs[i].data(), inputs[i].size(), compression_level);
+            });
+        }
+        workers.WaitForRequests();
+
+        for (std::size_t i = 0; i < batch_frames; ++i) {
+            const auto& output = outputs[i];
+            if (output.empty() || dest.WriteBytes(output.data(), output.size()) != output.size()) {
+                LOG_ERROR(Common_Filesystem, "Failed to compress frame {}", num_frames);
+                return false;
+            }
+            AppendU32(seek_table, static_cast<u32>(output.size()));
+            AppendU32(seek_table, static_cast<u32>(inputs[i].size()));
+            num_frames++;
+        }
+
+        if (progress) {
+            progress(processed, total);
+        }
+    }
+
+    std::vector<u8> table;
+    table.reserve(SkippableHeaderSize + seek_table.size() + SeekTableFooterSize);
+    AppendU32(table, SkippableFrameMagic);
+    AppendU32(table, static_cast<u32>(seek_table.size() + SeekTableFooterSize));
+    table.insert(table.end(), seek_table.begin(), seek_table.end());
+    AppendU32(table, num_frames);
+    table.push_back(0); // Descriptor, no checksums
+    AppendU32(table, SeekableMagic);
+    return dest.WriteBytes(table.data(), table.size()) == table.size();
+}
+
+class SeekableReader::Impl {
+public:
+    explicit Impl(FileUtil::IOFile&& file_)
+        : file(std::move(file_)), workers(std::clamp(std::thread::hardware_concurrency(), 1U, 4U),
+                                          "SeekableZstd") {}
+
+    bool LoadSeekTable() {
+        const u64 file_size = file.GetSize();
+        std::array<u8, SeekTableFooterSize> footer;
+        if (file_size < SkippableHeaderSize + SeekTableFooterSize ||
+            !file.Seek(file_size - SeekTableFooterSize, SEEK_SET) ||
+            file.ReadBytes(footer.data(), footer.size()) != footer.size()) {
+            return false;
+        }
+
+        const u32 num_frames = ReadU32(footer.data());
+        const u8 descriptor = footer[4];
+        if (ReadU32(footer.data() + 5) != SeekableMagic ||
+            (descriptor & ReservedDescriptorBits) != 0) {
+            return false;
+        }
+
+        const std::size_t entry_size = (descriptor & ChecksumFlag) ? 12 : 8;
+        const u64 table_size =
+            SkippableHeaderSize + u64{num_frames} * entry_size + SeekTableFooterSize;
+        if (table_size > file_size) {
+            return false;
+        }
+
+        std::vector<u8> table(static_cast<std::size_t>(table_size - SeekTableFooterSize));
+        if (!file.Seek(file_size - table_size, SEEK_SET) ||
+            file.ReadBytes(table.data(), table.size()) != table.size() ||
+            ReadU32(table.data()) != SkippableFrameMagic ||
+            ReadU32(table.data() + 4) != table_size - SkippableHeaderSize) {
+            return false;
+        }
+
+        frames.reserve(num_frames);
+        u64 compressed_offset = 0;
+        u64 uncompressed_offset = 0;
+        for (u32 i = 0; i < num_frames; ++i) {
+            const u8* entry = table.data() + SkippableHeaderSize + i * entry_size;
+            const Frame frame{compressed_offset, uncompressed_offset, ReadU32(entry),
+                              ReadU32(entry + 4)};
+            compressed_offset += frame.compressed_size;
+            uncompressed_offset += frame.uncompressed_size;
+            frames.push_back(frame);
+        }
+        if (compressed_offset > file_size - table_size) {
+            return false;
+        }
+
+        size = uncompressed_offset;
+        max_frame_size = 1;
+        for (const Frame& frame : frames) {
+            max_frame_size = std::max<std::size_t>(max_frame_size, frame.uncompressed_size);
+        }
+        return true;
+    }
+
+    std::size_t Read(u64 offset, void* buffer, std::size_t length) {
+        if (offset >= size || length == 0) {
+            return 0;
+        }
+        length = static_cast<std::size_t>(std::min<u64>(length, size - offset));
+
+        std::size_t index = FindFrame(offset);
+        Prefetch(index, FindFrame(offset + length - 1));
+
+        u8* out = static_cast<u8*>(buffer);
+        std::size_t read = 0;
+        for (; read < length; ++index) {
+            const Frame& frame = frames[index];
+            const FrameData frame_data = GetFrame(index);
+            const std::vector<u8>& data = frame_data.get();
+            if (data.size() != frame.uncompressed_size) {
+                break;
+            }
+
+            const u64 frame_offset = offset + read - frame.uncompressed_offset;
+            const std::size_t copy_size = static_cast<std::size_t>(
+                std::min<u64>(length - read, frame.uncompressed_size - frame_offset));
+            std::memcpy(out + read, data.data() + frame_offset, copy_size);
+            read += copy_size;
+        }
+        return read;
+    }
+
+    u64 size = 0;
+
+private:
+    struct Frame {
+        u64 compressed_offset;
+        u64 uncompressed_offset;
+        u32 compressed_size;
+        u32 uncompressed_size;
+    };
+
+    using FrameData = std::shared_future<std::vector<u8>>;
+
+    using FramePromise = std::promise<std::vector<u8>>;
+
+    struct CacheEntry {
+        FrameData data;
+        std::list<std::size_t>::iterator lru_it;
+        const FramePromise* promise; ///< Identifies the decompression filling data
+    };
+
+    std::size_t FindFrame(u64 offset) const {
+        const auto it = std::upper_bound(
+            frames.begin(), frames.end(), offset,
+            [](u64 value, const Frame& frame) { return value < frame.uncompressed_offset; });
+        return static_cast<std::size_t>(std::distance(frames.begin(), it)) - 1;
+    }
+
+    /// Queues the frames after a read that continues the previous one
+    void Prefetch(std::size_t first, std::size_t last) {
+        bool sequential;
+        {
+            std::scoped_lock lock{cache_mutex};
+            sequential = first == last_read || first == last_read + 1;
+            last_read = last;
+        }
+        if (!sequential) {
+            return;
+        }
+        const std::size_t end = std::min(last + 1 + PrefetchFrames, frames.size());
+        for (std::size_t index = last + 1; index < end; ++index) {
+            GetFrame(index, true);
+        }
+    }
+
+    FrameData GetFrame(std::size_t index, bool prefetch = false) {
+        auto promise = std::make_shared<FramePromise>();
+        FrameData data;
+        {
+            std::scoped_lock lock{cache_mutex};
+            if (const auto it = cache.find(index); it != cache.end()) {
+                lru.splice(lru.begin(), lru, it->second.lru_it);
+                return it->second.data;
+            }
+
+            data = promise->get_future().share();
+            lru.push_front(index);
+            cache.emplace(index, CacheEntry{data, lru.begin(), promise.get()});
+            if (cache.size() > std::max<std::size_t>(CacheBudget / max_frame_size, 16)) {
+                cache.erase(lru.back());
+                lru.pop_back();
+            }
+        }
+
+        if (prefetch) {
+            workers.QueueWork([this, index, promise] { Fill(index, *promise); });
+        } else {
+            Fill(index, *promise);
+        }
+        return data;
+    }
+
+    /// Decompresses a frame for its cache entry. A failed frame is dropped from the cache before
+    /// its readers are woken, so that the next read of it tries again.
+    void Fill(std::size_t index, FramePromise& promise) {
+        std::vector<u8> data = Decompress(index);
+        if (data.size() != frames[index].uncompressed_size) {
+            std::scoped_lock lock{cache_mutex};
+            const auto it = cache.find(index);
+            if (it != cache.end() && it->second.promise == &promise) {
+                lru.erase(it->second.lru_it);
+                cache.erase(it);
+            }
+        }
+        promise.set_value(std::move(data));
+    }
+
+    std::vector<u8> Decompress(std::size_t index) {
+        const Frame& frame = frames[index];
+        std::vector<u8> compressed(frame.compressed_size);
+        {
+            std::scoped_lock lock{file_mutex};
+            file.Seek(static_cast<s64>(frame.compressed_offset), SEEK_SET);
+            if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+                LOG_ERROR(Common_Filesystem, "Failed to read compressed frame {}", index);
+                file.Clear();
+                return {};
+            }
+        }
+
+        std::vector<u8> data(frame.uncompressed_size);
+        if (DecompressDataZSTD(compressed.data(), compressed.size(), data.data(), data.size()) !=
+            data.size()) {
+            LOG_ERROR(Common_Filesystem, "Failed to decompress frame {}", index);
+            return {};
+        }
+        return data;
+    }
+
+    FileUtil::IOFile file;
+    std::mutex file_mutex;
+    std::vector<Frame> frames;
+    std::size_t max_frame_size = 1;
+
+    std::mutex cache_mutex;
+    std::unordered_map<std::size_t, CacheEntry> cache;
+    std::list<std::size_t> lru; ///< Most recently used frames first
+    std::size_t last_read = std::numeric_limits<std::size_t>::max() - 1;
+
+    // Declared last so pending prefetches finish before the state they use is destroyed
+    Common::ThreadWorker workers;
+};
+
+SeekableReader::SeekableReader(std::unique_ptr<Impl> impl_) : impl(std::move(impl_)) {}
+
+SeekableReader::~SeekableReader() = default;
+
+std::shared_ptr<SeekableReader> SeekableReader::Open(const std::string& path,
+                                                     FileUtil::IOFile&& file) {
+    static std::mutex readers_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<SeekableReader>> readers;
+
+    std::scoped_lock lock{readers_mutex};
+    if (auto reader = readers[path].lock()) {
+        return reader;
+    }
+
+    auto impl = std::make_unique<Impl>(std::move(file));
+    if (!impl->LoadSeekTable()) {
+        LOG_ERROR(Common_Filesystem, "{} is not a seekable Zstandard file", path);
+        readers.erase(path);
+        return nullptr;
+    }
+
+    std::shared_ptr<SeekableReader> reader{new SeekableReader(std::move(impl))};
+    readers[path] = reader;
+    return reader;
+}
+
+u64 SeekableReader::GetSize() const {
+    return impl->size;
+}
+
+std::size_t SeekableReader::Read(u64 offset, void* buffer, std::size_t length) {
+    return impl->Read(offset, buffer, length);
+}
+
+bool IsCompressedRomPath(std::string_view path) {
+    std::string extension;
+    Common::SplitPath(std::string(path), nullptr, nullptr, &extension);
+    extension = Common::ToLower(std::move(extension));
+    return extension == ".zcci" || extension == ".z3ds" || extension == ".zcxi" ||
+           extension == ".zcia";
+}
+
+} // namespace Common::Compression
@@ -0,0 +1,88 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "common/common_types.h"
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace Common::Compression {
+
+/// Uncompressed size of the frames written by CompressFileSeekable by default
+constexpr std::size_t DefaultSeekableFrameSize = 256 * 1024;
+
+/**
+ * Compresses a file into the Zstandard seekable format: the data is split into independently
+ * compressed frames followed by a skippable frame holding a seek table. Any Zstandard decoder can
+ * still decompress the whole file, while SeekableReader only decompresses the frames it needs.
+ *
+ * @param source the file to compress, read from its current position to the end.
+ * @param dest the file receiving the compressed data.
+ * @param compression_level the used compression level. Should be between 1 and 22.
+ * @param frame_size the uncompressed size of each frame.
+ * @param progress called with the number of bytes compressed so far and the total.
+ *
+ * @return true on success.
+ */
+bool CompressFileSeekable(FileUtil::IOFile& source, FileUtil::IOFile& dest, s32 compression_level,
+                          std::size_t frame_size = DefaultSeekableFrameSize,
+                          const std::function<void(u64, u64)>& progress = {});
+
+/**
+ * Random access reader for files in the Zstandard seekable format. Decompressed frames are kept in
+ * an LRU cache, and the frames following a sequential read are decompressed ahead of time on
+ * worker threads. All files opened on the same path share one reader, which may be used from any
+ * thread.
+ */
+class SeekableReader {
+public:
+    ~SeekableReader();
+
+    /**
+     * Gets the reader for a seekable file.
+     *
+     * @param path the path of the file, used to share readers.
+     * @param file the opened compressed file. Only used if no reader for the path is alive.
+     *
+     * @return the reader, or nullptr if the file does not end with a valid seek table.
+     */
+    static std::shared_ptr<SeekableReader> Open(const std::string& path, FileUtil::IOFile&& file);
+
+    /// Gets the uncompressed size of the file
+    u64 GetSize() const;
+
+    /**
+     * Reads uncompressed data.
+     *
+     * @param offset the offset in the uncompressed data to start reading at.
+     * @param buffer the buffer receiving the data.
+     * @param length the number of bytes to read.
+     *
+     * @return the number of bytes read, which is less than length at the end of the file or if a
+     *         frame failed to decompress.
+     */
+    std::size_t Read(u64 offset, void* buffer, std::size_t length);
+
+private:
+    class Impl;
+
+    explicit SeekableReader(std::unique_ptr<Impl> impl);
+
+    std::unique_ptr<Impl> impl;
+};
+
+/**
+ * Checks whether a path names a compressed ROM (.zcci, .z3ds, .zcxi or .zcia). FileUtil::IOFile
+ * reads these through SeekableReader when they are opened read-only.
+ */
+bool IsCompressedRomPath(std::string_view path);
+
+} // namespace Common::Compression
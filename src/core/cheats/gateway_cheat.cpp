@@ -3,7 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <string>
@@ -30,23 +30,69 @@ struct State {
     bool loop_flag = false;
 };
 
+using Instruction = GatewayCheat::Instruction;
+using HostPointer = GatewayCheat::HostPointer;
+
+/// Returns the host pointer backing vaddr if it is plain memory, reusing the pointer resolved by
+/// the previous access of the instruction when the address did not change.
+static inline u8* GetHostPointer(Memory::PageTable& page_table, HostPointer& cached, VAddr vaddr) {
+    if (!cached.valid || cached.vaddr != vaddr) {
+        u8* page_pointer = page_table.pointers[vaddr >> Memory::CITRA_PAGE_BITS];
+        cached.vaddr = vaddr;
+        cached.pointer = page_pointer ? page_pointer + (vaddr & Memory::CITRA_PAGE_MASK) : nullptr;
+        cached.valid = true;
+    }
+    return cached.pointer;
+}
+
+template <typename T>
+static inline T ReadMemory(Memory::MemorySystem& memory, Memory::PageTable& page_table,
+                           HostPointer& cached, VAddr vaddr) {
+    if (const u8* pointer = GetHostPointer(page_table, cached, vaddr)) {
+        T value;
+        std::memcpy(&value, pointer, sizeof(T));
+        return value;
+    }
+    if constexpr (sizeof(T) == sizeof(u8)) {
+        return memory.Read8(vaddr);
+    } else if constexpr (sizeof(T) == sizeof(u16)) {
+        return memory.Read16(vaddr);
+    } else {
+        return memory.Read32(vaddr);
+    }
+}
+
+template <typename T>
+static inline void WriteMemory(Memory::MemorySystem& memory, Memory::PageTable& page_table,
+                               HostPointer& cached, VAddr vaddr, T value) {
+    if (u8* pointer = GetHostPointer(page_table, cached, vaddr)) {
+        std::memcpy(pointer, &value, sizeof(T));
+        return;
+    }
+    if constexpr (sizeof(T) == sizeof(u8)) {
+        memory.Write8(vaddr, value);
+    } else if constexpr (sizeof(T) == sizeof(u16)) {
+        memory.Write16(vaddr, value);
+    } else {
+        memory.Write32(vaddr, value);
+    }
+}
+
 template <typename T, typename ReadFunction, typename WriteFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::CheatLine& line,
-                                                              const State& state,
-                                                              ReadFunction read_func,
-                                                              WriteFunction write_func,
-                                                              Core::System& system) {
+static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(
+    const Instruction& line, const State& state, ReadFunction read_func, WriteFunction write_func,
+    const GatewayCheat::Environment& env) {
     u32 addr = line.address + state.offset;
     T val = read_func(addr);
     if (val != static_cast<T>(line.value)) {
         write_func(addr, static_cast<T>(line.value));
-        system.InvalidateCacheRange(addr, sizeof(T));
+        env.invalidate_cache_range(addr, sizeof(T));
     }
 }
 
 template <typename T, typename ReadFunction, typename CompareFunc>
-static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::CheatLine& line,
-                                                             State& state, ReadFunction read_func,
+static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const Instruction& line, State& state,
+                                                             ReadFunction read_func,
                                                              CompareFunc comp) {
     u32 addr = line.address + state.offset;
     T val = read_func(addr);
@@ -55,13 +101,13 @@ static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat:
     }
 }
 
-static inline void LoadOffsetOp(Memory::MemorySystem& memory, const GatewayCheat::CheatLine& line,
-                                State& state) {
+template <typename ReadFunction>
+static inline void LoadOffsetOp(const Instruction& line, State& state, ReadFunction read_func) {
     u32 addr = line.address + state.offset;
-    state.offset = memory.Read32(addr);
+    state.offset = read_func(addr);
 }
 
-static inline void LoopOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void LoopOp(const Instruction& line, State& state) {
     state.loop_flag = state.loop_count < line.value;
     state.loop_count++;
     state.loop_back_line = state.current_line_nr;
@@ -93,90 +139,75 @@ static inline void FullTerminateOp(State& state) {
     }
 }
 
-static inline void SetOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetOffsetOp(const Instruction& line, State& state) {
     state.offset = line.value;
 }
 
-static inline void AddValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddValueOp(const Instruction& line, State& state) {
     state.reg += line.value;
 }
 
-static inline void SetValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetValueOp(const Instruction& line, State& state) {
     state.reg = line.value;
 }
 
 template <typename T, typename ReadFunction, typename WriteFunction>
 static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
-    const GatewayCheat::CheatLine& line, State& state, ReadFunction read_func,
-    WriteFunction write_func, Core::System& system) {
+    const Instruction& line, State& state, ReadFunction read_func, WriteFunction write_func,
+    const GatewayCheat::Environment& env) {
     u32 addr = line.value + state.offset;
     T val = read_func(addr);
     if (val != static_cast<T>(state.reg)) {
         write_func(addr, static_cast<T>(state.reg));
-        system.InvalidateCacheRange(addr, sizeof(T));
+        env.invalidate_cache_range(addr, sizeof(T));
     }
     state.offset += sizeof(T);
 }
 
 template <typename T, typename ReadFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const Instruction& line,
                                                              State& state, ReadFunction read_func) {
 
     u32 addr = line.value + state.offset;
     state.reg = read_func(addr);
 }
 
-static inline void AddOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddOffsetOp(const Instruction& line, State& state) {
     state.offset += line.value;
 }
 
-static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
-                           const Core::System& system) {
-    u32 pad_state = system.ServiceManager()
-                        .GetService<Service::HID::Module::Interface>("hid:USER")
-                        ->GetModule()
-                        ->GetState()
-                        .hex;
+static inline void JokerOp(const Instruction& line, State& state,
+                           const GatewayCheat::Environment& env) {
+    u32 pad_state = env.get_pad_state();
     bool pressed = (pad_state & line.value) == line.value;
     if (!pressed) {
         state.if_flag++;
     }
 }
 
-static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Core::System& system,
-                           const std::vector<GatewayCheat::CheatLine>& cheat_lines) {
-    if (state.if_flag > 0) {
-        // Skip over the additional patch lines
-        state.current_line_nr += static_cast<int>(std::ceil(line.value / 8.0));
+static inline void PatchOp(const Instruction& line, const State& state,
+                           const GatewayCheat::Environment& env, Memory::PageTable& page_table,
+                           HostPointer& cached, const std::vector<u8>& patch_data) {
+    const u32 num_bytes = line.value;
+    const u32 addr = line.address + state.offset;
+    const u8* data = patch_data.data() + line.patch_offset;
+    env.invalidate_cache_range(addr, num_bytes);
+
+    // Copy the whole payload at once when it stays within a page of plain memory
+    u8* pointer = GetHostPointer(page_table, cached, addr);
+    if (pointer && (addr & Memory::CITRA_PAGE_MASK) + num_bytes <= Memory::CITRA_PAGE_SIZE) {
+        std::memcpy(pointer, data, num_bytes);
         return;
     }
-    u32 num_bytes = line.value;
-    u32 addr = line.address + state.offset;
-    system.InvalidateCacheRange(addr, num_bytes);
-
-    bool first = true;
-    u32 bit_offset = 0;
-    if (num_bytes > 0)
-        state.current_line_nr++; // skip over the current code
-    while (num_bytes >= 4) {
-        u32 tmp = first ? cheat_lines[state.current_line_nr].first
-                        : cheat_lines[state.current_line_nr].value;
-        if (!first && num_bytes > 4) {
-            state.current_line_nr++;
-        }
-        first = !first;
-        system.Memory().Write32(addr, tmp);
-        addr += 4;
-        num_bytes -= 4;
+
+    u32 offset = 0;
+    for (; num_bytes - offset >= 4; offset += 4) {
+        u32 word;
+        std::memcpy(&word, data + offset, sizeof(u32));
+        env.memory.Write32(addr + offset, word);
     }
-    while (num_bytes > 0) {
-        u32 tmp = (first ? cheat_lines[state.current_line_nr].first
-                         : cheat_lines[state.current_line_nr].value) >>
-                  bit_offset;
-        system.Memory().Write8(addr, tmp);
-        addr += 1;
-        num_bytes -= 1;
-        bit_offset += 8;
+    for (; offset < num_bytes; offset++) {
+        env.memory.Write8(addr + offset, data[offset]);
     }
 }
 
@@ -211,6 +242,7 @@ GatewayCheat::CheatLine::CheatLine(const std::string& line) {
 GatewayCheat::GatewayCheat(std::string name_, std::vector<CheatLine> cheat_lines_,
                            std::string comments_)
     : name(std::move(name_)), cheat_lines(std::move(cheat_lines_)), comments(std::move(comments_)) {
+    Compile();
 }
 
 GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comments_)
@@ -225,24 +257,92 @@ GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comm
             temp_cheat_lines.emplace_back(code_lines[i]);
     }
     cheat_lines = std::move(temp_cheat_lines);
+    Compile();
 }
 
 GatewayCheat::~GatewayCheat() = default;
 
+void GatewayCheat::Compile() {
+    program.clear();
+    patch_data.clear();
+    program.reserve(cheat_lines.size());
+
+    for (std::size_t i = 0; i < cheat_lines.size(); ++i) {
+        const CheatLine& line = cheat_lines[i];
+        if (line.type == CheatType::Null) {
+            continue;
+        }
+        Instruction instruction{line.type, line.address, line.value, 0};
+        if (line.type == CheatType::Patch) {
+            // The payload is stored in the (first, value) words of the following lines
+            const std::size_t num_lines = line.value / 8 + (line.value % 8 != 0 ? 1 : 0);
+            const std::size_t end = std::min(i + 1 + num_lines, cheat_lines.size());
+            instruction.patch_offset = static_cast<u32>(patch_data.size());
+            for (std::size_t j = i + 1; j < end; ++j) {
+                for (const u32 word : {cheat_lines[j].first, cheat_lines[j].value}) {
+                    for (u32 shift = 0; shift < 32; shift += 8) {
+                        patch_data.push_back(static_cast<u8>(word >> shift));
+                    }
+                }
+            }
+            // Codes cut short by the end of the cheat only patch the bytes they carry
+            const std::size_t payload_size = patch_data.size() - instruction.patch_offset;
+            instruction.value = static_cast<u32>(std::min<std::size_t>(line.value, payload_size));
+            patch_data.resize(instruction.patch_offset + instruction.value);
+            i = end - 1;
+        }
+        program.push_back(instruction);
+    }
+
+    host_pointers.assign(program.size(), HostPointer{});
+}
+
 void GatewayCheat::Execute(Core::System& system) const {
+    const Environment env{
+        system.Memory(),
+        [&system](VAddr addr, u32 size) { system.InvalidateCacheRange(addr, size); },
+        [&system] {
+            return system.ServiceManager()
+                .GetService<Service::HID::Module::Interface>("hid:USER")
+                ->GetModule()
+                ->GetState()
+                .hex;
+        },
+    };
+    Execute(env);
+}
+
+void GatewayCheat::Execute(const Environment& env) const {
     State state;
 
-    Memory::MemorySystem& memory = system.Memory();
-    auto Read8 = [&memory](VAddr addr) { return memory.Read8(addr); };
-    auto Read16 = [&memory](VAddr addr) { return memory.Read16(addr); };
-    auto Read32 = [&memory](VAddr addr) { return memory.Read32(addr); };
-    auto Write8 = [&memory](VAddr addr, u8 value) { memory.Write8(addr, value); };
-    auto Write16 = [&memory](VAddr addr, u16 value) { memory.Write16(addr, value); };
-    auto Write32 = [&memory](VAddr addr, u32 value) { memory.Write32(addr, value); };
+    Memory::MemorySystem& memory = env.memory;
+    Memory::PageTable& page_table = *memory.GetCurrentPageTable();
+    const u64 generation = memory.GetPageTableGeneration();
+    if (generation != page_table_generation) {
+        std::fill(host_pointers.begin(), host_pointers.end(), HostPointer{});
+        page_table_generation = generation;
+    }
 
-    for (state.current_line_nr = 0; state.current_line_nr < cheat_lines.size();
+    // Accesses go through the host pointer cached for the instruction being executed
+    auto cached = [this, &state]() -> HostPointer& {
+        return host_pointers[state.current_line_nr];
+    };
+    auto Read8 = [&](VAddr addr) { return ReadMemory<u8>(memory, page_table, cached(), addr); };
+    auto Read16 = [&](VAddr addr) { return ReadMemory<u16>(memory, page_table, cached(), addr); };
+    auto Read32 = [&](VAddr addr) { return ReadMemory<u32>(memory, page_table, cached(), addr); };
+    auto Write8 = [&](VAddr addr, u8 value) {
+        WriteMemory<u8>(memory, page_table, cached(), addr, value);
+    };
+    auto Write16 = [&](VAddr addr, u16 value) {
+        WriteMemory<u16>(memory, page_table, cached(), addr, value);
+    };
+    auto Write32 = [&](VAddr addr, u32 value) {
+        WriteMemory<u32>(memory, page_table, cached(), addr, value);
+    };
+
+    for (state.current_line_nr = 0; state.current_line_nr < program.size();
          state.current_line_nr++) {
-        auto line = cheat_lines[state.current_line_nr];
+        const Instruction& line = program[state.current_line_nr];
         if (state.if_flag > 0) {
             switch (line.type) {
             case CheatType::GreaterThan32:
@@ -257,12 +357,6 @@ void GatewayCheat::Execute(Core::System& system) const {
                 // Increment the if_flag to handle the end if correctly
                 state.if_flag++;
                 break;
-            case CheatType::Patch:
-                // EXXXXXXX YYYYYYYY
-                // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-                // We need to call this here to skip the additional patch lines
-                PatchOp(line, state, system, cheat_lines);
-                break;
             case CheatType::Terminator:
                 // D0000000 00000000 - ENDIF
                 TerminateOp(state);
@@ -272,6 +366,7 @@ void GatewayCheat::Execute(Core::System& system) const {
                 FullTerminateOp(state);
                 break;
             default:
+                // Patch payloads were folded into their instruction, so there is nothing to skip
                 break;
             }
             // Do not execute any other op code
@@ -282,15 +377,15 @@ void GatewayCheat::Execute(Core::System& system) const {
             break;
         case CheatType::Write32:
             // 0XXXXXXX YYYYYYYY - word[XXXXXXX+offset] = YYYYYYYY
-            WriteOp<u32>(line, state, Read32, Write32, system);
+            WriteOp<u32>(line, state, Read32, Write32, env);
             break;
         case CheatType::Write16:
             // 1XXXXXXX 0000YYYY - half[XXXXXXX+offset] = YYYY
-            WriteOp<u16>(line, state, Read16, Write16, system);
+            WriteOp<u16>(line, state, Read16, Write16, env);
             break;
         case CheatType::Write8:
             // 2XXXXXXX 000000YY - byte[XXXXXXX+offset] = YY
-            WriteOp<u8>(line, state, Read8, Write8, system);
+            WriteOp<u8>(line, state, Read8, Write8, env);
             break;
         case CheatType::GreaterThan32:
             // 3XXXXXXX YYYYYYYY - Execute next block IF YYYYYYYY > word[XXXXXXX]   ;unsigned
@@ -336,7 +431,7 @@ void GatewayCheat::Execute(Core::System& system) const {
             break;
         case CheatType::LoadOffset:
             // BXXXXXXX 00000000 - offset = word[XXXXXXX+offset]
-            LoadOffsetOp(system.Memory(), line, state);
+            LoadOffsetOp(line, state, Read32);
             break;
         case CheatType::Loop: {
             // C0000000 YYYYYYYY - LOOP next block YYYYYYYY times
@@ -376,17 +471,17 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::IncrementiveWrite32: {
             // D6000000 XXXXXXXX – (32bit) [XXXXXXXX+offset] = reg ; offset += 4
-            IncrementiveWriteOp<u32>(line, state, Read32, Write32, system);
+            IncrementiveWriteOp<u32>(line, state, Read32, Write32, env);
             break;
         }
         case CheatType::IncrementiveWrite16: {
             // D7000000 XXXXXXXX – (16bit) [XXXXXXXX+offset] = reg & 0xffff ; offset += 2
-            IncrementiveWriteOp<u16>(line, state, Read16, Write16, system);
+            IncrementiveWriteOp<u16>(line, state, Read16, Write16, env);
             break;
         }
         case CheatType::IncrementiveWrite8: {
             // D8000000 XXXXXXXX – (16bit) [XXXXXXXX+offset] = reg & 0xff ; offset++
-            IncrementiveWriteOp<u8>(line, state, Read8, Write8, system);
+            IncrementiveWriteOp<u8>(line, state, Read8, Write8, env);
             break;
         }
         case CheatType::Load32: {
@@ -411,13 +506,13 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::Joker: {
             // DD000000 XXXXXXXX – if KEYPAD has value XXXXXXXX execute next block
-            JokerOp(line, state, system);
+            JokerOp(line, state, env);
             break;
         }
         case CheatType::Patch: {
             // EXXXXXXX YYYYYYYY
             // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-            PatchOp(line, state, system, cheat_lines);
+            PatchOp(line, state, env, page_table, cached(), patch_data);
             break;
         }
         }
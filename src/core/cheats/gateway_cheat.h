@@ -5,11 +5,16 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 #include "common/common_types.h"
 #include "core/cheats/cheat_base.h"
 
+namespace Memory {
+class MemorySystem;
+}
+
 namespace Cheats {
 class GatewayCheat final : public CheatBase {
 public:
@@ -48,18 +53,42 @@ public:
     struct CheatLine {
         explicit CheatLine(const std::string& line);
         CheatType type;
-        u32 address;
-        u32 value;
-        u32 first;
+        u32 address = 0;
+        u32 value = 0;
+        u32 first = 0;
         std::string cheat_line;
         bool valid = true;
     };
 
+    /// A cheat line decoded for execution. The payload lines following a patch code are folded
+    /// into the patch data, so instruction indices do not match line numbers.
+    struct Instruction {
+        CheatType type;
+        u32 address;
+        u32 value;
+        u32 patch_offset; ///< Offset of the payload in the patch data for Patch codes
+    };
+
+    /// Host pointer an instruction resolved for the last address it accessed
+    struct HostPointer {
+        VAddr vaddr = 0;
+        u8* pointer = nullptr;
+        bool valid = false;
+    };
+
+    /// What a cheat needs from the emulated system besides memory
+    struct Environment {
+        Memory::MemorySystem& memory;
+        std::function<void(VAddr, u32)> invalidate_cache_range;
+        std::function<u32()> get_pad_state;
+    };
+
     GatewayCheat(std::string name, std::vector<CheatLine> cheat_lines, std::string comments);
     GatewayCheat(std::string name, std::string code, std::string comments);
     ~GatewayCheat();
 
     void Execute(Core::System& system) const override;
+    void Execute(const Environment& env) const;
 
     bool IsEnabled() const override;
     void SetEnabled(bool enabled) override;
@@ -80,9 +109,20 @@ public:
     static std::vector<std::unique_ptr<CheatBase>> LoadFile(const std::string& filepath);
 
 private:
+    /// Decodes cheat_lines into the program run by Execute
+    void Compile();
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
     const std::string comments;
+
+    std::vector<Instruction> program;
+    std::vector<u8> patch_data;
+
+    // Cheats are only executed on the emulation thread, which owns these caches. Host pointers
+    // are resolved again once the page table generation changes.
+    mutable std::vector<HostPointer> host_pointers;
+    mutable u64 page_table_generation = 0;
 };
 } // namespace Cheats
@@ -0,0 +1,233 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+#include "core/hle/call_profiler.h"
+
+namespace HLE::CallProfiler {
+
+namespace Detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+struct ServiceKey {
+    const void* service;
+    u32 header;
+
+    bool operator==(const ServiceKey&) const = default;
+};
+
+struct ServiceKeyHash {
+    std::size_t operator()(const ServiceKey& key) const noexcept {
+        return std::hash<const void*>{}(key.service) ^ (key.header * 0x9E3779B97F4A7C15ULL);
+    }
+};
+
+struct ServiceEntry {
+    std::string service_name;
+    const char* function_name{};
+    Histogram histogram;
+};
+
+/// Statistics recorded by a single host thread. The owning thread updates the histograms without
+/// locking; the mutex only guards insertions of new service commands against a concurrent export.
+struct ThreadStorage {
+    std::array<Histogram, NumSVCs> svcs;
+    std::array<std::atomic<const char*>, NumSVCs> svc_names{};
+
+    std::mutex service_mutex;
+    std::unordered_map<ServiceKey, ServiceEntry, ServiceKeyHash> services;
+};
+
+/// Storage of every thread that has recorded a call. Entries outlive their threads so that the
+/// statistics of finished threads are still exported.
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadStorage>> registry;
+
+ThreadStorage& GetThreadStorage() {
+    thread_local std::shared_ptr<ThreadStorage> storage = [] {
+        auto new_storage = std::make_shared<ThreadStorage>();
+        std::scoped_lock lock{registry_mutex};
+        registry.push_back(new_storage);
+        return new_storage;
+    }();
+    return *storage;
+}
+
+/// Plain sums of one or more histograms, used while merging threads for export.
+struct Totals {
+    u64 count{};
+    u64 total_ns{};
+    u64 max_ns{};
+    std::array<u64, NumBuckets> buckets{};
+
+    void Add(const Histogram& histogram) {
+        count += histogram.count.load(std::memory_order_relaxed);
+        total_ns += histogram.total_ns.load(std::memory_order_relaxed);
+        max_ns = std::max(max_ns, histogram.max_ns.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < NumBuckets; ++i) {
+            buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+std::string EscapeJson(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+void AppendTotals(std::string& out, const Totals& totals) {
+    out += fmt::format("\"count\":{},\"total_ns\":{},\"max_ns\":{},\"histogram\":[{}]",
+                       totals.count, totals.total_ns, totals.max_ns,
+                       fmt::join(totals.buckets, ","));
+}
+
+} // Anonymous namespace
+
+std::size_t BucketIndex(u64 ns) {
+    return std::min<std::size_t>(std::bit_width(ns), NumBuckets - 1);
+}
+
+void Histogram::Record(u64 ns) {
+    const auto bump = [](std::atomic<u64>& value, u64 amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    };
+    bump(count, 1);
+    bump(total_ns, ns);
+    bump(buckets[BucketIndex(ns)], 1);
+    if (ns > max_ns.load(std::memory_order_relaxed)) {
+        max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::Reset() {
+    count.store(0, std::memory_order_relaxed);
+    total_ns.store(0, std::memory_order_relaxed);
+    max_ns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SetEnabled(bool enabled) {
+    Detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Reset() {
+    std::scoped_lock lock{registry_mutex};
+    for (const auto& storage : registry) {
+        for (auto& histogram : storage->svcs) {
+            histogram.Reset();
+        }
+        std::scoped_lock service_lock{storage->service_mutex};
+        for (auto& [key, entry] : storage->services) {
+            entry.histogram.Reset();
+        }
+    }
+}
+
+void RecordSVC(u32 immediate, const char* name, u64 ns) {
+    if (immediate >= NumSVCs) {
+        return;
+    }
+    ThreadStorage& storage = GetThreadStorage();
+    storage.svc_names[immediate].store(name, std::memory_order_relaxed);
+    storage.svcs[immediate].Record(ns);
+}
+
+void RecordServiceCommand(const void* service, u32 header, const std::string& service_name,
+                          const char* function_name, u64 ns) {
+    ThreadStorage& storage = GetThreadStorage();
+    const ServiceKey key{service, header};
+
+    // Only this thread inserts into its map, so looking up without the lock is safe.
+    auto it = storage.services.find(key);
+    if (it == storage.services.end()) {
+        std::scoped_lock lock{storage.service_mutex};
+        it = storage.services.try_emplace(key).first;
+        it->second.service_name = service_name;
+        it->second.function_name = function_name;
+    }
+    it->second.histogram.Record(ns);
+}
+
+std::string ExportJson() {
+    std::array<Totals, NumSVCs> svcs{};
+    std::array<const char*, NumSVCs> svc_names{};
+    // Ordered so the output is stable between exports.
+    std::map<std::tuple<std::string, u32>, std::pair<const char*, Totals>> services;
+
+    {
+        std::scoped_lock lock{registry_mutex};
+        for (const auto& storage : registry) {
+            for (std::size_t i = 0; i < NumSVCs; ++i) {
+                if (const char* name = storage->svc_names[i].load(std::memory_order_relaxed)) {
+                    svc_names[i] = name;
+                }
+                svcs[i].Add(storage->svcs[i]);
+            }
+            std::scoped_lock service_lock{storage->service_mutex};
+            for (const auto& [key, entry] : storage->services) {
+                auto& [function_name, totals] = services[{entry.service_name, key.header}];
+                function_name = entry.function_name;
+                totals.Add(entry.histogram);
+            }
+        }
+    }
+
+    std::string out = "{\"svc\":[";
+    bool first = true;
+    for (std::size_t i = 0; i < NumSVCs; ++i) {
+        if (svcs[i].count == 0) {
+            continue;
+        }
+        out += first ? "{" : ",{";
+        first = false;
+        out += fmt::format("\"id\":{},\"name\":\"{}\",", i,
+                           EscapeJson(svc_names[i] ? svc_names[i] : ""));
+        AppendTotals(out, svcs[i]);
+        out += "}";
+    }
+    out += "],\"service\":[";
+    first = true;
+    for (const auto& [key, value] : services) {
+        const auto& [service_name, header] = key;
+        const auto& [function_name, totals] = value;
+        if (totals.count == 0) {
+            continue;
+        }
+        out += first ? "{" : ",{";
+        first = false;
+        out += fmt::format("\"service\":\"{}\",\"header\":\"{:#010x}\",\"name\":\"{}\",",
+                           EscapeJson(service_name), header,
+                           EscapeJson(function_name ? function_name : ""));
+        AppendTotals(out, totals);
+        out += "}";
+    }
+    out += "]}";
+    return out;
+}
+
+} // namespace HLE::CallProfiler
@@ -0,0 +1,92 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "common/common_types.h"
+
+namespace HLE::CallProfiler {
+
+/// Number of log2 buckets in a latency histogram. Bucket i counts calls that took
+/// [2^(i-1), 2^i) nanoseconds of host time, the last bucket also takes everything slower.
+constexpr std::size_t NumBuckets = 32;
+
+/// Highest SVC number that is tracked individually.
+constexpr std::size_t NumSVCs = 0x80;
+
+/// Latency statistics of a single SVC or service command. Written only by the thread that owns
+/// it, so updates are plain relaxed loads and stores.
+struct Histogram {
+    std::atomic<u64> count{};
+    std::atomic<u64> total_ns{};
+    std::atomic<u64> max_ns{};
+    std::array<std::atomic<u64>, NumBuckets> buckets{};
+
+    void Record(u64 ns);
+    void Reset();
+};
+
+/// Returns the histogram bucket for a call that took the provided amount of nanoseconds.
+std::size_t BucketIndex(u64 ns);
+
+namespace Detail {
+extern std::atomic<bool> enabled;
+}
+
+/// Returns whether calls are currently being recorded. This is the only cost paid when disabled.
+inline bool IsEnabled() {
+    return Detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Enables or disables recording of SVC and service command timings.
+void SetEnabled(bool enabled);
+
+/// Clears all recorded statistics. Calls in flight on other threads may still land afterwards.
+void Reset();
+
+/// Records a finished SVC. The name must have static storage duration.
+void RecordSVC(u32 immediate, const char* name, u64 ns);
+
+/**
+ * Records a finished HLE service command.
+ * @param service Identifies the service instance, used together with the header as the key.
+ * @param header Command header of the request.
+ * @param service_name Name of the service port.
+ * @param function_name Name of the command handler. Must have static storage duration.
+ */
+void RecordServiceCommand(const void* service, u32 header, const std::string& service_name,
+                          const char* function_name, u64 ns);
+
+/// Merges the statistics of all threads and returns them as a JSON document.
+std::string ExportJson();
+
+/// Measures host time from construction, but only reads the clock while recording is enabled.
+class Stopwatch {
+public:
+    Stopwatch() : active{IsEnabled()} {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    bool IsActive() const {
+        return active;
+    }
+
+    u64 ElapsedNanoseconds() const {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+    }
+
+private:
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace HLE::CallProfiler
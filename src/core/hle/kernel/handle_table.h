@@ -89,6 +89,23 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle without taking a reference to the object. Use this when the object is
+     * not retained past the current call; the handle keeps it alive until then.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid.
+     */
+    Object* GetGenericPointer(Handle handle) const;
+
+    /**
+     * Looks up a handle while verifying its type, without taking a reference to the object.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* GetPointer(Handle handle) const {
+        return DynamicObjectCast<T>(GetGenericPointer(handle));
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
@@ -103,6 +103,39 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(std::shared_ptr<ServerSession> session_,
+                              std::shared_ptr<Thread> thread_) {
+    session = std::move(session_);
+    thread = std::move(thread_);
+    cmd_buf[0] = 0;
+    request_handles.clear();
+    request_mapped_buffers.clear();
+    for (auto& buffer : static_buffers) {
+        buffer.clear();
+    }
+}
+
+std::shared_ptr<HLERequestContext> KernelSystem::AcquireHLERequestContext(
+    std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread) {
+    if (hle_request_context_pool.empty()) {
+        return std::make_shared<HLERequestContext>(*this, std::move(session), std::move(thread));
+    }
+    auto context = std::move(hle_request_context_pool.back());
+    hle_request_context_pool.pop_back();
+    context->Reset(std::move(session), std::move(thread));
+    return context;
+}
+
+void KernelSystem::ReleaseHLERequestContext(std::shared_ptr<HLERequestContext> context) {
+    // A context captured by a wakeup callback must stay intact until the thread resumes.
+    if (context.use_count() != 1) {
+        return;
+    }
+    // Drop the references now so pooled contexts do not keep sessions or threads alive.
+    context->Reset(nullptr, nullptr);
+    hle_request_context_pool.push_back(std::move(context));
+}
+
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -176,11 +209,11 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector, reusing its storage from earlier requests.
+            auto& data = static_buffers[buffer_info.buffer_id];
+            data.resize(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
-            AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
             break;
         }
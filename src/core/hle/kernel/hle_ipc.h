@@ -292,6 +292,11 @@ public:
     friend class ThreadCallback;
 
 private:
+    friend class KernelSystem;
+
+    /// Drops all per-request state while keeping the allocated storage for the next request.
+    void Reset(std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread);
+
     KernelSystem& kernel;
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     std::shared_ptr<ServerSession> session;
@@ -101,9 +101,6 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
             IPC::StaticBufferDescInfo bufferInfo{descriptor};
             VAddr static_buffer_src_address = cmd_buf[i];
 
-            std::vector<u8> data(bufferInfo.size);
-            memory.ReadBlock(*src_process, static_buffer_src_address, data.data(), data.size());
-
             // Grab the address that the target thread set up to receive the response static buffer
             // and write our data there. The static buffers area is located right after the command
             // buffer area.
@@ -123,10 +120,12 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
 
             // Note: The real kernel doesn't seem to have any error recovery mechanisms for this
             // case.
-            ASSERT_MSG(target_buffer.descriptor.size >= data.size(),
+            ASSERT_MSG(target_buffer.descriptor.size >= bufferInfo.size,
                        "Static buffer data is too big");
 
-            memory.WriteBlock(*dst_process, target_buffer.address, data.data(), data.size());
+            // Copy straight between the two address spaces instead of staging the data.
+            memory.CopyBlock(*dst_process, *src_process, target_buffer.address,
+                             static_buffer_src_address, bufferInfo.size);
 
             cmd_buf[i++] = target_buffer.address;
             break;
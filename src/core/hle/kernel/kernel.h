@@ -50,6 +50,7 @@ class ClientPort;
 class ServerPort;
 class ClientSession;
 class ServerSession;
+class HLERequestContext;
 class ResourceLimitList;
 class SharedMemory;
 class ThreadManager;
@@ -235,6 +236,15 @@ public:
     }
 
     std::shared_ptr<Process> GetCurrentProcess() const;
+
+    /**
+     * Gets the current process without taking a reference to it. The pointer must not be kept
+     * beyond a point where the current process can change, e.g. a reschedule.
+     */
+    Process* GetCurrentProcessPointer() const {
+        return current_process.get();
+    }
+
     void SetCurrentProcess(std::shared_ptr<Process> process);
     void SetCurrentProcessForCPU(std::shared_ptr<Process> process, u32 core_id);
 
@@ -261,6 +271,19 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    /**
+     * Returns a context for an HLE service request, reusing a previously released one if possible
+     * so that the request does not need to allocate.
+     */
+    std::shared_ptr<HLERequestContext> AcquireHLERequestContext(
+        std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread);
+
+    /**
+     * Returns a finished context to the pool. Contexts that are still referenced elsewhere, for
+     * example by a sleeping thread, are left alone.
+     */
+    void ReleaseHLERequestContext(std::shared_ptr<HLERequestContext> context);
+
     std::shared_ptr<MemoryRegionInfo> GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -321,6 +344,9 @@ private:
 
     std::unique_ptr<IPCDebugger::Recorder> ipc_recorder;
 
+    /// Released HLE request contexts, kept around to avoid allocating one per request.
+    std::vector<std::shared_ptr<HLERequestContext>> hle_request_context_pool;
+
     u32 next_thread_id;
 
     friend class boost::serialization::access;
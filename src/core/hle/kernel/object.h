@@ -97,6 +97,15 @@ inline std::shared_ptr<T> DynamicObjectCast(std::shared_ptr<Object> object) {
     return nullptr;
 }
 
+/// Raw pointer variant of DynamicObjectCast, which does not touch the reference count.
+template <typename T>
+inline T* DynamicObjectCast(Object* object) {
+    if (object != nullptr && object->GetHandleType() == T::HANDLE_TYPE) {
+        return static_cast<T*>(object);
+    }
+    return nullptr;
+}
+
 } // namespace Kernel
 
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(Kernel::Object)
@@ -13,6 +13,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/hle/call_profiler.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
@@ -358,6 +359,15 @@ private:
     Kernel::KernelSystem& kernel;
     Memory::MemorySystem& memory;
 
+    // The wakeup callbacks hold no per-wait state, so they are shared by all waiting threads
+    // instead of being allocated on every wait.
+    std::shared_ptr<WakeupCallback> sync_callback;
+    std::shared_ptr<WakeupCallback> sync_output_callback;
+    std::shared_ptr<WakeupCallback> ipc_callback;
+
+    /// Objects looked up by WaitSynchronizationN, kept to reuse its capacity between calls.
+    std::vector<WaitObject*> wait_objects_scratch;
+
     friend class SVCWrapper<SVC>;
 
     // ARM interfaces
@@ -790,7 +800,8 @@ private:
 
 /// Wait for a handle to synchronize, timeout after the specified nanoseconds
 ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
-    auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
+    WaitObject* object =
+        kernel.GetCurrentProcessPointer()->handle_table.GetPointer<WaitObject>(handle);
     Thread* thread = kernel.GetCurrentThreadManager().GetCurrentThread();
 
     if (object == nullptr)
@@ -804,14 +815,14 @@ ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
         if (nano_seconds == 0)
             return RESULT_TIMEOUT;
 
-        thread->wait_objects = {object};
+        thread->wait_objects = {SharedFrom(object)};
         object->AddWaitingThread(SharedFrom(thread));
         thread->status = ThreadStatus::WaitSynchAny;
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = std::make_shared<SVC_SyncCallback>(false);
+        thread->wakeup_callback = sync_callback;
 
         system.PrepareReschedule();
 
@@ -844,24 +855,37 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         return ERR_OUT_OF_RANGE;
     }
 
-    using ObjectPtr = std::shared_ptr<WaitObject>;
-    std::vector<ObjectPtr> objects(handle_count);
+    // The handle table keeps the objects alive for the duration of the SVC, so they are looked up
+    // without taking references. Only a thread that actually waits holds on to them.
+    auto& objects = wait_objects_scratch;
+    objects.clear();
 
+    HandleTable& handle_table = kernel.GetCurrentProcess()->handle_table;
     for (int i = 0; i < handle_count; ++i) {
         Handle handle = memory.Read32(handles_address + i * sizeof(Handle));
-        auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
+        WaitObject* object = handle_table.GetPointer<WaitObject>(handle);
         if (object == nullptr)
             return ERR_INVALID_HANDLE;
-        objects[i] = object;
+        objects.push_back(object);
     }
 
+    const auto wait_on_objects = [&] {
+        // Add the thread to each of the objects' waiting threads. wait_objects keeps its capacity
+        // from previous waits, so this doesn't allocate once the thread has waited before.
+        thread->wait_objects.clear();
+        for (WaitObject* object : objects) {
+            object->AddWaitingThread(SharedFrom(thread));
+            thread->wait_objects.push_back(SharedFrom(object));
+        }
+    };
+
     if (wait_all) {
         bool all_available =
             std::all_of(objects.begin(), objects.end(),
-                        [thread](const ObjectPtr& object) { return !object->ShouldWait(thread); });
+                        [thread](WaitObject* object) { return !object->ShouldWait(thread); });
         if (all_available) {
             // We can acquire all objects right now, do so.
-            for (auto& object : objects)
+            for (WaitObject* object : objects)
                 object->Acquire(thread);
             // Note: In this case, the `out` parameter is not set,
             // and retains whatever value it had before.
@@ -878,17 +902,12 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Put the thread to sleep
         thread->status = ThreadStatus::WaitSynchAll;
 
-        // Add the thread to each of the objects' waiting threads.
-        for (auto& object : objects) {
-            object->AddWaitingThread(SharedFrom(thread));
-        }
-
-        thread->wait_objects = std::move(objects);
+        wait_on_objects();
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = std::make_shared<SVC_SyncCallback>(false);
+        thread->wakeup_callback = sync_callback;
 
         system.PrepareReschedule();
 
@@ -899,13 +918,13 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         return RESULT_TIMEOUT;
     } else {
         // Find the first object that is acquirable in the provided list of objects
-        auto itr = std::find_if(objects.begin(), objects.end(), [thread](const ObjectPtr& object) {
+        auto itr = std::find_if(objects.begin(), objects.end(), [thread](WaitObject* object) {
             return !object->ShouldWait(thread);
         });
 
         if (itr != objects.end()) {
             // We found a ready object, acquire it and set the result value
-            WaitObject* object = itr->get();
+            WaitObject* object = *itr;
             object->Acquire(thread);
             *out = static_cast<s32>(std::distance(objects.begin(), itr));
             return RESULT_SUCCESS;
@@ -921,13 +940,7 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Put the thread to sleep
         thread->status = ThreadStatus::WaitSynchAny;
 
-        // Add the thread to each of the objects' waiting threads.
-        for (std::size_t i = 0; i < objects.size(); ++i) {
-            WaitObject* object = objects[i].get();
-            object->AddWaitingThread(SharedFrom(thread));
-        }
-
-        thread->wait_objects = std::move(objects);
+        wait_on_objects();
 
         // Note: If no handles and no timeout were given, then the thread will deadlock, this is
         // consistent with hardware behavior.
@@ -935,7 +948,7 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = std::make_shared<SVC_SyncCallback>(true);
+        thread->wakeup_callback = sync_output_callback;
 
         system.PrepareReschedule();
 
@@ -1079,7 +1092,7 @@ ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_co
 
     thread->wait_objects = std::move(objects);
 
-    thread->wakeup_callback = std::make_shared<SVC_IPCCallback>(system);
+    thread->wakeup_callback = ipc_callback;
 
     system.PrepareReschedule();
 
@@ -1104,8 +1117,8 @@ ResultCode SVC::ArbitrateAddress(Handle handle, u32 address, u32 type, u32 value
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}, address=0x{:08X}, type=0x{:08X}, value=0x{:08X}",
               handle, address, type, value);
 
-    std::shared_ptr<AddressArbiter> arbiter =
-        kernel.GetCurrentProcess()->handle_table.Get<AddressArbiter>(handle);
+    AddressArbiter* arbiter =
+        kernel.GetCurrentProcessPointer()->handle_table.GetPointer<AddressArbiter>(handle);
     if (arbiter == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1332,7 +1345,7 @@ ResultCode SVC::CreateMutex(Handle* out_handle, u32 initial_locked) {
 ResultCode SVC::ReleaseMutex(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}", handle);
 
-    std::shared_ptr<Mutex> mutex = kernel.GetCurrentProcess()->handle_table.Get<Mutex>(handle);
+    Mutex* mutex = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Mutex>(handle);
     if (mutex == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1398,8 +1411,8 @@ ResultCode SVC::CreateSemaphore(Handle* out_handle, s32 initial_count, s32 max_c
 ResultCode SVC::ReleaseSemaphore(s32* count, Handle handle, s32 release_count) {
     LOG_TRACE(Kernel_SVC, "called release_count={}, handle=0x{:08X}", release_count, handle);
 
-    std::shared_ptr<Semaphore> semaphore =
-        kernel.GetCurrentProcess()->handle_table.Get<Semaphore>(handle);
+    Semaphore* semaphore =
+        kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Semaphore>(handle);
     if (semaphore == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1492,7 +1505,7 @@ ResultCode SVC::DuplicateHandle(Handle* out, Handle handle) {
 ResultCode SVC::SignalEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1505,7 +1518,7 @@ ResultCode SVC::SignalEvent(Handle handle) {
 ResultCode SVC::ClearEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1529,7 +1542,7 @@ ResultCode SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
 ResultCode SVC::ClearTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1545,7 +1558,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
         return ERR_OUT_OF_RANGE_KERNEL;
     }
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1558,7 +1571,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 ResultCode SVC::CancelTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcessPointer()->handle_table.GetPointer<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -2319,14 +2332,23 @@ void SVC::CallSVC(u32 immediate) {
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
     if (info) {
         if (info->func) {
+            const HLE::CallProfiler::Stopwatch stopwatch;
             (this->*(info->func))();
+            if (stopwatch.IsActive()) {
+                HLE::CallProfiler::RecordSVC(immediate, info->name,
+                                             stopwatch.ElapsedNanoseconds());
+            }
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
         }
     }
 }
 
-SVC::SVC(Core::System& system) : system(system), kernel(system.Kernel()), memory(system.Memory()) {}
+SVC::SVC(Core::System& system)
+    : system(system), kernel(system.Kernel()), memory(system.Memory()),
+      sync_callback(std::make_shared<SVC_SyncCallback>(false)),
+      sync_output_callback(std::make_shared<SVC_SyncCallback>(true)),
+      ipc_callback(std::make_shared<SVC_IPCCallback>(system)) {}
 
 u32 SVC::GetReg(std::size_t n) {
     return system.GetRunningCore().GetReg(static_cast<int>(n));
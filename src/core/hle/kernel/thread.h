@@ -300,6 +300,10 @@ public:
 
     u64 last_running_ticks; ///< CPU tick when thread was last running
 
+    /// Links the thread into its ThreadManager's ready queue while it is Ready. Not serialized,
+    /// the ready queue relinks its threads when loaded.
+    Common::ThreadQueueHook<Thread> queue_hook{};
+
     s32 processor_id;
 
     VAddr tls_address; ///< Virtual address of the Thread Local Storage of the thread
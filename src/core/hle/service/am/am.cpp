@@ -3,17 +3,28 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <span>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
 #include "common/string_util.h"
+#include "common/thread.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -82,10 +93,89 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 class CIAFile::DecryptionState {
 public:
     std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+
+    // Hashes of the decrypted content, checked against the TMD once a content is complete
+    std::vector<CryptoPP::SHA256> content_hash;
+};
+
+/**
+ * Writes decrypted content data out on a worker thread, so that the disk writes of one chunk
+ * overlap with decrypting the next. The content files stay open until the install is finished.
+ */
+class CIAFile::ContentWriter {
+public:
+    /// Upper bound of data queued for writing before Write blocks
+    static constexpr std::size_t MaxPendingBytes = 32 * 1024 * 1024;
+
+    ContentWriter() : worker{1, "CIAWriter"} {}
+
+    ~ContentWriter() {
+        Finish();
+    }
+
+    void Reset(std::size_t content_count) {
+        Finish();
+        failed = false;
+        files.clear();
+        files.resize(content_count);
+    }
+
+    /**
+     * Queues data to be appended to a content.
+     * @param index the index of the content
+     * @param path the path of the content file, only used if the file is not opened yet
+     * @param data the data to write
+     */
+    void Write(std::size_t index, std::string path, std::vector<u8>&& data) {
+        {
+            std::unique_lock lock{mutex};
+            space_available.wait(lock, [this] { return pending_bytes < MaxPendingBytes; });
+            pending_bytes += data.size();
+        }
+        worker.QueueWork([this, index, path = std::move(path), data = std::move(data)] {
+            auto& file = files[index];
+            if (!file.IsOpen() && !failed) {
+                file = FileUtil::IOFile(path, "wb");
+            }
+            if (!failed && file.WriteBytes(data.data(), data.size()) != data.size()) {
+                LOG_ERROR(Service_AM, "Failed to write content {}", index);
+                failed = true;
+            }
+            {
+                std::scoped_lock lock{mutex};
+                pending_bytes -= data.size();
+            }
+            space_available.notify_one();
+        });
+    }
+
+    /// Waits for all queued writes and closes the content files
+    void Finish() {
+        worker.WaitForRequests();
+        for (auto& file : files) {
+            file.Close();
+        }
+    }
+
+    /// Whether any content failed to be written
+    bool Failed() const {
+        return failed;
+    }
+
+private:
+    std::vector<FileUtil::IOFile> files;
+    std::atomic_bool failed = false;
+
+    std::mutex mutex;
+    std::condition_variable space_available;
+    std::size_t pending_bytes = 0;
+
+    Common::ThreadWorker worker;
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
-    : media_type(media_type), decryption_state(std::make_unique<DecryptionState>()) {}
+    : media_type(media_type), decryption_state(std::make_unique<DecryptionState>()),
+      content_writer(std::make_unique<ContentWriter>()) {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -134,6 +224,8 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    decryption_state->content_hash.resize(content_count);
+    content_writer->Reset(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
         decryption_state->content.resize(content_count);
@@ -155,8 +247,9 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     // Data is not being buffered, so we have to keep track of how much of each <ID>.app
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
+    const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
     const u64 offset_max = offset + length;
-    for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    for (std::size_t i = 0; i < tmd.GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             const u64 size = container.GetContentSize(i);
@@ -165,20 +258,14 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // The unwritten range for this content is beyond the buffered data we have
             // or comes before the buffered data we have, so skip this content ID.
-            if (range_min > offset_max || range_max < offset) {
+            if (range_min >= offset_max || range_max < offset) {
                 continue;
             }
 
             // Figure out how much of this content ID we have just recieved/can write out
             const u64 available_to_write = std::min(offset_max, range_max) - range_min;
 
-            // Since the incoming TMD has already been written, we can use GetTitleContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
-
-            if (!file.IsOpen()) {
+            if (content_writer->Failed()) {
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
             }
 
@@ -194,13 +281,31 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
                 decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
             }
 
-            file.WriteBytes(temp.data(), temp.size());
+            auto& hash = decryption_state->content_hash[i];
+            hash.Update(temp.data(), temp.size());
+
+            // Since the incoming TMD has already been written, we can use GetTitleContentPath
+            // to get the content path to write to when the content is first seen.
+            std::string path;
+            if (content_written[i] == 0) {
+                path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+            }
+            content_writer->Write(i, std::move(path), std::move(temp));
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
             LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
                       content_written[i]);
+
+            if (content_written[i] == size) {
+                std::array<u8, CryptoPP::SHA256::DIGESTSIZE> digest;
+                hash.Final(digest.data());
+                // Patched titles are commonly repackaged without updating the TMD, so only warn
+                if (digest != tmd.GetContentHashByIndex(i)) {
+                    LOG_WARNING(Service_AM, "Content {} does not match the hash in the TMD", i);
+                }
+            }
         }
     }
 
@@ -287,7 +392,9 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
-    bool complete = true;
+    content_writer->Finish();
+
+    bool complete = !content_writer->Failed();
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
             complete = false;
@@ -343,6 +450,92 @@ bool CIAFile::Close() const {
 
 void CIAFile::Flush() const {}
 
+namespace {
+
+/**
+ * Reads a file sequentially on a separate thread into a small ring of large buffers, so that
+ * reading the next chunk overlaps with processing the current one.
+ */
+class ChunkReader {
+public:
+    // A multiple of the AES block size, so decryption state carries over between chunks
+    static constexpr std::size_t ChunkSize = 4 * 1024 * 1024;
+    static constexpr std::size_t NumChunks = 3;
+
+    explicit ChunkReader(FileUtil::IOFile& file) : file{file} {
+        for (std::size_t i = 0; i < NumChunks; ++i) {
+            chunks[i].resize(ChunkSize);
+            free_chunks.push(i);
+        }
+        thread = std::jthread([this](std::stop_token stop_token) { ReadLoop(stop_token); });
+    }
+
+    /**
+     * Gets the next chunk of the file, waiting for it to be read if needed. The returned data
+     * stays valid until the next call.
+     * @returns the chunk, or an empty span at the end of the file
+     */
+    std::span<const u8> Next() {
+        std::unique_lock lock{mutex};
+        if (current_chunk) {
+            free_chunks.push(*current_chunk);
+            current_chunk.reset();
+            condition.notify_all();
+        }
+        condition.wait(lock, [this] { return !filled_chunks.empty() || end_of_file; });
+        if (filled_chunks.empty()) {
+            return {};
+        }
+        const auto [index, size] = filled_chunks.front();
+        filled_chunks.pop();
+        current_chunk = index;
+        return {chunks[index].data(), size};
+    }
+
+private:
+    void ReadLoop(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("CIAReader");
+        bool done = false;
+        while (!done) {
+            std::size_t index;
+            {
+                std::unique_lock lock{mutex};
+                Common::CondvarWait(condition, lock, stop_token,
+                                    [this] { return !free_chunks.empty(); });
+                if (stop_token.stop_requested()) {
+                    return;
+                }
+                index = free_chunks.front();
+                free_chunks.pop();
+            }
+            const std::size_t size = file.ReadBytes(chunks[index].data(), ChunkSize);
+            done = size < ChunkSize;
+            {
+                std::scoped_lock lock{mutex};
+                if (size != 0) {
+                    filled_chunks.emplace(index, size);
+                }
+                end_of_file = done;
+            }
+            condition.notify_all();
+        }
+    }
+
+    FileUtil::IOFile& file;
+    std::array<std::vector<u8>, NumChunks> chunks;
+
+    std::mutex mutex;
+    std::condition_variable_any condition;
+    std::queue<std::size_t> free_chunks;
+    std::queue<std::pair<std::size_t, std::size_t>> filled_chunks;
+    std::optional<std::size_t> current_chunk;
+    bool end_of_file = false;
+
+    std::jthread thread;
+};
+
+} // Anonymous namespace
+
 InstallStatus InstallCIA(const std::string& path,
                          std::function<ProgressCallback>&& update_callback) {
     LOG_INFO(Service_AM, "Installing {}...", path);
@@ -372,21 +565,27 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        const std::size_t total_size = file.GetSize();
         std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
-
-            if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
-            if (result.Failed()) {
-                LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
-                          result.Code().raw);
-                return InstallStatus::ErrorAborted;
+        {
+            ChunkReader reader(file);
+            for (auto chunk = reader.Next(); !chunk.empty(); chunk = reader.Next()) {
+                auto result = installFile.Write(static_cast<u64>(total_bytes_read), chunk.size(),
+                                                false, chunk.data());
+                total_bytes_read += chunk.size();
+
+                if (update_callback)
+                    update_callback(total_bytes_read, total_size);
+                if (result.Failed()) {
+                    LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
+                              result.Code().raw);
+                    return InstallStatus::ErrorAborted;
+                }
             }
-            total_bytes_read += bytes_read;
+        }
+        if (total_bytes_read != total_size) {
+            LOG_ERROR(Service_AM, "Failed to read CIA file {}, aborting...", path);
+            return InstallStatus::ErrorAborted;
         }
         installFile.Close();
 
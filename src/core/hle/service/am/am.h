@@ -99,12 +99,16 @@ private:
 
     class DecryptionState;
     std::unique_ptr<DecryptionState> decryption_state;
+
+    class ContentWriter;
+    std::unique_ptr<ContentWriter> content_writer;
 };
 
 /**
- * Installs a CIA file from a specified file path.
+ * Installs a CIA file from a specified file path. The file is read on a separate thread while
+ * the previous chunk is verified and decrypted, and content data is written out on another one.
  * @param path file path of the CIA file to install
- * @param update_callback callback function called during filesystem write
+ * @param update_callback callback function called after each chunk has been processed
  * @returns bool whether the install was successful
  */
 InstallStatus InstallCIA(const std::string& path,
@@ -21,6 +21,7 @@
 #include "core/hle/service/hid/hid_spvr.h"
 #include "core/hle/service/hid/hid_user.h"
 #include "core/hle/service/service.h"
+#include "core/hw/gpu.h"
 #include "core/movie.h"
 #include "video_core/video_core.h"
 
@@ -49,7 +50,20 @@ void Module::serialize(Archive& ar, const unsigned int file_version) {
     if (file_version >= 1) {
         ar& state.hex;
     }
-    // Update events are set in the constructor
+    if (file_version >= 2) {
+        ar& next_pad_update_ticks;
+        ar& next_accelerometer_update_ticks;
+        ar& next_gyroscope_update_ticks;
+    } else if (Archive::is_loading::value) {
+        // Older states scheduled an event per device, the next update of each device is due now.
+        next_pad_update_ticks = 0;
+        next_accelerometer_update_ticks = 0;
+        next_gyroscope_update_ticks = 0;
+    }
+    if (Archive::is_loading::value) {
+        input_snapshot_valid = false;
+    }
+    // The update event is registered in the constructor
     // Devices are set from the implementation (and are stateless afaik)
 }
 SERIALIZE_IMPL(Module)
@@ -105,11 +119,81 @@ void Module::LoadInputDevices() {
     }
 }
 
-void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
-    SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
+void Module::PollAnalogDevices(u64 ticks) {
+    std::tie(input_snapshot.circle_pad_x, input_snapshot.circle_pad_y) = circle_pad->GetStatus();
+
+    if (enable_accelerometer_count > 0 || enable_gyroscope_count > 0) {
+        std::tie(input_snapshot.accel, input_snapshot.gyro) = motion_device->GetStatus();
+    }
+    if (enable_gyroscope_count > 0) {
+        input_snapshot.frame_time_scale = system.perf_stats->GetLastFrameTimeScale();
+    }
+
+    input_snapshot.slider_3d = Settings::values.factor_3d.GetValue() / 100.0f;
+
+    input_snapshot_ticks = ticks;
+    input_snapshot_valid = true;
+}
 
-    if (is_device_reload_pending.exchange(false))
+void Module::ScheduleUpdate() {
+    u64 next_update_ticks = next_pad_update_ticks;
+    if (enable_accelerometer_count > 0) {
+        next_update_ticks = std::min(next_update_ticks, next_accelerometer_update_ticks);
+    }
+    if (enable_gyroscope_count > 0) {
+        next_update_ticks = std::min(next_update_ticks, next_gyroscope_update_ticks);
+    }
+
+    Core::Timing& timing = system.CoreTiming();
+    const u64 ticks = timing.GetTicks();
+    const s64 cycles_into_future =
+        next_update_ticks > ticks ? static_cast<s64>(next_update_ticks - ticks) : 0;
+    timing.ScheduleEvent(cycles_into_future, update_event);
+}
+
+void Module::UpdateCallback(std::uintptr_t user_data, s64 cycles_late) {
+    // The time this event was scheduled for, which is the update time of at least one device.
+    const u64 ticks = system.CoreTiming().GetTicks() - cycles_late;
+
+    if (is_device_reload_pending.exchange(false)) {
         LoadInputDevices();
+        input_snapshot_valid = false;
+    }
+
+    // Analog and motion input is sampled once per emulated frame. The pad alone updates about four
+    // times per frame, and these inputs change too slowly for that to matter. Buttons and touch are
+    // still read on every pad update so that short presses are not lost.
+    if (!input_snapshot_valid || ticks - input_snapshot_ticks >= GPU::frame_ticks) {
+        PollAnalogDevices(ticks);
+    }
+
+    // Advances a device to its next update time. A device that fell more than a period behind, for
+    // example after loading an old savestate, continues from now instead of catching up.
+    const auto advance = [ticks](u64& next_ticks, u64 period) {
+        next_ticks += period;
+        if (next_ticks <= ticks) {
+            next_ticks = ticks + period;
+        }
+    };
+
+    if (next_pad_update_ticks <= ticks) {
+        UpdatePad();
+        advance(next_pad_update_ticks, pad_update_ticks);
+    }
+    if (enable_accelerometer_count > 0 && next_accelerometer_update_ticks <= ticks) {
+        UpdateAccelerometer();
+        advance(next_accelerometer_update_ticks, accelerometer_update_ticks);
+    }
+    if (enable_gyroscope_count > 0 && next_gyroscope_update_ticks <= ticks) {
+        UpdateGyroscope();
+        advance(next_gyroscope_update_ticks, gyroscope_update_ticks);
+    }
+
+    ScheduleUpdate();
+}
+
+void Module::UpdatePad() {
+    SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     using namespace Settings::NativeButton;
     state.a.Assign(buttons[A - BUTTON_HID_BEGIN]->GetStatus());
@@ -127,18 +211,16 @@ void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
     state.debug.Assign(buttons[Debug - BUTTON_HID_BEGIN]->GetStatus());
     state.gpio14.Assign(buttons[Gpio14 - BUTTON_HID_BEGIN]->GetStatus());
 
-    // Get current circle pad position and update circle pad direction
-    float circle_pad_x_f, circle_pad_y_f;
-    std::tie(circle_pad_x_f, circle_pad_y_f) = circle_pad->GetStatus();
-
     // xperia64: 0x9A seems to be the calibrated limit of the circle pad
     // Verified by using Input Redirector with very large-value digital inputs
     // on the circle pad and calibrating using the system settings application
     constexpr int MAX_CIRCLEPAD_POS = 0x9A; // Max value for a circle pad position
 
     // These are rounded rather than truncated on actual hardware
-    s16 circle_pad_new_x = static_cast<s16>(std::roundf(circle_pad_x_f * MAX_CIRCLEPAD_POS));
-    s16 circle_pad_new_y = static_cast<s16>(std::roundf(circle_pad_y_f * MAX_CIRCLEPAD_POS));
+    s16 circle_pad_new_x =
+        static_cast<s16>(std::roundf(input_snapshot.circle_pad_x * MAX_CIRCLEPAD_POS));
+    s16 circle_pad_new_y =
+        static_cast<s16>(std::roundf(input_snapshot.circle_pad_y * MAX_CIRCLEPAD_POS));
     s16 circle_pad_x =
         (circle_pad_new_x + std::accumulate(circle_pad_old_x.begin(), circle_pad_old_x.end(), 0)) /
         CIRCLE_PAD_AVERAGING;
@@ -218,24 +300,18 @@ void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
 
     // TODO(xperia64): How the 3D Slider is updated by the HID module needs to be RE'd
     // and possibly moved to its own Core::Timing event.
-    mem->pad.sliderstate_3d = (Settings::values.factor_3d.GetValue() / 100.0f);
-    system.Kernel().GetSharedPageHandler().Set3DSlider(Settings::values.factor_3d.GetValue() /
-                                                       100.0f);
-
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
+    mem->pad.sliderstate_3d = input_snapshot.slider_3d;
+    system.Kernel().GetSharedPageHandler().Set3DSlider(input_snapshot.slider_3d);
 }
 
-void Module::UpdateAccelerometerCallback(std::uintptr_t user_data, s64 cycles_late) {
+void Module::UpdateAccelerometer() {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     mem->accelerometer.index = next_accelerometer_index;
     next_accelerometer_index = (next_accelerometer_index + 1) % mem->accelerometer.entries.size();
 
-    Common::Vec3<float> accel;
-    std::tie(accel, std::ignore) = motion_device->GetStatus();
-    accel *= accelerometer_coef;
-    // TODO(wwylele): do a time stretch like the one in UpdateGyroscopeCallback
+    Common::Vec3<float> accel = input_snapshot.accel * accelerometer_coef;
+    // TODO(wwylele): do a time stretch like the one in UpdateGyroscope
     // The time stretch formula should be like
     // stretched_vector = (raw_vector - gravity) * stretch_ratio + gravity
 
@@ -265,13 +341,9 @@ void Module::UpdateAccelerometerCallback(std::uintptr_t user_data, s64 cycles_la
     }
 
     event_accelerometer->Signal();
-
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(accelerometer_update_ticks - cycles_late,
-                                      accelerometer_update_event);
 }
 
-void Module::UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late) {
+void Module::UpdateGyroscope() {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     mem->gyroscope.index = next_gyroscope_index;
@@ -279,10 +351,8 @@ void Module::UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late)
 
     GyroscopeDataEntry& gyroscope_entry = mem->gyroscope.entries[mem->gyroscope.index];
 
-    Common::Vec3<float> gyro;
-    std::tie(std::ignore, gyro) = motion_device->GetStatus();
-    double stretch = system.perf_stats->GetLastFrameTimeScale();
-    gyro *= gyroscope_coef * static_cast<float>(stretch);
+    Common::Vec3<float> gyro = input_snapshot.gyro;
+    gyro *= gyroscope_coef * static_cast<float>(input_snapshot.frame_time_scale);
     gyroscope_entry.x = static_cast<s16>(gyro.x);
     gyroscope_entry.y = static_cast<s16>(gyro.y);
     gyroscope_entry.z = static_cast<s16>(gyro.z);
@@ -301,9 +371,6 @@ void Module::UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late)
     }
 
     event_gyroscope->Signal();
-
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(gyroscope_update_ticks - cycles_late, gyroscope_update_event);
 }
 
 void Module::Interface::GetIPCHandles(Kernel::HLERequestContext& ctx) {
@@ -319,10 +386,13 @@ void Module::Interface::EnableAccelerometer(Kernel::HLERequestContext& ctx) {
 
     ++hid->enable_accelerometer_count;
 
-    // Schedules the accelerometer update event if the accelerometer was just enabled
+    // Starts the accelerometer updates if the accelerometer was just enabled
     if (hid->enable_accelerometer_count == 1) {
-        hid->system.CoreTiming().ScheduleEvent(accelerometer_update_ticks,
-                                               hid->accelerometer_update_event);
+        Core::Timing& timing = hid->system.CoreTiming();
+        hid->next_accelerometer_update_ticks = timing.GetTicks() + accelerometer_update_ticks;
+        hid->input_snapshot_valid = false;
+        timing.UnscheduleEvent(hid->update_event, 0);
+        hid->ScheduleUpdate();
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -336,9 +406,10 @@ void Module::Interface::DisableAccelerometer(Kernel::HLERequestContext& ctx) {
 
     --hid->enable_accelerometer_count;
 
-    // Unschedules the accelerometer update event if the accelerometer was just disabled
+    // Stops the accelerometer updates if the accelerometer was just disabled
     if (hid->enable_accelerometer_count == 0) {
-        hid->system.CoreTiming().UnscheduleEvent(hid->accelerometer_update_event, 0);
+        hid->system.CoreTiming().UnscheduleEvent(hid->update_event, 0);
+        hid->ScheduleUpdate();
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -352,9 +423,13 @@ void Module::Interface::EnableGyroscopeLow(Kernel::HLERequestContext& ctx) {
 
     ++hid->enable_gyroscope_count;
 
-    // Schedules the gyroscope update event if the gyroscope was just enabled
+    // Starts the gyroscope updates if the gyroscope was just enabled
     if (hid->enable_gyroscope_count == 1) {
-        hid->system.CoreTiming().ScheduleEvent(gyroscope_update_ticks, hid->gyroscope_update_event);
+        Core::Timing& timing = hid->system.CoreTiming();
+        hid->next_gyroscope_update_ticks = timing.GetTicks() + gyroscope_update_ticks;
+        hid->input_snapshot_valid = false;
+        timing.UnscheduleEvent(hid->update_event, 0);
+        hid->ScheduleUpdate();
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -368,9 +443,10 @@ void Module::Interface::DisableGyroscopeLow(Kernel::HLERequestContext& ctx) {
 
     --hid->enable_gyroscope_count;
 
-    // Unschedules the gyroscope update event if the gyroscope was just disabled
+    // Stops the gyroscope updates if the gyroscope was just disabled
     if (hid->enable_gyroscope_count == 0) {
-        hid->system.CoreTiming().UnscheduleEvent(hid->gyroscope_update_event, 0);
+        hid->system.CoreTiming().UnscheduleEvent(hid->update_event, 0);
+        hid->ScheduleUpdate();
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -437,22 +513,23 @@ Module::Module(Core::System& system) : system(system) {
     event_gyroscope = system.Kernel().CreateEvent(ResetType::OneShot, "HID:EventGyroscope");
     event_debug_pad = system.Kernel().CreateEvent(ResetType::OneShot, "HID:EventDebugPad");
 
-    // Register update callbacks
+    // Register the update callback. The per device events of older versions are still registered
+    // so that their events in older savestates hand over to the shared update event.
     Core::Timing& timing = system.CoreTiming();
-    pad_update_event = timing.RegisterEvent("HID::UpdatePadCallback",
-                                            [this](std::uintptr_t user_data, s64 cycles_late) {
-                                                UpdatePadCallback(user_data, cycles_late);
-                                            });
-    accelerometer_update_event = timing.RegisterEvent(
-        "HID::UpdateAccelerometerCallback", [this](std::uintptr_t user_data, s64 cycles_late) {
-            UpdateAccelerometerCallback(user_data, cycles_late);
+    update_event = timing.RegisterEvent(
+        "HID::UpdateCallback", [this](std::uintptr_t user_data, s64 cycles_late) {
+            UpdateCallback(user_data, cycles_late);
         });
-    gyroscope_update_event = timing.RegisterEvent(
-        "HID::UpdateGyroscopeCallback", [this](std::uintptr_t user_data, s64 cycles_late) {
-            UpdateGyroscopeCallback(user_data, cycles_late);
+    for (const char* legacy_name : {"HID::UpdatePadCallback", "HID::UpdateAccelerometerCallback",
+                                    "HID::UpdateGyroscopeCallback"}) {
+        timing.RegisterEvent(legacy_name, [this](std::uintptr_t user_data, s64 cycles_late) {
+            this->system.CoreTiming().UnscheduleEvent(update_event, 0);
+            UpdateCallback(user_data, cycles_late);
         });
+    }
 
-    timing.ScheduleEvent(pad_update_ticks, pad_update_event);
+    next_pad_update_ticks = timing.GetTicks() + pad_update_ticks;
+    ScheduleUpdate();
 }
 
 void Module::ReloadInputDevices() {
@@ -14,6 +14,7 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/settings.h"
+#include "common/vector_math.h"
 #include "core/core_timing.h"
 #include "core/frontend/input.h"
 #include "core/hle/service/service.h"
@@ -306,10 +307,33 @@ public:
     static constexpr u64 gyroscope_update_ticks = BASE_CLOCK_RATE_ARM11 / 101;
 
 private:
+    /// Analog and motion input shared by all the shared memory updates of one emulated frame.
+    struct InputSnapshot {
+        float circle_pad_x = 0.0f;
+        float circle_pad_y = 0.0f;
+        Common::Vec3<float> accel{};
+        Common::Vec3<float> gyro{};
+        double frame_time_scale = 1.0;
+        float slider_3d = 0.0f;
+    };
+
     void LoadInputDevices();
-    void UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late);
-    void UpdateAccelerometerCallback(std::uintptr_t user_data, s64 cycles_late);
-    void UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late);
+
+    /**
+     * Polls the analog and motion host input devices into input_snapshot. Motion is only polled
+     * while the accelerometer or gyroscope is enabled.
+     */
+    void PollAnalogDevices(u64 ticks);
+
+    /// Schedules update_event at the earliest update due among the enabled devices.
+    void ScheduleUpdate();
+
+    /// Runs every device update that is due, then schedules the next one.
+    void UpdateCallback(std::uintptr_t user_data, s64 cycles_late);
+
+    void UpdatePad();
+    void UpdateAccelerometer();
+    void UpdateGyroscope();
 
     Core::System& system;
 
@@ -343,9 +367,15 @@ private:
     int enable_accelerometer_count = 0; // positive means enabled
     int enable_gyroscope_count = 0;     // positive means enabled
 
-    Core::TimingEventType* pad_update_event;
-    Core::TimingEventType* accelerometer_update_event;
-    Core::TimingEventType* gyroscope_update_event;
+    // All devices share one timing event, which fires at the earliest of their next update times.
+    Core::TimingEventType* update_event;
+    u64 next_pad_update_ticks = 0;
+    u64 next_accelerometer_update_ticks = 0;
+    u64 next_gyroscope_update_ticks = 0;
+
+    InputSnapshot input_snapshot;
+    u64 input_snapshot_ticks = 0;
+    bool input_snapshot_valid = false;
 
     std::atomic<bool> is_device_reload_pending{true};
     std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeButton::NUM_BUTTONS_HID>
@@ -367,4 +397,4 @@ void InstallInterfaces(Core::System& system);
 
 SERVICE_CONSTRUCT(Service::HID::Module)
 BOOST_CLASS_EXPORT_KEY(Service::HID::Module)
-BOOST_CLASS_VERSION(Service::HID::Module, 1)
+BOOST_CLASS_VERSION(Service::HID::Module, 2)
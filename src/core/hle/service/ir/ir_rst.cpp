@@ -13,6 +13,7 @@
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hle/service/ir/ir_rst.h"
+#include "core/hw/gpu.h"
 #include "core/movie.h"
 
 SERIALIZE_EXPORT_IMPL(Service::IR::IR_RST)
@@ -69,19 +70,28 @@ void IR_RST::UnloadInputDevices() {
 void IR_RST::UpdateCallback(std::uintptr_t user_data, s64 cycles_late) {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_memory->GetPointer());
 
-    if (is_device_reload_pending.exchange(false))
+    if (is_device_reload_pending.exchange(false)) {
         LoadInputDevices();
+        input_snapshot_valid = false;
+    }
+
+    // The c-stick is sampled at most once per emulated frame, games commonly ask for updates every
+    // few milliseconds. ZL and ZR are read on every update so that short presses are not lost.
+    const u64 ticks = system.CoreTiming().GetTicks() - cycles_late;
+    if (!input_snapshot_valid || ticks - input_snapshot_ticks >= GPU::frame_ticks) {
+        std::tie(input_snapshot.c_stick_x, input_snapshot.c_stick_y) = c_stick->GetStatus();
+        input_snapshot_ticks = ticks;
+        input_snapshot_valid = true;
+    }
 
     PadState state;
     state.zl.Assign(zl_button->GetStatus());
     state.zr.Assign(zr_button->GetStatus());
 
     // Get current c-stick position and update c-stick direction
-    float c_stick_x_f, c_stick_y_f;
-    std::tie(c_stick_x_f, c_stick_y_f) = c_stick->GetStatus();
     constexpr int MAX_CSTICK_RADIUS = 0x9C; // Max value for a c-stick radius
-    s16 c_stick_x = static_cast<s16>(c_stick_x_f * MAX_CSTICK_RADIUS);
-    s16 c_stick_y = static_cast<s16>(c_stick_y_f * MAX_CSTICK_RADIUS);
+    s16 c_stick_x = static_cast<s16>(input_snapshot.c_stick_x * MAX_CSTICK_RADIUS);
+    s16 c_stick_y = static_cast<s16>(input_snapshot.c_stick_y * MAX_CSTICK_RADIUS);
 
     Core::Movie::GetInstance().HandleIrRst(state, c_stick_x, c_stick_y);
 
@@ -76,6 +76,12 @@ private:
     void UnloadInputDevices();
     void UpdateCallback(std::uintptr_t user_data, s64 cycles_late);
 
+    /// C-stick state shared by the pad updates of one emulated frame.
+    struct InputSnapshot {
+        float c_stick_x = 0.0f;
+        float c_stick_y = 0.0f;
+    };
+
     Core::System& system;
     std::shared_ptr<Kernel::Event> update_event;
     std::shared_ptr<Kernel::SharedMemory> shared_memory;
@@ -85,6 +91,9 @@ private:
     std::unique_ptr<Input::ButtonDevice> zr_button;
     std::unique_ptr<Input::AnalogDevice> c_stick;
     std::atomic<bool> is_device_reload_pending{false};
+    InputSnapshot input_snapshot;
+    u64 input_snapshot_ticks{0};
+    bool input_snapshot_valid{false};
     bool raw_c_stick{false};
     int update_period{0};
 
@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/ldr_ro/cro_helper.h"
+#include "core/hle/service/ldr_ro/cro_symbol_index.h"
 
 namespace Service::LDR {
 
@@ -150,6 +151,12 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
 }
 
 VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
+    if (symbol_index) {
+        if (const auto symbol_address = symbol_index->FindInModule(module_address, name)) {
+            return *symbol_address;
+        }
+    }
+
     if (!GetField(ExportTreeNum))
         return 0;
 
@@ -195,6 +202,29 @@ VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
     return SegmentTagToAddress(symbol_entry.symbol_position);
 }
 
+std::tuple<VAddr, VAddr> CROHelper::FindAutoLinkExport(VAddr crs_address,
+                                                       const std::string& name) const {
+    if (symbol_index) {
+        const auto* symbol = symbol_index->Find(name);
+        if (symbol == nullptr) {
+            return std::make_tuple(0, 0);
+        }
+        return std::make_tuple(symbol->module_address, symbol->symbol_address);
+    }
+
+    VAddr module_address = 0;
+    VAddr symbol_address = 0;
+    ForEachAutoLinkCRO(process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+        symbol_address = source.FindExportNamedSymbol(name);
+        if (symbol_address != 0) {
+            module_address = source.GetModuleAddress();
+            return MakeResult<bool>(false);
+        }
+        return MakeResult<bool>(true);
+    });
+    return std::make_tuple(module_address, symbol_address);
+}
+
 ResultCode CROHelper::RebaseHeader(u32 cro_size) {
     ResultCode error = CROFormatError(0x11);
 
@@ -759,29 +789,20 @@ ResultCode CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
                                   sizeof(ExternalRelocationEntry));
 
         if (!relocation_entry.is_batch_resolved) {
-            ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    std::string symbol_name =
-                        system.Memory().ReadCString(entry.name_offset, import_strings_size);
-                    u32 symbol_address = source.FindExportNamedSymbol(symbol_name);
-
-                    if (symbol_address != 0) {
-                        LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"",
-                                  ModuleName(), symbol_name, source.ModuleName());
-
-                        ResultCode result = ApplyRelocationBatch(relocation_addr, symbol_address);
-                        if (result.IsError()) {
-                            LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}",
-                                      result.raw);
-                            return result;
-                        }
+            std::string symbol_name =
+                system.Memory().ReadCString(entry.name_offset, import_strings_size);
+            const auto [source_address, symbol_address] =
+                FindAutoLinkExport(crs_address, symbol_name);
+            if (symbol_address == 0) {
+                continue;
+            }
 
-                        return MakeResult<bool>(false);
-                    }
+            LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"", ModuleName(),
+                      symbol_name, CROHelper(source_address, process, system).ModuleName());
 
-                    return MakeResult<bool>(true);
-                });
+            ResultCode result = ApplyRelocationBatch(relocation_addr, symbol_address);
             if (result.IsError()) {
+                LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}", result.raw);
                 return result;
             }
         }
@@ -1075,26 +1096,16 @@ ResultCode CROHelper::ApplyExitRelocations(VAddr crs_address) {
 
         if (system.Memory().ReadCString(entry.name_offset, import_strings_size) ==
             "__aeabi_atexit") {
-            ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    u32 symbol_address = source.FindExportNamedSymbol("nnroAeabiAtexit_");
-
-                    if (symbol_address != 0) {
-                        LOG_DEBUG(Service_LDR, "CRO \"{}\" import exit function from \"{}\"",
-                                  ModuleName(), source.ModuleName());
-
-                        ResultCode result = ApplyRelocationBatch(relocation_addr, symbol_address);
-                        if (result.IsError()) {
-                            LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}",
-                                      result.raw);
-                            return result;
-                        }
+            const auto [source_address, symbol_address] =
+                FindAutoLinkExport(crs_address, "nnroAeabiAtexit_");
+            if (symbol_address == 0) {
+                continue;
+            }
 
-                        return MakeResult<bool>(false);
-                    }
+            LOG_DEBUG(Service_LDR, "CRO \"{}\" import exit function from \"{}\"", ModuleName(),
+                      CROHelper(source_address, process, system).ModuleName());
 
-                    return MakeResult<bool>(true);
-                });
+            ResultCode result = ApplyRelocationBatch(relocation_addr, symbol_address);
             if (result.IsError()) {
                 LOG_ERROR(Service_LDR, "Error applying exit relocation {:08X}", result.raw);
                 return result;
@@ -1533,4 +1544,26 @@ std::tuple<VAddr, u32> CROHelper::GetExecutablePages() const {
     return std::make_tuple(0, 0);
 }
 
+std::vector<std::pair<std::string, VAddr>> CROHelper::GetExportNamedSymbols() const {
+    std::vector<std::pair<std::string, VAddr>> symbols;
+    if (!GetField(ExportTreeNum))
+        return symbols;
+
+    u32 export_strings_size = GetField(ExportStringsSize);
+    u32 export_named_symbol_num = GetField(ExportNamedSymbolNum);
+    symbols.reserve(export_named_symbol_num);
+    for (u32 i = 0; i < export_named_symbol_num; ++i) {
+        ExportNamedSymbolEntry entry;
+        GetEntry(system.Memory(), i, entry);
+        std::string name = system.Memory().ReadCString(entry.name_offset, export_strings_size);
+
+        // Go through the tree so that names it can't reach or duplicates resolve the same way.
+        VAddr symbol_address = FindExportNamedSymbol(name);
+        if (symbol_address != 0) {
+            symbols.emplace_back(std::move(name), symbol_address);
+        }
+    }
+    return symbols;
+}
+
 } // namespace Service::LDR
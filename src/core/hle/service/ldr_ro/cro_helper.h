@@ -5,7 +5,10 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -19,6 +22,8 @@ class ARM_Interface;
 
 namespace Service::LDR {
 
+class CROSymbolIndex;
+
 #define ASSERT_CRO_STRUCT(name, size)                                                              \
     static_assert(std::is_standard_layout<name>::value,                                            \
                   "CRO structure " #name " doesn't use standard layout");                          \
@@ -33,8 +38,18 @@ static constexpr u32 CRO_HASH_SIZE = 0x80;
 class CROHelper final {
 public:
     // TODO (wwylele): pass in the process handle for memory access
-    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system)
-        : module_address(cro_address), process(process), system(system) {}
+    /**
+     * @param symbol_index optional index of the auto-link module exports, used instead of walking
+     *        the export trees in guest memory. It must have been synchronized with the module list.
+     */
+    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system,
+                       const CROSymbolIndex* symbol_index = nullptr)
+        : module_address(cro_address), process(process), system(system),
+          symbol_index(symbol_index) {}
+
+    VAddr GetModuleAddress() const {
+        return module_address;
+    }
 
     std::string ModuleName() const {
         return system.Memory().ReadCString(GetField(ModuleNameOffset), GetField(ModuleNameSize));
@@ -140,10 +155,20 @@ public:
      */
     std::tuple<VAddr, u32> GetExecutablePages() const;
 
+    /**
+     * Gets all named symbols exported by this module, resolved through the export tree exactly as
+     * FindExportNamedSymbol would resolve them.
+     * @returns a list of (name, address) pairs.
+     */
+    std::vector<std::pair<std::string, VAddr>> GetExportNamedSymbols() const;
+
 private:
+    friend class CROSymbolIndex;
+
     const VAddr module_address; ///< the virtual address of this module
     Kernel::Process& process;   ///< the owner process of this module
     Core::System& system;
+    const CROSymbolIndex* symbol_index; ///< optional host side index of exported symbols
 
     /**
      * Each item in this enum represents a u32 field in the header begin from address+0x80,
@@ -523,6 +548,15 @@ private:
      */
     VAddr FindExportNamedSymbol(const std::string& name) const;
 
+    /**
+     * Finds an exported named symbol in the first auto-link module exporting it, through the
+     * symbol index if there is one, otherwise by walking the export tree of each module.
+     * @param crs_address the virtual address of the static module
+     * @param name the name of the symbol to find
+     * @returns a tuple of (module address, symbol address); (0, 0) if no module exports it.
+     */
+    std::tuple<VAddr, VAddr> FindAutoLinkExport(VAddr crs_address, const std::string& name) const;
+
     /**
      * Rebases offsets in module header according to module address.
      * @param cro_size the size of the CRO file
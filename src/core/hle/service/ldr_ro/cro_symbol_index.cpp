@@ -0,0 +1,80 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <unordered_set>
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/service/ldr_ro/cro_helper.h"
+#include "core/hle/service/ldr_ro/cro_symbol_index.h"
+
+namespace Service::LDR {
+
+void CROSymbolIndex::Sync(Kernel::Process& process, Core::System& system, VAddr crs_address) {
+    std::vector<VAddr> current_order;
+    current_order.reserve(link_order.size() + 1);
+    CROHelper::ForEachAutoLinkCRO(process, system, crs_address,
+                                  [&](CROHelper module) -> ResultVal<bool> {
+                                      current_order.push_back(module.GetModuleAddress());
+                                      return MakeResult<bool>(true);
+                                  });
+
+    Sync(std::move(current_order), [&](VAddr module_address) {
+        return CROHelper(module_address, process, system).GetExportNamedSymbols();
+    });
+}
+
+void CROSymbolIndex::Sync(std::vector<VAddr> module_order, const ExportReader& read_exports) {
+    if (module_order == link_order) {
+        return;
+    }
+
+    // Forget modules that left the list, another module may be loaded at the same address later.
+    const std::unordered_set<VAddr> current_set(module_order.begin(), module_order.end());
+    std::erase_if(module_exports,
+                  [&](const auto& entry) { return !current_set.contains(entry.first); });
+
+    for (const VAddr module_address : module_order) {
+        if (module_exports.contains(module_address)) {
+            continue;
+        }
+        auto& symbols = module_exports[module_address];
+        for (auto& [name, symbol_address] : read_exports(module_address)) {
+            symbols.emplace(std::move(name), symbol_address);
+        }
+    }
+
+    exports.clear();
+    for (const VAddr module_address : module_order) {
+        for (const auto& [name, symbol_address] : module_exports[module_address]) {
+            exports.try_emplace(name, Export{module_address, symbol_address});
+        }
+    }
+
+    link_order = std::move(module_order);
+    LOG_DEBUG(Service_LDR, "Indexed {} named symbols from {} modules", exports.size(),
+              link_order.size());
+}
+
+void CROSymbolIndex::Clear() {
+    link_order.clear();
+    module_exports.clear();
+    exports.clear();
+}
+
+const CROSymbolIndex::Export* CROSymbolIndex::Find(const std::string& name) const {
+    const auto it = exports.find(name);
+    return it != exports.end() ? &it->second : nullptr;
+}
+
+std::optional<VAddr> CROSymbolIndex::FindInModule(VAddr module_address,
+                                                  const std::string& name) const {
+    const auto module_it = module_exports.find(module_address);
+    if (module_it == module_exports.end()) {
+        return std::nullopt;
+    }
+    const auto it = module_it->second.find(name);
+    return it != module_it->second.end() ? it->second : 0;
+}
+
+} // namespace Service::LDR
@@ -0,0 +1,83 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace Kernel {
+class Process;
+}
+
+namespace Service::LDR {
+
+/**
+ * Host side copy of the named symbols exported by the auto-link modules of a process. Looking up
+ * a symbol here replaces walking the export tree of every registered module in guest memory.
+ *
+ * The guest module list stays the source of truth: the index is resynchronized against it before
+ * each linking operation, so it doesn't need to be serialized and recovers from any change of the
+ * list made behind its back.
+ */
+class CROSymbolIndex {
+public:
+    struct Export {
+        VAddr module_address; ///< the module exporting the symbol
+        VAddr symbol_address; ///< the address of the symbol
+    };
+
+    /// Reads the named exports of a module as (name, address) pairs.
+    using ExportReader =
+        std::function<std::vector<std::pair<std::string, VAddr>>(VAddr module_address)>;
+
+    /**
+     * Brings the index up to date with the auto-link module list. Only modules that were not
+     * indexed yet have their export tables read.
+     * @param crs_address the virtual address of the static module
+     */
+    void Sync(Kernel::Process& process, Core::System& system, VAddr crs_address);
+
+    /**
+     * Brings the index up to date with a module list.
+     * @param module_order the auto-link modules in list order, starting with the static module
+     * @param read_exports reader called for each module that was not indexed yet
+     */
+    void Sync(std::vector<VAddr> module_order, const ExportReader& read_exports);
+
+    /// Drops all indexed modules.
+    void Clear();
+
+    /**
+     * Finds an exported named symbol in the first auto-link module exporting it, in the same order
+     * CROHelper::ForEachAutoLinkCRO visits them.
+     * @returns the exporting module and symbol address; nullptr if no module exports it.
+     */
+    const Export* Find(const std::string& name) const;
+
+    /**
+     * Finds an exported named symbol in a specific module.
+     * @returns the symbol address, 0 if not exported; std::nullopt if the module is not indexed.
+     */
+    std::optional<VAddr> FindInModule(VAddr module_address, const std::string& name) const;
+
+private:
+    /// Auto-link modules in list order, starting with the static module.
+    std::vector<VAddr> link_order;
+    /// Named exports of each indexed module.
+    std::unordered_map<VAddr, std::unordered_map<std::string, VAddr>> module_exports;
+    /// Named exports resolved against the first exporting module in link_order.
+    std::unordered_map<std::string, Export> exports;
+};
+
+} // namespace Service::LDR
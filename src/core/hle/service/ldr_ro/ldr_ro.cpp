@@ -261,7 +261,8 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         return;
     }
 
-    CROHelper cro(cro_address, *process, system);
+    slot->symbol_index.Sync(*process, system, slot->loaded_crs);
+    CROHelper cro(cro_address, *process, system, &slot->symbol_index);
 
     result = cro.VerifyHash(cro_size, crr_address);
     if (result.IsError()) {
@@ -343,8 +344,6 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}, zero={}, cro_buffer_ptr=0x{:08X}",
               cro_address, zero, cro_buffer_ptr);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
@@ -354,6 +353,9 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    slot->symbol_index.Sync(*process, system, slot->loaded_crs);
+    CROHelper cro(cro_address, *process, system, &slot->symbol_index);
+
     if (cro_address & Memory::CITRA_PAGE_MASK) {
         LOG_ERROR(Service_LDR, "CRO address is not aligned");
         rb.Push(ERROR_MISALIGNED_ADDRESS);
@@ -410,8 +412,6 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
@@ -421,6 +421,9 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    slot->symbol_index.Sync(*process, system, slot->loaded_crs);
+    CROHelper cro(cro_address, *process, system, &slot->symbol_index);
+
     if (cro_address & Memory::CITRA_PAGE_MASK) {
         LOG_ERROR(Service_LDR, "CRO address is not aligned");
         rb.Push(ERROR_MISALIGNED_ADDRESS);
@@ -450,8 +453,6 @@ void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
@@ -461,6 +462,9 @@ void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    slot->symbol_index.Sync(*process, system, slot->loaded_crs);
+    CROHelper cro(cro_address, *process, system, &slot->symbol_index);
+
     if (cro_address & Memory::CITRA_PAGE_MASK) {
         LOG_ERROR(Service_LDR, "CRO address is not aligned");
         rb.Push(ERROR_MISALIGNED_ADDRESS);
@@ -511,6 +515,7 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
     }
 
     slot->loaded_crs = 0;
+    slot->symbol_index.Clear();
     rb.Push(result);
 }
 
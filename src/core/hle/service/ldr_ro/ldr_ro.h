@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/hle/service/ldr_ro/cro_symbol_index.h"
 #include "core/hle/service/service.h"
 
 namespace Core {
@@ -14,6 +15,8 @@ namespace Service::LDR {
 
 struct ClientSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     VAddr loaded_crs = 0; ///< the virtual address of the static module
+    /// Exports of the auto-link modules, rebuilt from guest memory so it is not serialized
+    CROSymbolIndex symbol_index;
 
 private:
     template <class Archive>
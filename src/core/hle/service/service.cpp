@@ -7,6 +7,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/hle/call_profiler.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/handle_table.h"
@@ -179,7 +180,12 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+    const HLE::CallProfiler::Stopwatch stopwatch;
     handler_invoker(this, info->handler_callback, context);
+    if (stopwatch.IsActive()) {
+        HLE::CallProfiler::RecordServiceCommand(this, header_code, service_name, info->name,
+                                                stopwatch.ElapsedNanoseconds());
+    }
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
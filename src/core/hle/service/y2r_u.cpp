@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <thread>
 #include "common/archives.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -521,7 +523,12 @@ void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
     Memory::RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size,
                                          Memory::FlushMode::FlushAndInvalidate);
 
-    HW::Y2R::PerformConversion(system.Memory(), conversion);
+    // The workers are only started once a title actually uses Y2R.
+    if (!workers) {
+        workers = std::make_unique<Common::ThreadWorker>(
+            std::max(std::thread::hardware_concurrency(), 2U) - 1, "Y2R");
+    }
+    HW::Y2R::PerformConversion(system.Memory(), conversion, workers.get());
 
     completion_event->Signal();
 
@@ -9,6 +9,7 @@
 #include <string>
 #include <boost/serialization/array.hpp>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
 
@@ -355,6 +356,9 @@ private:
     bool transfer_end_interrupt_enabled = false;
     bool spacial_dithering_enabled = false;
 
+    /// Threads converting the image strips, not serialized.
+    std::unique_ptr<Common::ThreadWorker> workers;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
     friend class boost::serialization::access;
@@ -2,14 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <numeric>
+#include <thread>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -47,26 +54,149 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[addr / 4];
 }
 
-static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Common::Color::DecodeRGBA8(src_pixel);
+/// Transfers with at least this many output pixels are split across the transfer workers.
+constexpr std::size_t MIN_PARALLEL_TRANSFER_PIXELS = 0x10000;
+/// Minimum number of output lines handled by a transfer worker task.
+constexpr u32 MIN_LINES_PER_TASK = 16;
 
-    case Regs::PixelFormat::RGB8:
-        return Common::Color::DecodeRGB8(src_pixel);
+/// Threads used by the software display transfer, created on first use.
+static std::unique_ptr<Common::ThreadWorker> transfer_workers;
 
-    case Regs::PixelFormat::RGB565:
+template <Regs::PixelFormat format>
+static Common::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
+        return Common::Color::DecodeRGBA8(src_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
+        return Common::Color::DecodeRGB8(src_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
         return Common::Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
         return Common::Color::DecodeRGB5A1(src_pixel);
+    } else {
+        return Common::Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+template <Regs::PixelFormat format>
+static void EncodePixel(const Common::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
+        Common::Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
+        Common::Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
+        Common::Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
+        Common::Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        Common::Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
 
+/**
+ * Decodes the pixels at the given offsets of a line. When downscaling, each pixel is averaged with
+ * the pixels following it in memory, which for tiled input are its right and upper neighbours.
+ */
+template <Regs::PixelFormat format>
+static void DecodeLine(const u8* src, const u32* offsets, std::size_t count,
+                       Regs::DisplayTransferConfig::ScalingMode scaling,
+                       Common::Vec4<u8>* colors) {
+    constexpr std::size_t bpp = format == Regs::PixelFormat::RGBA8  ? 4
+                                : format == Regs::PixelFormat::RGB8 ? 3
+                                                                    : 2;
+    switch (scaling) {
+    case Regs::DisplayTransferConfig::ScaleX:
+        for (std::size_t i = 0; i < count; ++i) {
+            const u8* src_pixel = src + offsets[i];
+            const auto pixel0 = DecodePixel<format>(src_pixel);
+            const auto pixel1 = DecodePixel<format>(src_pixel + bpp);
+            colors[i] = ((pixel0 + pixel1) / 2).template Cast<u8>();
+        }
+        break;
+    case Regs::DisplayTransferConfig::ScaleXY:
+        for (std::size_t i = 0; i < count; ++i) {
+            const u8* src_pixel = src + offsets[i];
+            const auto pixel0 = DecodePixel<format>(src_pixel);
+            const auto pixel1 = DecodePixel<format>(src_pixel + 1 * bpp);
+            const auto pixel2 = DecodePixel<format>(src_pixel + 2 * bpp);
+            const auto pixel3 = DecodePixel<format>(src_pixel + 3 * bpp);
+            colors[i] = (((pixel0 + pixel1) + (pixel2 + pixel3)) / 4).template Cast<u8>();
+        }
+        break;
+    default:
+        for (std::size_t i = 0; i < count; ++i) {
+            colors[i] = DecodePixel<format>(src + offsets[i]);
+        }
+        break;
+    }
+}
+
+template <Regs::PixelFormat format>
+static void EncodeLine(const Common::Vec4<u8>* colors, u8* dst, const u32* offsets,
+                       std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        EncodePixel<format>(colors[i], dst + offsets[i]);
+    }
+}
+
+static void DecodeLine(Regs::PixelFormat format, const u8* src, const u32* offsets,
+                       std::size_t count, Regs::DisplayTransferConfig::ScalingMode scaling,
+                       Common::Vec4<u8>* colors) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return DecodeLine<Regs::PixelFormat::RGBA8>(src, offsets, count, scaling, colors);
+    case Regs::PixelFormat::RGB8:
+        return DecodeLine<Regs::PixelFormat::RGB8>(src, offsets, count, scaling, colors);
+    case Regs::PixelFormat::RGB565:
+        return DecodeLine<Regs::PixelFormat::RGB565>(src, offsets, count, scaling, colors);
+    case Regs::PixelFormat::RGB5A1:
+        return DecodeLine<Regs::PixelFormat::RGB5A1>(src, offsets, count, scaling, colors);
     case Regs::PixelFormat::RGBA4:
-        return Common::Color::DecodeRGBA4(src_pixel);
+        return DecodeLine<Regs::PixelFormat::RGBA4>(src, offsets, count, scaling, colors);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", format);
+        std::fill_n(colors, count, Common::Vec4<u8>{0, 0, 0, 0});
+        return;
+    }
+}
 
+static void EncodeLine(Regs::PixelFormat format, const Common::Vec4<u8>* colors, u8* dst,
+                       const u32* offsets, std::size_t count) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return EncodeLine<Regs::PixelFormat::RGBA8>(colors, dst, offsets, count);
+    case Regs::PixelFormat::RGB8:
+        return EncodeLine<Regs::PixelFormat::RGB8>(colors, dst, offsets, count);
+    case Regs::PixelFormat::RGB565:
+        return EncodeLine<Regs::PixelFormat::RGB565>(colors, dst, offsets, count);
+    case Regs::PixelFormat::RGB5A1:
+        return EncodeLine<Regs::PixelFormat::RGB5A1>(colors, dst, offsets, count);
+    case Regs::PixelFormat::RGBA4:
+        return EncodeLine<Regs::PixelFormat::RGBA4>(colors, dst, offsets, count);
     default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}", static_cast<u32>(format));
+        return;
+    }
+}
+
+/**
+ * Computes the byte offsets of the pixels of line y of an image, sampling every (1 << x_shift)th
+ * pixel. Tiled images store 8 line strips of 8x8 tiles, each tile in Morton order.
+ */
+static void GetLineOffsets(u32* offsets, u32 count, u32 y, u32 x_shift, bool tiled, u32 width,
+                           u32 bytes_per_pixel) {
+    if (tiled) {
+        const u32 strip_offset = (y & ~7) * width * bytes_per_pixel;
+        const u32 line_interleave = VideoCore::MortonInterleave(0, y);
+        for (u32 x = 0; x < count; ++x) {
+            const u32 input_x = x << x_shift;
+            const u32 interleave = VideoCore::MortonInterleave(input_x, 0) + line_interleave;
+            offsets[x] = strip_offset + ((input_x & ~7) * 8 + interleave) * bytes_per_pixel;
+        }
+    } else {
+        const u32 line_offset = y * width * bytes_per_pixel;
+        for (u32 x = 0; x < count; ++x) {
+            offsets[x] = line_offset + (x << x_shift) * bytes_per_pixel;
+        }
     }
 }
 
@@ -103,26 +233,81 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
                                        config.GetEndAddress() - config.GetStartAddress());
 
+    PerformMemoryFill(config, start, end);
+}
+
+void PerformMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    // The 16 and 24-bit fills write whole values, so their last value can end past end_addr. The
+    // 32-bit fill stops at the last whole value instead.
+    std::array<u8, 4> value;
+    std::size_t value_size;
+    std::size_t fill_size;
     if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        value = {static_cast<u8>(config.value_24bit_r), static_cast<u8>(config.value_24bit_g),
+                 static_cast<u8>(config.value_24bit_b)};
+        value_size = 3;
+        fill_size = Common::AlignUp<std::size_t>(end - start, 3);
     } else if (config.fill_32bit) {
-        // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
+        const u32 value_32bit = config.value_32bit;
+        std::memcpy(value.data(), &value_32bit, sizeof(u32));
+        value_size = sizeof(u32);
+        fill_size = Common::AlignDown<std::size_t>(end - start, sizeof(u32));
     } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
+        const u16 value_16bit = config.value_16bit.Value();
+        std::memcpy(value.data(), &value_16bit, sizeof(u16));
+        value_size = sizeof(u16);
+        fill_size = Common::AlignUp<std::size_t>(end - start, sizeof(u16));
+    }
+
+    if (fill_size == 0) {
+        return;
+    }
+
+    // Write the value once, then keep doubling the filled part with block copies.
+    std::memcpy(start, value.data(), std::min(value_size, fill_size));
+    for (std::size_t filled = value_size; filled < fill_size; filled *= 2) {
+        std::memcpy(start + filled, start, std::min(filled, fill_size - filled));
+    }
+}
+
+/// Converts lines [first_line, last_line) of a software display transfer.
+static void DisplayTransferLines(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                                 u8* dst_pointer, u32 first_line, u32 last_line,
+                                 bool pixel_by_pixel) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+
+    // Linear input is written tiled and tiled input is written linear, unless dont_swizzle is set
+    const bool src_tiled = !config.input_linear;
+    const bool dst_tiled = config.input_linear != config.dont_swizzle;
+
+    std::vector<u32> src_offsets(output_width);
+    std::vector<u32> dst_offsets(output_width);
+    std::vector<Common::Vec4<u8>> colors(output_width);
+
+    for (u32 y = first_line; y < last_line; ++y) {
+        // Calculate the line of the input image based on the current output line and the scale.
+        const u32 input_y = y << vertical_scale;
+        // Flip the output line after calculating the input line to account for scaling.
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        GetLineOffsets(src_offsets.data(), output_width, input_y, horizontal_scale, src_tiled,
+                       config.input_width, src_bytes_per_pixel);
+        GetLineOffsets(dst_offsets.data(), output_width, output_y, 0, dst_tiled, output_width,
+                       dst_bytes_per_pixel);
+
+        // When the input and output overlap, each pixel must be written before the next one is
+        // read, like the hardware does.
+        const u32 span = pixel_by_pixel ? 1 : output_width;
+        for (u32 x = 0; x < output_width; x += span) {
+            DecodeLine(config.input_format, src_pointer, &src_offsets[x], span, config.scaling,
+                       &colors[x]);
+            EncodeLine(config.output_format, &colors[x], dst_pointer, &dst_offsets[x], span);
+        }
     }
 }
 
@@ -193,113 +378,61 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Common::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Common::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Common::Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Common::Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Common::Color::EncodeRGB565(src_color, dst_pixel);
-                break;
+    if (!transfer_workers &&
+        std::size_t{output_width} * output_height >= MIN_PARALLEL_TRANSFER_PIXELS) {
+        transfer_workers = std::make_unique<Common::ThreadWorker>(
+            std::max(std::thread::hardware_concurrency(), 2U) - 1, "GPU transfer");
+    }
+    PerformDisplayTransfer(config, src_pointer, dst_pointer, transfer_workers.get());
+}
 
-            case Regs::PixelFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
+void PerformDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                            u8* dst_pointer, Common::ThreadWorker* workers) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+
+    // Bounds of the bytes read and written, downscaling also reads the pixels after each sample.
+    const auto image_extent = [](bool tiled, u64 width, u64 last_x, u64 last_y, u64 bpp) {
+        return tiled ? ((last_y & ~7) * width + (last_x & ~7) * 8 + 64) * bpp
+                     : (last_y * width + last_x + 1) * bpp;
+    };
+    const u64 src_extent =
+        image_extent(!config.input_linear, config.input_width,
+                     (u64{output_width} << horizontal_scale) + horizontal_scale,
+                     (u64{output_height} << vertical_scale) + vertical_scale,
+                     GPU::Regs::BytesPerPixel(config.input_format)) +
+        3 * GPU::Regs::BytesPerPixel(config.input_format);
+    const u64 dst_extent =
+        image_extent(config.input_linear != config.dont_swizzle, output_width, output_width - 1,
+                     output_height - 1, GPU::Regs::BytesPerPixel(config.output_format));
+    const auto src_begin = reinterpret_cast<std::uintptr_t>(src_pointer);
+    const auto dst_begin = reinterpret_cast<std::uintptr_t>(dst_pointer);
+    const bool overlap = src_begin < dst_begin + dst_extent && dst_begin < src_begin + src_extent;
+
+    if (overlap) {
+        DisplayTransferLines(config, src_pointer, dst_pointer, 0, output_height, true);
+        return;
+    }
 
-            case Regs::PixelFormat::RGBA4:
-                Common::Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
+    const std::size_t num_pixels = static_cast<std::size_t>(output_width) * output_height;
+    if (!workers || num_pixels < MIN_PARALLEL_TRANSFER_PIXELS) {
+        DisplayTransferLines(config, src_pointer, dst_pointer, 0, output_height, false);
+        return;
+    }
 
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
+    const u32 num_tasks =
+        std::max<u32>(1, std::min<u32>(static_cast<u32>(workers->NumWorkers()),
+                                       output_height / MIN_LINES_PER_TASK));
+    for (u32 task = 0; task < num_tasks; ++task) {
+        const u32 first = static_cast<u32>(u64{output_height} * task / num_tasks);
+        const u32 last = static_cast<u32>(u64{output_height} * (task + 1) / num_tasks);
+        workers->QueueWork([&config, src_pointer, dst_pointer, first, last] {
+            DisplayTransferLines(config, src_pointer, dst_pointer, first, last, false);
+        });
     }
+    workers->WaitForRequests();
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -360,6 +493,18 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
                                                       : Memory::RasterizerInvalidateRegion;
     FlushInvalidate_fn(config.GetPhysicalOutputAddress(), static_cast<u32>(contiguous_output_size));
 
+    PerformTextureCopy(config, src_pointer, dst_pointer);
+}
+
+void PerformTextureCopy(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                        u8* dst_pointer) {
+    u32 remaining_size = Common::AlignDown(config.texture_copy.size, 16);
+    const u32 input_gap = config.texture_copy.input_gap * 16;
+    const u32 output_gap = config.texture_copy.output_gap * 16;
+    const u32 input_width = input_gap == 0 ? remaining_size : config.texture_copy.input_width * 16;
+    const u32 output_width =
+        output_gap == 0 ? remaining_size : config.texture_copy.output_width * 16;
+
     u32 remaining_input = input_width;
     u32 remaining_output = output_width;
     while (remaining_size > 0) {
@@ -558,6 +703,7 @@ void Init(Memory::MemorySystem& memory) {
 
 /// Shutdown hardware
 void Shutdown() {
+    transfer_workers.reset();
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
@@ -12,6 +12,7 @@
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/core_timing.h"
 
 namespace Memory {
@@ -322,6 +323,25 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Fills the memory in [start, end) with the value of a memory fill, see the implementation for
+ * details. The 16 and 24-bit fills can write past end to finish their last value.
+ */
+void PerformMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end);
+
+/**
+ * Performs a display transfer in software, see the implementation for details.
+ * @param workers threads to convert the lines on, or nullptr to convert on the caller.
+ */
+void PerformDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst,
+                            Common::ThreadWorker* workers = nullptr);
+
+/**
+ * Performs a texture copy in software, skipping the configured gaps between the lines. The
+ * caller rejects copies with a zero size or line width, which freeze real hardware.
+ */
+void PerformTextureCopy(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
@@ -5,10 +5,12 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/hle/service/y2r_u.h"
@@ -23,59 +25,96 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+/// Minimum number of strips given to a worker, smaller conversions aren't worth splitting.
+static const unsigned int MIN_STRIPS_PER_TASK = 4;
 
+/**
+ * Loads the YUV samples of the 8 pixels of a tile line, starting at pixel x of line y. The pixels
+ * of a line start at an even position, so each chroma sample covers exactly two of them.
+ */
+template <InputFormat input_format>
+static void LoadTileLine(const u8* input_Y, const u8* input_U, const u8* input_V, unsigned int x,
+                         unsigned int y, unsigned int width, std::array<s32, 8>& Y,
+                         std::array<s32, 8>& U, std::array<s32, 8>& V) {
+    const unsigned int pos = y * width + x;
+    if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
+        const u8* yuyv = input_Y + pos * 2;
+        for (unsigned int i = 0; i < 8; ++i) {
+            Y[i] = yuyv[i * 2];
+            U[i] = yuyv[(i / 2) * 4 + 1];
+            V[i] = yuyv[(i / 2) * 4 + 3];
+        }
+    } else {
+        constexpr bool is_420 = input_format == InputFormat::YUV420_Indiv8 ||
+                                input_format == InputFormat::YUV420_Indiv16;
+        const unsigned int chroma_pos = is_420 ? ((y / 2) * width + x) / 2 : pos / 2;
+        for (unsigned int i = 0; i < 8; ++i) {
+            Y[i] = input_Y[pos + i];
+            U[i] = input_U[chroma_pos + i / 2];
+            V[i] = input_V[chroma_pos + i / 2];
+        }
+    }
+}
+
+/**
+ * Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles. Each tile line
+ * is converted as a whole with no branches in between, which lets the compiler vectorize it.
+ */
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
+                            ImageTile output[], unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients) {
+    std::array<s32, 8> c;
+    std::copy(coefficients.begin(), coefficients.end(), c.begin());
+
+    std::array<s32, 8> Y, U, V;
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y = 0;
-            s32 U = 0;
-            s32 V = 0;
-            switch (input_format) {
-            case InputFormat::YUV422_Indiv8:
-            case InputFormat::YUV422_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-                break;
-            case InputFormat::YUV420_Indiv8:
-            case InputFormat::YUV420_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-                break;
-            case InputFormat::YUYV422_Interleaved:
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-                break;
+        for (unsigned int tile = 0; tile < width / 8; ++tile) {
+            LoadTileLine<input_format>(input_Y, input_U, input_V, tile * 8, y, width, Y, U, V);
+
+            u32* out = &output[tile][y * 8];
+            for (unsigned int i = 0; i < 8; ++i) {
+                // This conversion process is bit-exact with hardware, as far as could be tested.
+                s32 cY = c[0] * Y[i];
+
+                s32 r = cY + c[1] * V[i];
+                s32 g = cY - c[2] * V[i] - c[3] * U[i];
+                s32 b = cY + c[4] * U[i];
+
+                const s32 rounding_offset = 0x18;
+                r = (r >> 3) + c[5] + rounding_offset;
+                g = (g >> 3) + c[6] + rounding_offset;
+                b = (b >> 3) + c[7] + rounding_offset;
+
+                out[i] = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
+                         ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+                         ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
             }
-
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
         }
     }
 }
 
+static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                            const u8* input_V, ImageTile output[], unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    switch (input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(input_Y, input_U, input_V, output, width,
+                                                          height, coefficients);
+        break;
+    }
+}
+
 /// Simulates an incoming CDMA transfer. The N parameter is used to automatically convert 16-bit
 /// formats to 8-bit.
 template <std::size_t N>
@@ -87,8 +126,12 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     ASSERT(amount_of_data % output_unit == 0);
 
     while (amount_of_data > 0) {
-        for (std::size_t i = 0; i < output_unit; ++i) {
-            output[i] = input[i * N];
+        if constexpr (N == 1) {
+            std::memcpy(output, input, output_unit);
+        } else {
+            for (std::size_t i = 0; i < output_unit; ++i) {
+                output[i] = input[i * N];
+            }
         }
 
         output += output_unit;
@@ -100,44 +143,79 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     }
 }
 
-/// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
-/// transfer.
-static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
-                     int amount_of_data, OutputFormat output_format, u8 alpha) {
+static std::size_t BytesPerPixel(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    case OutputFormat::RGB5A1:
+    case OutputFormat::RGB565:
+        return 2;
+    }
+    UNREACHABLE();
+    return 0;
+}
 
+/// Converts intermediate RGB32 pixels to the final output format.
+template <OutputFormat output_format>
+static void EncodePixels(const u32* input, u8* output, std::size_t count, u8 alpha) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const u32 color = input[i];
+        if constexpr (output_format == OutputFormat::RGBA8) {
+            // The RGB32 layout already matches RGBA8, only the alpha byte is missing.
+            const u32_le data = color | alpha;
+            std::memcpy(output + i * 4, &data, sizeof(data));
+        } else {
+            const Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16),
+                                           (u8)(color >> 8), alpha};
+            if constexpr (output_format == OutputFormat::RGB8) {
+                Common::Color::EncodeRGB8(col_vec, output + i * 3);
+            } else if constexpr (output_format == OutputFormat::RGB5A1) {
+                Common::Color::EncodeRGB5A1(col_vec, output + i * 2);
+            } else if constexpr (output_format == OutputFormat::RGB565) {
+                Common::Color::EncodeRGB565(col_vec, output + i * 2);
+            }
+        }
+    }
+}
+
+static void EncodePixels(OutputFormat output_format, const u32* input, u8* output,
+                         std::size_t count, u8 alpha) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        EncodePixels<OutputFormat::RGBA8>(input, output, count, alpha);
+        break;
+    case OutputFormat::RGB8:
+        EncodePixels<OutputFormat::RGB8>(input, output, count, alpha);
+        break;
+    case OutputFormat::RGB5A1:
+        EncodePixels<OutputFormat::RGB5A1>(input, output, count, alpha);
+        break;
+    case OutputFormat::RGB565:
+        EncodePixels<OutputFormat::RGB565>(input, output, count, alpha);
+        break;
+    }
+}
+
+/// Simulates an outgoing CDMA transfer of pixels already converted to the output format.
+static void SendData(Memory::MemorySystem& memory, const u8* input, ConversionBuffer& buf,
+                     int amount_of_data, std::size_t bytes_per_pixel) {
     u8* output = memory.GetPointer(buf.address);
 
-    while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Common::Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Common::Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Common::Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
-            }
+    // A transfer unit always carries whole pixels, so the last one can spill into the gap.
+    const int unit_pixels = static_cast<int>((buf.transfer_unit + bytes_per_pixel - 1) /
+                                             bytes_per_pixel);
+    const std::size_t unit_size = unit_pixels * bytes_per_pixel;
 
-            amount_of_data -= 1;
-        }
+    while (amount_of_data > 0) {
+        std::memcpy(output, input, unit_size);
+        input += unit_size;
+        output += unit_size + buf.gap;
 
-        output += buf.gap;
         buf.address += buf.transfer_unit + buf.gap;
         buf.image_size -= buf.transfer_unit;
+        amount_of_data -= unit_pixels;
     }
 }
 
@@ -204,8 +282,101 @@ static void RotateTile270(const ImageTile& input, ImageTile& output, int height,
 
 static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            output[y * line_stride + x] = tile[y * 8 + x];
+        std::memcpy(&output[y * line_stride], &tile[y * 8], 8 * sizeof(u32));
+    }
+}
+
+/// Receives the YUV data of one strip into a buffer of 16 bytes per pixel column.
+static void ReceiveStrip(Memory::MemorySystem& memory, ConversionConfiguration& cvt, u8* input,
+                         std::size_t row_data_size) {
+    u8* input_Y = input;
+    u8* input_U = input_Y + 8 * cvt.input_line_width;
+    u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
+        break;
+    }
+}
+
+/// Converts one received strip to RGB32, rotated and laid out the way it is sent out.
+static void ConvertStrip(const ConversionConfiguration& cvt, const u8* input, u32* output_buffer,
+                         ImageTile tiles[], unsigned int row_height, const u8* tile_remap) {
+    const std::size_t num_tiles = cvt.input_line_width / 8;
+    const u8* input_Y = input;
+    const u8* input_U = input_Y + 8 * cvt.input_line_width;
+    const u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles, cvt.input_line_width,
+                    row_height, cvt.coefficients);
+
+    // Without rotation a linear strip is just the tile lines side by side.
+    if (cvt.rotation == Rotation::None && cvt.block_alignment == BlockAlignment::Linear) {
+        for (std::size_t i = 0; i < num_tiles; ++i) {
+            WriteTileToOutput(output_buffer + i * 8, tiles[i], row_height, cvt.input_line_width);
+        }
+        return;
+    }
+
+    ImageTile tmp_tile;
+    for (std::size_t i = 0; i < num_tiles; ++i) {
+        int image_strip_width = 0;
+        int output_stride = 0;
+
+        switch (cvt.rotation) {
+        case Rotation::None:
+            RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_90:
+            RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        case Rotation::Clockwise_180:
+            // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
+            // since the rotates are done individually on each tile.
+            RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_270:
+            RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        }
+
+        switch (cvt.block_alignment) {
+        case BlockAlignment::Linear:
+            WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+            output_buffer += output_stride;
+            break;
+        case BlockAlignment::Block8x8:
+            WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+            output_buffer += TILE_SIZE;
+            break;
         }
     }
 }
@@ -259,19 +430,35 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  *
  * Hardware behaves strangely (doesn't fire the completion interrupt, for example) in these cases,
  * so they are believed to be invalid configurations anyway.
+ *
+ * Strips are independent once received, so the whole image is received first, the strips are
+ * converted on the worker threads if given, and the results are sent out in order.
  */
-void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cvt) {
+void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cvt,
+                       Common::ThreadWorker* workers) {
     ASSERT(cvt.input_line_width % 8 == 0);
     ASSERT(cvt.block_alignment != BlockAlignment::Block8x8 || cvt.input_lines % 8 == 0);
     // Tiles per row
     std::size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
-    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
-    std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
+    const unsigned int num_strips = (cvt.input_lines + 7) / 8;
+    const auto strip_height = [&cvt](unsigned int strip) {
+        return std::min(cvt.input_lines - strip * 8, 8u);
+    };
+
+    // Received YUV data of each strip, the largest formats take 16 bytes per pixel column.
+    const std::size_t strip_input_size = cvt.input_line_width * 8 * 2;
+    std::unique_ptr<u8[]> input_buffer(new u8[num_strips * strip_input_size]);
+
+    // Converted RGB32 pixels of each strip, and the same pixels in the output format. The last
+    // transfer unit may read past the end of the image, so there is some slack after it.
+    const std::size_t strip_pixels = cvt.input_line_width * 8;
+    const std::size_t slack_pixels = cvt.dst.transfer_unit;
+    const std::size_t bytes_per_pixel = BytesPerPixel(cvt.output_format);
+    std::unique_ptr<u32[]> rgb_buffer(new u32[num_strips * strip_pixels + slack_pixels]());
+    std::unique_ptr<u8[]> output_buffer(
+        new u8[(num_strips * strip_pixels + slack_pixels) * bytes_per_pixel]);
 
     // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
     // requiring two different code paths.
@@ -285,96 +472,44 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
         break;
     }
 
-    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
-        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
-
-        // Total size in pixels of incoming data required for this strip.
-        const std::size_t row_data_size = row_height * cvt.input_line_width;
-
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    for (unsigned int strip = 0; strip < num_strips; ++strip) {
+        ReceiveStrip(memory, cvt, &input_buffer[strip * strip_input_size],
+                     strip_height(strip) * cvt.input_line_width);
+    }
 
-        switch (cvt.input_format) {
-        case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
-            break;
+    const auto convert_strips = [&](unsigned int first, unsigned int last) {
+        // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
+        std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
+        for (unsigned int strip = first; strip < last; ++strip) {
+            u32* rgb = &rgb_buffer[strip * strip_pixels];
+            ConvertStrip(cvt, &input_buffer[strip * strip_input_size], rgb, tiles.get(),
+                         strip_height(strip), tile_remap);
+            EncodePixels(cvt.output_format, rgb,
+                         &output_buffer[strip * strip_pixels * bytes_per_pixel], strip_pixels,
+                         (u8)cvt.alpha);
         }
-
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
-                        cvt.input_line_width, row_height, cvt.coefficients);
-
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
-            }
+    };
+
+    const std::size_t num_tasks =
+        workers ? std::min<std::size_t>(workers->NumWorkers(), num_strips / MIN_STRIPS_PER_TASK)
+                : 0;
+    if (num_tasks > 1) {
+        for (std::size_t task = 0; task < num_tasks; ++task) {
+            const auto first = static_cast<unsigned int>(num_strips * task / num_tasks);
+            const auto last = static_cast<unsigned int>(num_strips * (task + 1) / num_tasks);
+            workers->QueueWork([first, last, &convert_strips] { convert_strips(first, last); });
         }
+        workers->WaitForRequests();
+    } else {
+        convert_strips(0, num_strips);
+    }
+    EncodePixels(cvt.output_format, &rgb_buffer[num_strips * strip_pixels],
+                 &output_buffer[num_strips * strip_pixels * bytes_per_pixel], slack_pixels,
+                 (u8)cvt.alpha);
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+    for (unsigned int strip = 0; strip < num_strips; ++strip) {
+        SendData(memory, &output_buffer[strip * strip_pixels * bytes_per_pixel], cvt.dst,
+                 static_cast<int>(strip_height(strip) * cvt.input_line_width), bytes_per_pixel);
     }
 }
 } // namespace HW::Y2R
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/thread_worker.h"
+
 namespace Memory {
 class MemorySystem;
 }
@@ -13,5 +15,10 @@ struct ConversionConfiguration;
 } // namespace Service::Y2R
 
 namespace HW::Y2R {
-void PerformConversion(Memory::MemorySystem& memory, Service::Y2R::ConversionConfiguration& cvt);
+/**
+ * Performs a Y2R conversion, see the implementation for details.
+ * @param workers threads to convert the image strips on, or nullptr to convert on the caller.
+ */
+void PerformConversion(Memory::MemorySystem& memory, Service::Y2R::ConversionConfiguration& cvt,
+                       Common::ThreadWorker* workers = nullptr);
 } // namespace HW::Y2R
@@ -48,16 +48,16 @@ FileType GuessFromExtension(const std::string& extension_) {
     if (extension == ".elf" || extension == ".axf")
         return FileType::ELF;
 
-    if (extension == ".cci" || extension == ".3ds")
+    if (extension == ".cci" || extension == ".3ds" || extension == ".zcci" || extension == ".z3ds")
         return FileType::CCI;
 
-    if (extension == ".cxi" || extension == ".app")
+    if (extension == ".cxi" || extension == ".app" || extension == ".zcxi")
         return FileType::CXI;
 
     if (extension == ".3dsx")
         return FileType::THREEDSX;
 
-    if (extension == ".cia")
+    if (extension == ".cia" || extension == ".zcia")
         return FileType::CIA;
 
     return FileType::Unknown;
@@ -96,6 +96,7 @@ public:
     std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
 
     std::shared_ptr<PageTable> current_page_table = nullptr;
+    u64 page_table_generation = 0;
     RasterizerCacheMarker cache_marker;
     std::vector<std::shared_ptr<PageTable>> page_table_list;
 
@@ -311,6 +312,7 @@ private:
         ar& page_table_list;
         // dsp is set from Core::System at startup
         ar& current_page_table;
+        page_table_generation++;
         ar& fcram_mem;
         ar& vram_mem;
         ar& n3ds_extra_ram_mem;
@@ -363,12 +365,17 @@ SERIALIZE_IMPL(MemorySystem)
 
 void MemorySystem::SetCurrentPageTable(std::shared_ptr<PageTable> page_table) {
     impl->current_page_table = page_table;
+    impl->page_table_generation++;
 }
 
 std::shared_ptr<PageTable> MemorySystem::GetCurrentPageTable() const {
     return impl->current_page_table;
 }
 
+u64 MemorySystem::GetPageTableGeneration() const {
+    return impl->page_table_generation;
+}
+
 void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory,
                             PageType type) {
     LOG_DEBUG(HW_Memory, "Mapping {} onto {:08X}-{:08X}", (void*)memory.GetPtr(),
@@ -376,6 +383,7 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
 
     RasterizerFlushVirtualRegion(base << CITRA_PAGE_BITS, size * CITRA_PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
+    impl->page_table_generation++;
 
     u32 end = base + size;
     while (base != end) {
@@ -742,6 +750,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                     case PageType::Memory:
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> CITRA_PAGE_BITS] = nullptr;
+                        impl->page_table_generation++;
                         break;
                     default:
                         UNREACHABLE();
@@ -757,6 +766,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::Memory;
                         page_table->pointers[vaddr >> CITRA_PAGE_BITS] =
                             GetPointerForRasterizerCache(vaddr & ~CITRA_PAGE_MASK);
+                        impl->page_table_generation++;
                         break;
                     }
                     default:
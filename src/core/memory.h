@@ -315,6 +315,12 @@ public:
     void SetCurrentPageTable(std::shared_ptr<PageTable> page_table);
     std::shared_ptr<PageTable> GetCurrentPageTable() const;
 
+    /**
+     * Gets a counter that changes whenever a page table entry is remapped or another page table
+     * becomes current. Host pointers taken from the page table stay valid while it is unchanged.
+     */
+    u64 GetPageTableGeneration() const;
+
     /**
      * Gets a pointer to the given address.
      *
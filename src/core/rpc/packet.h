@@ -14,6 +14,15 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ProfilerControl,
+    ProfilerDump,
+};
+
+/// Commands accepted by a ProfilerControl packet.
+enum class ProfilerCommand : u32 {
+    Disable = 0,
+    Enable = 1,
+    Reset = 2,
 };
 
 struct PacketHeader {
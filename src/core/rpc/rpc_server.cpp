@@ -1,6 +1,8 @@
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/hle/call_profiler.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
 #include "core/rpc/packet.h"
@@ -54,6 +56,36 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u
     packet.SendReply();
 }
 
+void RPCServer::HandleProfilerControl(Packet& packet, ProfilerCommand command) {
+    switch (command) {
+    case ProfilerCommand::Disable:
+        HLE::CallProfiler::SetEnabled(false);
+        break;
+    case ProfilerCommand::Enable:
+        HLE::CallProfiler::SetEnabled(true);
+        break;
+    case ProfilerCommand::Reset:
+        HLE::CallProfiler::Reset();
+        break;
+    }
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::HandleProfilerDump(Packet& packet) {
+    // The statistics do not fit in a reply packet, so they are written next to the log file and
+    // the reply only carries the number of bytes written.
+    const std::string path =
+        FileUtil::GetUserPath(FileUtil::UserPath::LogDir) + "hle_profile.json";
+    const u32 written =
+        static_cast<u32>(FileUtil::WriteStringToFile(true, path, HLE::CallProfiler::ExportJson()));
+    LOG_INFO(RPC_Server, "Wrote {} bytes of HLE call statistics to {}", written, path);
+
+    std::memcpy(packet.GetPacketData().data(), &written, sizeof(written));
+    packet.SetPacketDataSize(sizeof(written));
+    packet.SendReply();
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
@@ -63,6 +95,13 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
                 return true;
             }
             break;
+        case PacketType::ProfilerControl:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
+        case PacketType::ProfilerDump:
+            return true;
         default:
             break;
         }
@@ -74,7 +113,7 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        // Memory requests use the address/data_size wire format, profiler requests ignore it
         u32 address = 0;
         u32 data_size = 0;
         std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
@@ -95,6 +134,19 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ProfilerControl: {
+            u32 command = 0;
+            std::memcpy(&command, request_packet->GetPacketData().data(), sizeof(command));
+            if (command <= static_cast<u32>(ProfilerCommand::Reset)) {
+                HandleProfilerControl(*request_packet, static_cast<ProfilerCommand>(command));
+                success = true;
+            }
+            break;
+        }
+        case PacketType::ProfilerDump:
+            HandleProfilerDump(*request_packet);
+            success = true;
+            break;
         default:
             break;
         }
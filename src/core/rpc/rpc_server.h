@@ -15,6 +15,7 @@ namespace RPC {
 
 class Packet;
 struct PacketHeader;
+enum class ProfilerCommand : u32;
 
 class RPCServer {
 public:
@@ -28,6 +29,8 @@ private:
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleProfilerControl(Packet& packet, ProfilerCommand command);
+    void HandleProfilerDump(Packet& packet);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
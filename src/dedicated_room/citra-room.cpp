@@ -58,6 +58,9 @@ static void PrintHelp(const char* argv0) {
                  "--ban-list-file     The file for storing the room ban list\n"
                  "--log-file          The file for storing the room log\n"
                  "--enable-citra-mods Allow Citra Community Moderators to moderate on your room\n"
+                 "--allow-direct-connections Let members that enable direct connections exchange\n"
+                 "                    wifi frames without the room. Shares their IP addresses\n"
+                 "                    with each other. Off by default.\n"
                  "-h, --help          Display this help and exit\n"
                  "-v, --version       Output version information and exit\n";
 }
@@ -181,6 +184,7 @@ int main(int argc, char** argv) {
     u32 port = Network::DefaultRoomPort;
     u32 max_members = 16;
     bool enable_citra_mods = false;
+    bool allow_direct_connections = false;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
@@ -196,6 +200,7 @@ int main(int argc, char** argv) {
         {"ban-list-file", required_argument, 0, 'b'},
         {"log-file", required_argument, 0, 'l'},
         {"enable-citra-mods", no_argument, 0, 'e'},
+        {"allow-direct-connections", no_argument, 0, 'c'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -244,6 +249,9 @@ int main(int argc, char** argv) {
             case 'e':
                 enable_citra_mods = true;
                 break;
+            case 'c':
+                allow_direct_connections = true;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -337,7 +345,7 @@ int main(int argc, char** argv) {
     if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
         if (!room->Create(room_name, room_description, "", port, password, max_members, username,
                           preferred_game, preferred_game_id, std::move(verify_backend), ban_list,
-                          enable_citra_mods)) {
+                          enable_citra_mods, allow_direct_connections)) {
             std::cout << "Failed to create room: \n\n";
             return -1;
         }
@@ -9,6 +9,7 @@
 #endif
 #include <cstring>
 #include <string>
+#include "common/assert.h"
 #include "network/packet.h"
 
 namespace Network {
@@ -25,7 +26,19 @@ u64 ntohll(u64 x) {
 }
 #endif
 
+Packet Packet::View(const void* data, std::size_t size_in_bytes) {
+    Packet packet;
+    packet.view_data = static_cast<const char*>(data);
+    packet.view_size = size_in_bytes;
+    return packet;
+}
+
+void Packet::Reserve(std::size_t size_in_bytes) {
+    data.reserve(size_in_bytes);
+}
+
 void Packet::Append(const void* in_data, std::size_t size_in_bytes) {
+    ASSERT_MSG(view_data == nullptr, "Cannot append to a packet view");
     if (in_data && (size_in_bytes > 0)) {
         std::size_t start = data.size();
         data.resize(start + size_in_bytes);
@@ -35,7 +48,7 @@ void Packet::Append(const void* in_data, std::size_t size_in_bytes) {
 
 void Packet::Read(void* out_data, std::size_t size_in_bytes) {
     if (out_data && CheckSize(size_in_bytes)) {
-        std::memcpy(out_data, &data[read_pos], size_in_bytes);
+        std::memcpy(out_data, ReadBuffer() + read_pos, size_in_bytes);
         read_pos += size_in_bytes;
     }
 }
@@ -44,9 +57,14 @@ void Packet::Clear() {
     data.clear();
     read_pos = 0;
     is_valid = true;
+    view_data = nullptr;
+    view_size = 0;
 }
 
 const void* Packet::GetData() const {
+    if (view_data) {
+        return view_data;
+    }
     return !data.empty() ? &data[0] : nullptr;
 }
 
@@ -55,11 +73,11 @@ void Packet::IgnoreBytes(u32 length) {
 }
 
 std::size_t Packet::GetDataSize() const {
-    return data.size();
+    return view_data ? view_size : data.size();
 }
 
 bool Packet::EndOfPacket() const {
-    return read_pos >= data.size();
+    return read_pos >= GetDataSize();
 }
 
 Packet::operator bool() const {
@@ -143,7 +161,7 @@ Packet& Packet::operator>>(char* out_data) {
 
     if ((length > 0) && CheckSize(length)) {
         // Then extract characters
-        std::memcpy(out_data, &data[read_pos], length);
+        std::memcpy(out_data, ReadBuffer() + read_pos, length);
         out_data[length] = '\0';
 
         // Update reading position
@@ -161,7 +179,7 @@ Packet& Packet::operator>>(std::string& out_data) {
     out_data.clear();
     if ((length > 0) && CheckSize(length)) {
         // Then extract characters
-        out_data.assign(&data[read_pos], length);
+        out_data.assign(ReadBuffer() + read_pos, length);
 
         // Update reading position
         read_pos += length;
@@ -255,9 +273,13 @@ Packet& Packet::operator<<(const std::string& in_data) {
 }
 
 bool Packet::CheckSize(std::size_t size) {
-    is_valid = is_valid && (read_pos + size <= data.size());
+    is_valid = is_valid && (read_pos + size <= GetDataSize());
 
     return is_valid;
 }
 
+const char* Packet::ReadBuffer() const {
+    return view_data ? view_data : data.data();
+}
+
 } // namespace Network
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 #include <vector>
 #include "common/common_types.h"
 
@@ -16,6 +17,22 @@ public:
     Packet() = default;
     ~Packet() = default;
 
+    /**
+     * Creates a packet that reads directly from existing memory instead of copying it, e.g. the
+     * payload of a received ENetPacket. The memory must outlive the packet and nothing may be
+     * appended to it.
+     * @param data          Pointer to the bytes to read from
+     * @param size_in_bytes Number of bytes available at `data`
+     */
+    static Packet View(const void* data, std::size_t size_in_bytes);
+
+    /**
+     * Reserves space for at least `size_in_bytes` bytes so that appending up to that size does not
+     * reallocate
+     * @param size_in_bytes Expected total size of the packet
+     */
+    void Reserve(std::size_t size_in_bytes);
+
     /**
      * Append data to the end of the packet
      * @param data        Pointer to the sequence of bytes to append
@@ -103,6 +120,11 @@ public:
     Packet& operator<<(const std::array<T, S>& data);
 
 private:
+    /// Byte-sized element types need no byte swapping and can be copied in and out in bulk
+    template <typename T>
+    static constexpr bool is_raw_byte =
+        sizeof(T) == 1 && std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>;
+
     /**
      * Check if the packet can extract a given number of bytes
      * This function updates accordingly the state of the packet.
@@ -111,10 +133,16 @@ private:
      */
     bool CheckSize(std::size_t size);
 
+    /// Returns the bytes being read, which are either owned or a view
+    const char* ReadBuffer() const;
+
     // Member data
     std::vector<char> data;   ///< Data stored in the packet
     std::size_t read_pos = 0; ///< Current reading position in the packet
     bool is_valid = true;     ///< Reading state of the packet
+
+    const char* view_data = nullptr; ///< External data read by a view packet, else nullptr
+    std::size_t view_size = 0;       ///< Size of view_data, in bytes
 };
 
 template <typename T>
@@ -122,6 +150,18 @@ Packet& Packet::operator>>(std::vector<T>& out_data) {
     // First extract the size
     u32 size = 0;
     *this >> size;
+
+    // Byte-sized elements need no byte swapping, so they can be read in one go
+    if constexpr (is_raw_byte<T>) {
+        if (!CheckSize(size)) {
+            out_data.clear();
+            return *this;
+        }
+        out_data.resize(size);
+        Read(out_data.data(), size);
+        return *this;
+    }
+
     out_data.resize(size);
 
     // Then extract the data
@@ -135,6 +175,11 @@ Packet& Packet::operator>>(std::vector<T>& out_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator>>(std::array<T, S>& out_data) {
+    if constexpr (is_raw_byte<T>) {
+        Read(out_data.data(), S);
+        return *this;
+    }
+
     for (std::size_t i = 0; i < out_data.size(); ++i) {
         T character;
         *this >> character;
@@ -148,6 +193,11 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
     // First insert the size
     *this << static_cast<u32>(in_data.size());
 
+    if constexpr (is_raw_byte<T>) {
+        Append(in_data.data(), in_data.size());
+        return *this;
+    }
+
     // Then insert the data
     for (std::size_t i = 0; i < in_data.size(); ++i) {
         *this << in_data[i];
@@ -157,6 +207,11 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator<<(const std::array<T, S>& in_data) {
+    if constexpr (is_raw_byte<T>) {
+        Append(in_data.data(), S);
+        return *this;
+    }
+
     for (std::size_t i = 0; i < in_data.size(); ++i) {
         *this << in_data[i];
     }
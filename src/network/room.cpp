@@ -10,10 +10,13 @@
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
+#include "network/room_member.h"
 #include "network/verify_user.h"
 
 namespace Network {
@@ -34,6 +37,9 @@ public:
 
     std::string password; ///< The password required to connect to this room.
 
+    /// Whether members may learn each other's addresses to exchange wifi frames directly.
+    bool allow_direct_connections = false;
+
     struct Member {
         std::string nickname;        ///< The nickname of the member.
         std::string console_id_hash; ///< A hash of the console ID of the member.
@@ -42,12 +48,26 @@ public:
         /// Data of the user, often including authenticated forum username.
         VerifyUser::UserData user_data;
         ENetPeer* peer; ///< The remote peer.
+        /// Whether the member exchanges wifi frames directly with other members that want to.
+        bool direct_connections = false;
     };
     using MemberList = std::vector<Member>;
     MemberList members;              ///< Information about the members of this room
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
+    struct MacAddressHash {
+        std::size_t operator()(const MacAddress& address) const noexcept {
+            return static_cast<std::size_t>(Common::ComputeHash64(address.data(), address.size()));
+        }
+    };
+
+    /// Indices into `members`, keyed by the fields packets look members up by. These are rebuilt
+    /// whenever the member list changes and are guarded by member_mutex.
+    std::unordered_map<MacAddress, std::size_t, MacAddressHash> member_index_by_mac;
+    std::unordered_map<std::string, std::size_t> member_index_by_nickname;
+    std::unordered_map<const ENetPeer*, std::size_t> member_index_by_peer;
+
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
     mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
@@ -65,6 +85,32 @@ public:
     void ServerLoop();
     void StartLoop();
 
+    /// Handles a single ENet event received by the server loop.
+    void HandleEvent(ENetEvent& event);
+
+    /**
+     * Adds a member to the room and indexes it. member_mutex must be held.
+     */
+    void AddMember(Member&& member);
+
+    /**
+     * Removes a member from the room and reindexes the rest. member_mutex must be held.
+     */
+    void RemoveMember(MemberList::iterator member);
+
+    /**
+     * Rebuilds the MAC address, nickname and peer lookup indices. member_mutex must be held.
+     */
+    void RebuildMemberIndices();
+
+    /**
+     * Finds a member by one of its indexed fields, returning members.end() if there is none.
+     * member_mutex must be held.
+     */
+    MemberList::iterator FindMemberByPeer(const ENetPeer* peer);
+    MemberList::iterator FindMemberByMacAddress(const MacAddress& mac_address);
+    MemberList::iterator FindMemberByNickname(const std::string& nickname);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -72,6 +118,12 @@ public:
      */
     void HandleJoinRequest(const ENetEvent* event);
 
+    /**
+     * Marks the sending member as wanting direct connections and tells all such members about
+     * each other.
+     */
+    void HandleDirectConnectRequest(const ENetEvent* event);
+
     /**
      * Parses and answers a kick request from a client.
      * Validates the permissions and that the given user exists and then kicks the member.
@@ -187,6 +239,19 @@ public:
      */
     void SendModBanListResponse(ENetPeer* client);
 
+    /**
+     * Sends the addresses of all members that want direct connections to each of them, so that
+     * they can exchange wifi frames without the room relaying them. member_mutex must be held.
+     * The packet has the structure:
+     * <MessageID>IdDirectPeerInformation
+     * <u32> num_peers
+     * This is followed by the following three values for each peer:
+     * <MacAddress> mac_address of that member
+     * <u32> host: the IPv4 address the room sees for that member, in network byte order
+     * <u16> port: the port the room sees for that member
+     */
+    void SendDirectPeerInformation();
+
     /**
      * Notifies the members that the room is closed,
      */
@@ -252,54 +317,114 @@ void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
         if (enet_host_service(server, &event, 16) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+            // Handle everything that has already arrived before sending anything, so that replies
+            // and broadcasts queued by all of these events go out in a single flush.
+            do {
+                HandleEvent(event);
+            } while (enet_host_check_events(server, &event) > 0);
+            enet_host_flush(server);
         }
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::HandleEvent(ENetEvent& event) {
+    switch (event.type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event.packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(&event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(&event);
+            break;
+        case IdWifiPacket:
+            HandleWifiPacket(&event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(&event);
+            break;
+        case IdDirectConnectRequest:
+            HandleDirectConnectRequest(&event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(&event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(&event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(&event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(&event);
+            break;
+        }
+        enet_packet_destroy(event.packet);
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event.peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
 
+void Room::RoomImpl::AddMember(Member&& member) {
+    const std::size_t index = members.size();
+    member_index_by_mac.emplace(member.mac_address, index);
+    member_index_by_nickname.emplace(member.nickname, index);
+    member_index_by_peer.emplace(member.peer, index);
+    members.push_back(std::move(member));
+}
+
+void Room::RoomImpl::RemoveMember(MemberList::iterator member) {
+    // Members leave rarely compared to how often they are looked up, so keep the list in join
+    // order and simply reindex it.
+    const bool direct_connections = member->direct_connections;
+    members.erase(member);
+    RebuildMemberIndices();
+
+    if (direct_connections) {
+        SendDirectPeerInformation();
+    }
+}
+
+void Room::RoomImpl::RebuildMemberIndices() {
+    member_index_by_mac.clear();
+    member_index_by_nickname.clear();
+    member_index_by_peer.clear();
+    for (std::size_t index = 0; index < members.size(); ++index) {
+        member_index_by_mac.emplace(members[index].mac_address, index);
+        member_index_by_nickname.emplace(members[index].nickname, index);
+        member_index_by_peer.emplace(members[index].peer, index);
+    }
+}
+
+Room::RoomImpl::MemberList::iterator Room::RoomImpl::FindMemberByPeer(const ENetPeer* peer) {
+    const auto it = member_index_by_peer.find(peer);
+    return it == member_index_by_peer.end() ? members.end() : members.begin() + it->second;
+}
+
+Room::RoomImpl::MemberList::iterator Room::RoomImpl::FindMemberByMacAddress(
+    const MacAddress& mac_address) {
+    const auto it = member_index_by_mac.find(mac_address);
+    return it == member_index_by_mac.end() ? members.end() : members.begin() + it->second;
+}
+
+Room::RoomImpl::MemberList::iterator Room::RoomImpl::FindMemberByNickname(
+    const std::string& nickname) {
+    const auto it = member_index_by_nickname.find(nickname);
+    return it == member_index_by_nickname.end() ? members.end() : members.begin() + it->second;
+}
+
 void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     {
         std::lock_guard lock(member_mutex);
@@ -308,8 +433,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
             return;
         }
     }
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     std::string nickname;
     packet >> nickname;
@@ -403,7 +527,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
-        members.push_back(std::move(member));
+        AddMember(std::move(member));
     }
 
     // Notify everyone that the room information has changed.
@@ -415,14 +539,26 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     }
 }
 
+void Room::RoomImpl::HandleDirectConnectRequest(const ENetEvent* event) {
+    std::lock_guard lock(member_mutex);
+    if (!allow_direct_connections) {
+        return;
+    }
+    const auto member = FindMemberByPeer(event->peer);
+    if (member == members.end() || member->direct_connections) {
+        return;
+    }
+    member->direct_connections = true;
+    SendDirectPeerInformation();
+}
+
 void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
     if (!HasModPermission(event->peer)) {
         SendModPermissionDenied(event->peer);
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string nickname;
@@ -431,9 +567,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
     std::string username, ip;
     {
         std::lock_guard lock(member_mutex);
-        const auto target_member =
-            std::find_if(members.begin(), members.end(),
-                         [&nickname](const auto& member) { return member.nickname == nickname; });
+        const auto target_member = FindMemberByNickname(nickname);
         if (target_member == members.end()) {
             SendModNoSuchUser(event->peer);
             return;
@@ -449,7 +583,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        RemoveMember(target_member);
     }
 
     // Announce the change to all clients.
@@ -463,8 +597,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string nickname;
@@ -473,9 +606,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
     std::string username, ip;
     {
         std::lock_guard lock(member_mutex);
-        const auto target_member =
-            std::find_if(members.begin(), members.end(),
-                         [&nickname](const auto& member) { return member.nickname == nickname; });
+        const auto target_member = FindMemberByNickname(nickname);
         if (target_member == members.end()) {
             SendModNoSuchUser(event->peer);
             return;
@@ -492,7 +623,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        RemoveMember(target_member);
     }
 
     {
@@ -524,8 +655,7 @@ void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string address;
@@ -572,15 +702,13 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
         return false;
 
     std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&nickname](const auto& member) { return member.nickname != nickname; });
+    return member_index_by_nickname.count(nickname) == 0;
 }
 
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
     std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    return member_index_by_mac.count(address) == 0;
 }
 
 bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const {
@@ -593,12 +721,11 @@ bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const
 
 bool Room::RoomImpl::HasModPermission(const ENetPeer* client) const {
     std::lock_guard lock(member_mutex);
-    const auto sending_member =
-        std::find_if(members.begin(), members.end(),
-                     [client](const auto& member) { return member.peer == client; });
-    if (sending_member == members.end()) {
+    const auto index = member_index_by_peer.find(client);
+    if (index == member_index_by_peer.end()) {
         return false;
     }
+    const auto sending_member = members.begin() + index->second;
     if (room_information.enable_citra_mods &&
         sending_member->user_data.moderator) { // Community moderator
 
@@ -619,7 +746,6 @@ void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
@@ -629,7 +755,6 @@ void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendConsoleIdCollision(ENetPeer* client) {
@@ -639,7 +764,6 @@ void Room::RoomImpl::SendConsoleIdCollision(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
@@ -649,7 +773,6 @@ void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendRoomIsFull(ENetPeer* client) {
@@ -659,7 +782,6 @@ void Room::RoomImpl::SendRoomIsFull(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
@@ -670,7 +792,6 @@ void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
@@ -680,7 +801,6 @@ void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address) {
@@ -690,7 +810,6 @@ void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_addre
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendUserKicked(ENetPeer* client) {
@@ -700,7 +819,6 @@ void Room::RoomImpl::SendUserKicked(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendUserBanned(ENetPeer* client) {
@@ -710,7 +828,6 @@ void Room::RoomImpl::SendUserBanned(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModPermissionDenied(ENetPeer* client) {
@@ -720,7 +837,6 @@ void Room::RoomImpl::SendModPermissionDenied(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModNoSuchUser(ENetPeer* client) {
@@ -730,7 +846,6 @@ void Room::RoomImpl::SendModNoSuchUser(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
@@ -745,7 +860,33 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
+}
+
+void Room::RoomImpl::SendDirectPeerInformation() {
+    Packet packet;
+    packet << static_cast<u8>(IdDirectPeerInformation);
+    const auto num_peers = static_cast<u32>(
+        std::count_if(members.begin(), members.end(),
+                      [](const Member& member) { return member.direct_connections; }));
+    packet << num_peers;
+    for (const auto& member : members) {
+        if (member.direct_connections) {
+            packet << member.mac_address;
+            packet << member.peer->address.host;
+            packet << member.peer->address.port;
+        }
+    }
+
+    if (num_peers == 0) {
+        return;
+    }
+    ENetPacket* enet_packet =
+        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    for (const auto& member : members) {
+        if (member.direct_connections) {
+            enet_peer_send(member.peer, 0, enet_packet);
+        }
+    }
 }
 
 void Room::RoomImpl::SendCloseMessage() {
@@ -780,7 +921,6 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
             enet_peer_send(member.peer, 0, enet_packet);
         }
     }
-    enet_host_flush(server);
 
     const std::string display_name =
         username.empty() ? nickname : fmt::format("{} ({})", nickname, username);
@@ -814,9 +954,9 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     packet << room_information.preferred_game;
     packet << room_information.host_username;
 
-    packet << static_cast<u32>(members.size());
     {
         std::lock_guard lock(member_mutex);
+        packet << static_cast<u32>(members.size());
         for (const auto& member : members) {
             packet << member.nickname;
             packet << member.mac_address;
@@ -831,7 +971,6 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_host_broadcast(server, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 MacAddress Room::RoomImpl::GenerateMacAddress() {
@@ -847,19 +986,22 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
+    Packet in_packet = Packet::View(event->packet->data, event->packet->dataLength);
+    in_packet.IgnoreBytes(sizeof(u8)); // Message type
+    u8 packet_type;
+    in_packet >> packet_type;
     in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
     in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
     MacAddress destination_address;
     in_packet >> destination_address;
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // Beacons are periodic and lossy on real hardware as well, so they don't need to be resent or
+    // ordered. Everything else drives the UDS connection state and stays reliable.
+    const bool is_beacon =
+        static_cast<WifiPacket::PacketType>(packet_type) == WifiPacket::PacketType::Beacon;
+    const enet_uint32 flags = is_beacon ? ENET_PACKET_FLAG_UNSEQUENCED : ENET_PACKET_FLAG_RELIABLE;
+    ENetPacket* enet_packet =
+        enet_packet_create(event->packet->data, event->packet->dataLength, flags);
 
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
         std::lock_guard lock(member_mutex);
@@ -876,10 +1018,7 @@ void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
         }
     } else { // Send the data only to the destination client
         std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
+        const auto member = FindMemberByMacAddress(destination_address);
         if (member != members.end()) {
             enet_peer_send(member->peer, 0, enet_packet);
         } else {
@@ -891,22 +1030,16 @@ void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
             enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
+    Packet in_packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     std::string message;
     in_packet >> message;
-    auto CompareNetworkAddress = [event](const Member member) -> bool {
-        return member.peer == event->peer;
-    };
-
     std::lock_guard lock(member_mutex);
-    const auto sending_member = std::find_if(members.begin(), members.end(), CompareNetworkAddress);
+    const auto sending_member = FindMemberByPeer(event->peer);
     if (sending_member == members.end()) {
         return; // Received a chat message from a unknown sender
     }
@@ -934,8 +1067,6 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
         enet_packet_destroy(enet_packet);
     }
 
-    enet_host_flush(server);
-
     if (sending_member->user_data.username.empty()) {
         LOG_INFO(Network, "{}: {}", sending_member->nickname, message);
     } else {
@@ -945,8 +1076,7 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
 }
 
 void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
+    Packet in_packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     GameInfo game_info;
@@ -955,10 +1085,7 @@ void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
-        auto member =
-            std::find_if(members.begin(), members.end(), [event](const Member& member) -> bool {
-                return member.peer == event->peer;
-            });
+        const auto member = FindMemberByPeer(event->peer);
         if (member != members.end()) {
             member->game_info = game_info;
 
@@ -982,9 +1109,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     std::string nickname, username, ip;
     {
         std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(), [client](const Member& member) {
-            return member.peer == client;
-        });
+        const auto member = FindMemberByPeer(client);
         if (member != members.end()) {
             nickname = member->nickname;
             username = member->user_data.username;
@@ -993,7 +1118,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
-            members.erase(member);
+            RemoveMember(member);
         }
     }
 
@@ -1014,7 +1139,8 @@ bool Room::Create(const std::string& name, const std::string& description,
                   const u32 max_connections, const std::string& host_username,
                   const std::string& preferred_game, u64 preferred_game_id,
                   std::unique_ptr<VerifyUser::Backend> verify_backend,
-                  const Room::BanList& ban_list, bool enable_citra_mods) {
+                  const Room::BanList& ban_list, bool enable_citra_mods,
+                  bool allow_direct_connections) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     if (!server_address.empty()) {
@@ -1039,6 +1165,7 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->room_information.host_username = host_username;
     room_impl->room_information.enable_citra_mods = enable_citra_mods;
     room_impl->password = password;
+    room_impl->allow_direct_connections = allow_direct_connections;
     room_impl->verify_backend = std::move(verify_backend);
     room_impl->username_ban_list = ban_list.first;
     room_impl->ip_ban_list = ban_list.second;
@@ -1103,6 +1230,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->RebuildMemberIndices();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
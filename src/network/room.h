@@ -76,6 +76,9 @@ enum RoomMessageTypes : u8 {
     IdModPermissionDenied,
     IdModNoSuchUser,
     IdJoinSuccessAsMod,
+    // Direct connections between members
+    IdDirectConnectRequest,
+    IdDirectPeerInformation,
 };
 
 /// Types of system status messages
@@ -140,6 +143,9 @@ public:
     /**
      * Creates the socket for this room. Will bind to default address if
      * server is empty string.
+     * @param allow_direct_connections Whether members that enable direct connections are told
+     * each other's IP address and port, so that they can exchange wifi frames without the room.
+     * Off by default, as it shares the addresses of those members with each other.
      */
     bool Create(const std::string& name, const std::string& description = "",
                 const std::string& server = "", u16 server_port = DefaultRoomPort,
@@ -148,7 +154,8 @@ public:
                 const std::string& host_username = "", const std::string& preferred_game = "",
                 u64 preferred_game_id = 0,
                 std::unique_ptr<VerifyUser::Backend> verify_backend = nullptr,
-                const BanList& ban_list = {}, bool enable_citra_mods = false);
+                const BanList& ban_list = {}, bool enable_citra_mods = false,
+                bool allow_direct_connections = false);
 
     /**
      * Sets the verification GUID of the room.
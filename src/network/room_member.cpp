@@ -4,12 +4,15 @@
 
 #include <algorithm>
 #include <atomic>
-#include <list>
+#include <cstring>
 #include <mutex>
 #include <set>
 #include <thread>
 #include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
 #include "enet/enet.h"
+#include "network/network_settings.h"
 #include "network/packet.h"
 #include "network/room_member.h"
 
@@ -17,6 +20,24 @@ namespace Network {
 
 constexpr u32 ConnectionTimeoutMs = 5000;
 
+/// Offset of the transmitter MAC address in a serialized wifi packet: message id, frame type and
+/// channel come before it.
+constexpr std::size_t WifiPacketTransmitterOffset = 3 * sizeof(u8);
+
+/// Offset of the destination MAC address in a serialized wifi packet, right after the transmitter
+constexpr std::size_t WifiPacketDestinationOffset =
+    WifiPacketTransmitterOffset + sizeof(MacAddress);
+
+/// Wifi packets kept per direct connection that arrives before the room tells us about its member
+constexpr std::size_t MaxUnknownDirectPeerPackets = 64;
+
+/// Size of the pooled payload buffers wifi packets are built in. Fits the largest 802.11 frame
+/// plus the packet header, larger packets get their own allocation.
+constexpr std::size_t WifiSendBufferSize = 4096;
+
+/// Released payload buffers kept for reuse, any beyond this are freed
+constexpr std::size_t MaxFreeWifiSendBuffers = 64;
+
 class RoomMember::RoomMemberImpl {
 public:
     ENetHost* client = nullptr; ///< ENet network interface.
@@ -42,11 +63,47 @@ public:
 
     MacAddress mac_address; ///< The mac_address of this member.
 
-    std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
+    mutable std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> loop_thread;
-    std::mutex send_list_mutex;  ///< Mutex that controls access to the `send_list` variable.
-    std::list<Packet> send_list; ///< A list that stores all packets to send the async
+    std::mutex send_list_mutex; ///< Mutex that controls access to the `send_list` variable.
+    /// Packets to send asynchronously, already in ENet-owned memory.
+    std::vector<ENetPacket*> send_list;
+    /// Packets taken from send_list by the loop thread. Kept around so that its capacity is reused
+    /// instead of being reallocated on every iteration.
+    std::vector<ENetPacket*> pending_send_list;
+
+    /// Payload buffers of wifi packets ENet is done with, reused for the next ones instead of
+    /// allocating a buffer per frame. ENet releases them on the loop thread while the emulation
+    /// thread takes them, so they are guarded by wifi_send_buffer_mutex.
+    std::vector<std::unique_ptr<u8[]>> free_wifi_send_buffers;
+    std::mutex wifi_send_buffer_mutex;
+
+    /// Whether to exchange wifi frames directly with other members instead of through the room.
+    bool direct_connections_enabled = false;
+
+    /// A member that the room told us accepts direct connections.
+    struct DirectPeer {
+        MacAddress mac_address; ///< The MAC address of the member.
+        ENetAddress address;    ///< The address the room sees for the member.
+        ENetPeer* peer;         ///< Our connection to the member, or nullptr if there is none.
+        /// Connection attempt of the member with the higher MAC address, which only opens its NAT
+        /// for the connection the other member makes, or nullptr if there is none.
+        ENetPeer* probe;
+        bool connected;         ///< Whether the connection to the member is established.
+        u64 frames_sent;        ///< Wifi frames sent to the member over the connection.
+        u64 frames_received;    ///< Wifi frames received from the member over the connection.
+    };
+    /// Members we may exchange wifi frames with directly. Guarded by network_mutex.
+    std::vector<DirectPeer> direct_peers;
+    /// An incoming connection from a member the room has not told us about yet, which happens
+    /// when the peer information reaches that member first.
+    struct UnknownDirectPeer {
+        ENetPeer* peer;                    ///< The connection to the member.
+        std::vector<ENetPacket*> packets; ///< Wifi packets received before the member was known.
+    };
+    /// Connections waiting for the next peer information. Guarded by network_mutex.
+    std::vector<UnknownDirectPeer> unknown_direct_peers;
 
     template <typename T>
     using CallbackSet = std::set<CallbackHandle<T>>;
@@ -68,6 +125,8 @@ public:
     };
     Callbacks callbacks; ///< All CallbackSets to all events
 
+    ~RoomMemberImpl();
+
     void MemberLoop();
 
     void StartLoop();
@@ -78,6 +137,30 @@ public:
      */
     void Send(Packet&& packet);
 
+    /**
+     * Queues a packet that has already been built in ENet memory. Ownership is transferred.
+     * @param enet_packet The packet to send
+     */
+    void Send(ENetPacket* enet_packet);
+
+    /**
+     * Destroys any packets that were queued but not sent.
+     */
+    void DiscardPendingSends();
+
+    /**
+     * Creates a reliable packet for a wifi frame, with its payload in a pooled buffer when it fits.
+     * @param size The size of the serialized wifi packet
+     * @return The packet, to be filled in and queued with Send
+     */
+    ENetPacket* CreateWifiPacket(std::size_t size);
+
+    /**
+     * Returns the payload of a packet created by CreateWifiPacket to the pool. Called by ENet
+     * when it destroys the packet.
+     */
+    static void ENET_CALLBACK ReleaseWifiPacket(ENetPacket* enet_packet);
+
     /**
      * Sends a request to the server, asking for permission to join a room with the specified
      * nickname and preferred mac.
@@ -114,6 +197,64 @@ public:
      */
     void HandleChatPacket(const ENetEvent* event);
 
+    /**
+     * Updates the direct peers from the list the room sent, dropping members that left and
+     * connecting to new ones. Only the member with the lower MAC address initiates a connection,
+     * so that two members never connect to each other twice.
+     * @param event The ENet event that was received.
+     */
+    void HandleDirectPeerInformationPacket(const ENetEvent* event);
+
+    /**
+     * Accepts a connection from (or completes one to) a direct peer. Connections from addresses
+     * the room did not tell us about yet are kept until the next peer information arrives.
+     * @param peer The peer that connected.
+     */
+    void HandleDirectConnect(ENetPeer* peer);
+
+    /**
+     * Marks a direct peer as disconnected, so that wifi frames to it fall back to the room.
+     * @param peer The peer that disconnected.
+     */
+    void HandleDirectDisconnect(ENetPeer* peer);
+
+    /**
+     * Sends a wifi packet directly to its destination when possible. Broadcasts only go direct
+     * when every other member in the room is directly connected, as the room would otherwise have
+     * to relay them anyway.
+     * @param enet_packet The serialized wifi packet
+     * @returns true if ENet took the packet, false if it should be relayed by the room
+     */
+    bool SendWifiPacketDirect(ENetPacket* enet_packet);
+
+    /**
+     * @returns The direct peer with the given connection, or direct_peers.end()
+     */
+    std::vector<DirectPeer>::iterator FindDirectPeer(const ENetPeer* peer);
+
+    /**
+     * Checks that a wifi packet received over a direct connection carries the MAC address the
+     * room assigned to that member, so members can't impersonate each other.
+     * @returns true if the transmitter address matches the direct peer
+     */
+    bool IsSentByDirectPeer(const ENetPacket* enet_packet, const DirectPeer& direct_peer) const;
+
+    /**
+     * Handles a wifi packet received over a direct connection.
+     * @returns true if the packet was kept to be handled once the room tells us about its sender
+     */
+    bool HandleDirectWifiPacket(ENetPeer* peer, ENetPacket* enet_packet);
+
+    /**
+     * Passes on a wifi packet received from a direct peer if it really comes from that member.
+     */
+    void ReceiveFromDirectPeer(DirectPeer& direct_peer, ENetPacket* enet_packet);
+
+    /**
+     * Disconnects the connections the room didn't tell us about and destroys their packets.
+     */
+    void DropUnknownDirectPeers();
+
     /**
      * Extracts a system message entry from a received ENet packet and adds it to the system message
      * queue.
@@ -163,10 +304,21 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
         if (enet_host_service(client, &event, 16) > 0) {
             switch (event.type) {
             case ENET_EVENT_TYPE_RECEIVE:
+                if (event.peer != server) {
+                    // Direct connections only carry wifi frames
+                    if (event.packet->data[0] != IdWifiPacket ||
+                        !HandleDirectWifiPacket(event.peer, event.packet)) {
+                        enet_packet_destroy(event.packet);
+                    }
+                    break;
+                }
                 switch (event.packet->data[0]) {
                 case IdWifiPacket:
                     HandleWifiPackets(&event);
                     break;
+                case IdDirectPeerInformation:
+                    HandleDirectPeerInformationPacket(&event);
+                    break;
                 case IdChatMessage:
                     HandleChatPacket(&event);
                     break;
@@ -238,6 +390,10 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
                 enet_packet_destroy(event.packet);
                 break;
             case ENET_EVENT_TYPE_DISCONNECT:
+                if (event.peer != server) {
+                    HandleDirectDisconnect(event.peer);
+                    break;
+                }
                 if (state == State::Joined || state == State::Moderator) {
                     SetState(State::Idle);
                     SetError(Error::LostConnection);
@@ -246,35 +402,90 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
             case ENET_EVENT_TYPE_NONE:
                 break;
             case ENET_EVENT_TYPE_CONNECT:
-                // The ENET_EVENT_TYPE_CONNECT event can not possibly happen here because we're
-                // already connected
-                ASSERT_MSG(false, "Received unexpected connect event while already connected");
+                // We're already connected to the room, so this can only be another member
+                HandleDirectConnect(event.peer);
                 break;
             }
         }
 
-        std::list<Packet> packets;
         {
             std::lock_guard lock(send_list_mutex);
-            packets.swap(send_list);
+            pending_send_list.swap(send_list);
         }
-        for (const auto& packet : packets) {
-            ENetPacket* enetPacket = enet_packet_create(packet.GetData(), packet.GetDataSize(),
-                                                        ENET_PACKET_FLAG_RELIABLE);
-            enet_peer_send(server, 0, enetPacket);
+        for (ENetPacket* enet_packet : pending_send_list) {
+            if (enet_packet->data[0] == IdWifiPacket && SendWifiPacketDirect(enet_packet)) {
+                continue;
+            }
+            if (enet_peer_send(server, 0, enet_packet) < 0) {
+                enet_packet_destroy(enet_packet);
+            }
         }
+        pending_send_list.clear();
         enet_host_flush(client);
     }
     Disconnect();
+    DiscardPendingSends();
 };
 
+RoomMember::RoomMemberImpl::~RoomMemberImpl() {
+    // Queued packets may hold pooled buffers, so they have to go before the pool does
+    DiscardPendingSends();
+}
+
 void RoomMember::RoomMemberImpl::StartLoop() {
     loop_thread = std::make_unique<std::thread>(&RoomMember::RoomMemberImpl::MemberLoop, this);
 }
 
 void RoomMember::RoomMemberImpl::Send(Packet&& packet) {
+    Send(enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE));
+}
+
+void RoomMember::RoomMemberImpl::Send(ENetPacket* enet_packet) {
     std::lock_guard lock(send_list_mutex);
-    send_list.push_back(std::move(packet));
+    send_list.push_back(enet_packet);
+}
+
+void RoomMember::RoomMemberImpl::DiscardPendingSends() {
+    std::lock_guard lock(send_list_mutex);
+    for (ENetPacket* enet_packet : send_list) {
+        enet_packet_destroy(enet_packet);
+    }
+    send_list.clear();
+}
+
+ENetPacket* RoomMember::RoomMemberImpl::CreateWifiPacket(std::size_t size) {
+    if (size > WifiSendBufferSize) {
+        return enet_packet_create(nullptr, size, ENET_PACKET_FLAG_RELIABLE);
+    }
+
+    std::unique_ptr<u8[]> buffer;
+    {
+        std::lock_guard lock(wifi_send_buffer_mutex);
+        if (!free_wifi_send_buffers.empty()) {
+            buffer = std::move(free_wifi_send_buffers.back());
+            free_wifi_send_buffers.pop_back();
+        }
+    }
+    if (!buffer) {
+        buffer = std::make_unique<u8[]>(WifiSendBufferSize);
+    }
+
+    // With NO_ALLOCATE ENet uses the buffer as is and leaves freeing it to freeCallback
+    ENetPacket* enet_packet = enet_packet_create(
+        buffer.get(), size, ENET_PACKET_FLAG_RELIABLE | ENET_PACKET_FLAG_NO_ALLOCATE);
+    enet_packet->userData = this;
+    enet_packet->freeCallback = &ReleaseWifiPacket;
+    buffer.release();
+    return enet_packet;
+}
+
+void ENET_CALLBACK RoomMember::RoomMemberImpl::ReleaseWifiPacket(ENetPacket* enet_packet) {
+    auto* impl = static_cast<RoomMemberImpl*>(enet_packet->userData);
+    std::unique_ptr<u8[]> buffer{enet_packet->data};
+    std::lock_guard lock(impl->wifi_send_buffer_mutex);
+    if (impl->free_wifi_send_buffers.size() < MaxFreeWifiSendBuffers) {
+        impl->free_wifi_send_buffers.push_back(std::move(buffer));
+    }
 }
 
 void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
@@ -294,8 +505,7 @@ void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
 }
 
 void RoomMember::RoomMemberImpl::HandleRoomInformationPacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
@@ -338,8 +548,7 @@ void RoomMember::RoomMemberImpl::HandleRoomInformationPacket(const ENetEvent* ev
 }
 
 void RoomMember::RoomMemberImpl::HandleJoinPacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
@@ -350,8 +559,7 @@ void RoomMember::RoomMemberImpl::HandleJoinPacket(const ENetEvent* event) {
 
 void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
     WifiPacket wifi_packet{};
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
@@ -371,8 +579,7 @@ void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
 }
 
 void RoomMember::RoomMemberImpl::HandleChatPacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8));
@@ -385,9 +592,271 @@ void RoomMember::RoomMemberImpl::HandleChatPacket(const ENetEvent* event) {
     Invoke<ChatEntry>(chat_entry);
 }
 
+void RoomMember::RoomMemberImpl::HandleDirectPeerInformationPacket(const ENetEvent* event) {
+    if (!direct_connections_enabled) {
+        return;
+    }
+
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
+
+    // Ignore the first byte, which is the message id.
+    packet.IgnoreBytes(sizeof(u8));
+
+    u32 num_peers;
+    packet >> num_peers;
+
+    std::vector<DirectPeer> new_peers;
+    for (u32 i = 0; i < num_peers && packet; ++i) {
+        DirectPeer new_peer{};
+        packet >> new_peer.mac_address;
+        packet >> new_peer.address.host;
+        packet >> new_peer.address.port;
+        if (new_peer.mac_address == mac_address) {
+            continue;
+        }
+
+        const auto existing = std::find_if(
+            direct_peers.begin(), direct_peers.end(), [&new_peer](const DirectPeer& direct_peer) {
+                return direct_peer.mac_address == new_peer.mac_address &&
+                       direct_peer.address.host == new_peer.address.host &&
+                       direct_peer.address.port == new_peer.address.port;
+            });
+        const auto unknown = std::find_if(
+            unknown_direct_peers.begin(), unknown_direct_peers.end(),
+            [&new_peer](const UnknownDirectPeer& unknown_peer) {
+                return unknown_peer.peer->address.host == new_peer.address.host &&
+                       unknown_peer.peer->address.port == new_peer.address.port;
+            });
+        // Both members connect to each other, so that each opens its NAT for the other. The
+        // connection made by the member with the lower MAC address is the one that is kept.
+        if (existing != direct_peers.end()) {
+            new_peer = *existing;
+            existing->peer = nullptr; // Keep the connections, see below
+            existing->probe = nullptr;
+        } else if (mac_address < new_peer.mac_address) {
+            if (unknown != unknown_direct_peers.end()) {
+                // The probe of the member reached us before the peer information
+                enet_peer_disconnect(unknown->peer, 0);
+                for (ENetPacket* enet_packet : unknown->packets) {
+                    enet_packet_destroy(enet_packet);
+                }
+                unknown_direct_peers.erase(unknown);
+            }
+            new_peer.peer = enet_host_connect(client, &new_peer.address, NumChannels, 0);
+        } else if (unknown != unknown_direct_peers.end()) {
+            // The member connected before the room told us about it
+            new_peer.peer = unknown->peer;
+            new_peer.connected = true;
+            for (ENetPacket* enet_packet : unknown->packets) {
+                ReceiveFromDirectPeer(new_peer, enet_packet);
+                enet_packet_destroy(enet_packet);
+            }
+            unknown_direct_peers.erase(unknown);
+        } else {
+            new_peer.probe = enet_host_connect(client, &new_peer.address, NumChannels, 0);
+        }
+        new_peers.push_back(new_peer);
+    }
+
+    // Whatever is left over belongs to members that are gone, or that the room never brokered
+    for (const auto& direct_peer : direct_peers) {
+        if (direct_peer.peer) {
+            enet_peer_disconnect(direct_peer.peer, 0);
+        }
+        if (direct_peer.probe) {
+            enet_peer_disconnect(direct_peer.probe, 0);
+        }
+    }
+    direct_peers = std::move(new_peers);
+    DropUnknownDirectPeers();
+}
+
+void RoomMember::RoomMemberImpl::HandleDirectConnect(ENetPeer* peer) {
+    const auto probing = std::find_if(
+        direct_peers.begin(), direct_peers.end(),
+        [peer](const DirectPeer& direct_peer) { return direct_peer.probe == peer; });
+    if (probing != direct_peers.end()) {
+        // Our NAT lets the member through now, its own connection takes over
+        enet_peer_disconnect(peer, 0);
+        probing->probe = nullptr;
+        return;
+    }
+
+    auto direct_peer = FindDirectPeer(peer);
+    if (direct_peer != direct_peers.end()) {
+        direct_peer->connected = true;
+        return;
+    }
+
+    // An incoming connection, find who it is by the address the room told us about
+    direct_peer = std::find_if(direct_peers.begin(), direct_peers.end(),
+                               [peer](const DirectPeer& direct_peer) {
+                                   return direct_peer.address.host == peer->address.host &&
+                                          direct_peer.address.port == peer->address.port;
+                               });
+    if (direct_peer != direct_peers.end() &&
+        (mac_address < direct_peer->mac_address || direct_peer->peer)) {
+        // The probe of a member we connect to ourselves, or a second connection from the member
+        enet_peer_disconnect(peer, 0);
+        return;
+    }
+    if (direct_peer == direct_peers.end()) {
+        // Wait for the peer information, the room sends it to every member when one joins
+        if (!direct_connections_enabled ||
+            unknown_direct_peers.size() >= room_information.member_slots) {
+            LOG_WARNING(Network, "Refusing direct connection from unknown address");
+            enet_peer_disconnect_now(peer, 0);
+            return;
+        }
+        unknown_direct_peers.push_back({peer, {}});
+        return;
+    }
+    direct_peer->peer = peer;
+    direct_peer->connected = true;
+}
+
+void RoomMember::RoomMemberImpl::HandleDirectDisconnect(ENetPeer* peer) {
+    const auto unknown = std::find_if(
+        unknown_direct_peers.begin(), unknown_direct_peers.end(),
+        [peer](const UnknownDirectPeer& unknown_peer) { return unknown_peer.peer == peer; });
+    if (unknown != unknown_direct_peers.end()) {
+        for (ENetPacket* enet_packet : unknown->packets) {
+            enet_packet_destroy(enet_packet);
+        }
+        unknown_direct_peers.erase(unknown);
+    }
+    for (auto& direct_peer : direct_peers) {
+        if (direct_peer.probe == peer) {
+            direct_peer.probe = nullptr;
+        }
+        if (direct_peer.peer == peer) {
+            direct_peer.peer = nullptr;
+            direct_peer.connected = false;
+        }
+    }
+}
+
+bool RoomMember::RoomMemberImpl::SendWifiPacketDirect(ENetPacket* enet_packet) {
+    if (direct_peers.empty()) {
+        return false;
+    }
+
+    MacAddress destination;
+    std::memcpy(destination.data(), enet_packet->data + WifiPacketDestinationOffset,
+                sizeof(MacAddress));
+
+    // Only connections ENet can queue the packet on count, so that the sends below either all
+    // succeed or all fail
+    const auto is_usable = [](const DirectPeer& direct_peer) {
+        return direct_peer.connected && direct_peer.peer->state == ENET_PEER_STATE_CONNECTED;
+    };
+    const auto is_connected = [this, &is_usable](const MacAddress& address) {
+        return std::any_of(direct_peers.begin(), direct_peers.end(),
+                           [&is_usable, &address](const DirectPeer& direct_peer) {
+                               return is_usable(direct_peer) && direct_peer.mac_address == address;
+                           });
+    };
+
+    if (destination == BroadcastMac) {
+        const bool all_connected =
+            std::all_of(member_information.begin(), member_information.end(),
+                        [this, &is_connected](const MemberInformation& member) {
+                            return member.mac_address == mac_address ||
+                                   is_connected(member.mac_address);
+                        });
+        if (!all_connected) {
+            return false;
+        }
+        for (auto& direct_peer : direct_peers) {
+            if (is_usable(direct_peer) && enet_peer_send(direct_peer.peer, 0, enet_packet) == 0) {
+                direct_peer.frames_sent++;
+            }
+        }
+    } else {
+        const auto direct_peer = std::find_if(direct_peers.begin(), direct_peers.end(),
+                                              [&is_usable, &destination](const DirectPeer& peer) {
+                                                  return is_usable(peer) &&
+                                                         peer.mac_address == destination;
+                                              });
+        if (direct_peer == direct_peers.end()) {
+            return false;
+        }
+        if (enet_peer_send(direct_peer->peer, 0, enet_packet) == 0) {
+            direct_peer->frames_sent++;
+        }
+    }
+
+    // ENet takes ownership once the packet is queued on at least one peer. Otherwise the caller
+    // still owns it and relays it through the room.
+    return enet_packet->referenceCount != 0;
+}
+
+std::vector<RoomMember::RoomMemberImpl::DirectPeer>::iterator
+RoomMember::RoomMemberImpl::FindDirectPeer(const ENetPeer* peer) {
+    return std::find_if(direct_peers.begin(), direct_peers.end(),
+                        [peer](const DirectPeer& direct_peer) { return direct_peer.peer == peer; });
+}
+
+bool RoomMember::RoomMemberImpl::IsSentByDirectPeer(const ENetPacket* enet_packet,
+                                                    const DirectPeer& direct_peer) const {
+    if (enet_packet->dataLength < WifiPacketDestinationOffset) {
+        return false;
+    }
+    MacAddress transmitter;
+    std::memcpy(transmitter.data(), enet_packet->data + WifiPacketTransmitterOffset,
+                sizeof(MacAddress));
+    if (transmitter != direct_peer.mac_address) {
+        LOG_WARNING(Network, "Dropping direct wifi packet with a spoofed transmitter address");
+        return false;
+    }
+    return true;
+}
+
+bool RoomMember::RoomMemberImpl::HandleDirectWifiPacket(ENetPeer* peer, ENetPacket* enet_packet) {
+    const auto direct_peer = FindDirectPeer(peer);
+    if (direct_peer != direct_peers.end()) {
+        ReceiveFromDirectPeer(*direct_peer, enet_packet);
+        return false;
+    }
+
+    // The member connected before the room told us about it, hold on to what it sends until then
+    const auto unknown = std::find_if(
+        unknown_direct_peers.begin(), unknown_direct_peers.end(),
+        [peer](const UnknownDirectPeer& unknown_peer) { return unknown_peer.peer == peer; });
+    if (unknown == unknown_direct_peers.end() ||
+        unknown->packets.size() >= MaxUnknownDirectPeerPackets) {
+        return false;
+    }
+    unknown->packets.push_back(enet_packet);
+    return true;
+}
+
+void RoomMember::RoomMemberImpl::ReceiveFromDirectPeer(DirectPeer& direct_peer,
+                                                      ENetPacket* enet_packet) {
+    if (!IsSentByDirectPeer(enet_packet, direct_peer)) {
+        return;
+    }
+    direct_peer.frames_received++;
+
+    ENetEvent event{};
+    event.peer = direct_peer.peer;
+    event.packet = enet_packet;
+    HandleWifiPackets(&event);
+}
+
+void RoomMember::RoomMemberImpl::DropUnknownDirectPeers() {
+    for (const auto& unknown_peer : unknown_direct_peers) {
+        LOG_WARNING(Network, "Refusing direct connection from unknown address");
+        enet_peer_disconnect(unknown_peer.peer, 0);
+        for (ENetPacket* enet_packet : unknown_peer.packets) {
+            enet_packet_destroy(enet_packet);
+        }
+    }
+    unknown_direct_peers.clear();
+}
+
 void RoomMember::RoomMemberImpl::HandleStatusMessagePacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8));
@@ -402,8 +871,7 @@ void RoomMember::RoomMemberImpl::HandleStatusMessagePacket(const ENetEvent* even
 }
 
 void RoomMember::RoomMemberImpl::HandleModBanListResponsePacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet = Packet::View(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
     packet.IgnoreBytes(sizeof(u8));
@@ -419,6 +887,26 @@ void RoomMember::RoomMemberImpl::Disconnect() {
     room_information.member_slots = 0;
     room_information.name.clear();
 
+    {
+        std::lock_guard lock(network_mutex);
+        for (const auto& direct_peer : direct_peers) {
+            if (direct_peer.peer) {
+                enet_peer_disconnect_now(direct_peer.peer, 0);
+            }
+            if (direct_peer.probe) {
+                enet_peer_disconnect_now(direct_peer.probe, 0);
+            }
+        }
+        for (const auto& unknown_peer : unknown_direct_peers) {
+            enet_peer_disconnect_now(unknown_peer.peer, 0);
+            for (ENetPacket* enet_packet : unknown_peer.packets) {
+                enet_packet_destroy(enet_packet);
+            }
+        }
+        direct_peers.clear();
+        unknown_direct_peers.clear();
+    }
+
     if (!server)
         return;
     enet_peer_disconnect(server, 0);
@@ -536,6 +1024,26 @@ RoomInformation RoomMember::GetRoomInformation() const {
     return room_member_impl->room_information;
 }
 
+u32 RoomMember::GetRoomLatency() const {
+    std::lock_guard lock(room_member_impl->network_mutex);
+    if (!room_member_impl->server) {
+        return 0;
+    }
+    return room_member_impl->server->roundTripTime;
+}
+
+std::vector<RoomMember::DirectConnection> RoomMember::GetDirectConnections() const {
+    std::vector<DirectConnection> connections;
+    std::lock_guard lock(room_member_impl->network_mutex);
+    for (const auto& direct_peer : room_member_impl->direct_peers) {
+        if (direct_peer.connected) {
+            connections.push_back({direct_peer.mac_address, direct_peer.peer->roundTripTime,
+                                   direct_peer.frames_sent, direct_peer.frames_received});
+        }
+    }
+    return connections;
+}
+
 void RoomMember::Join(const std::string& nick, const std::string& console_id_hash,
                       const char* server_addr, u16 server_port, u16 client_port,
                       const MacAddress& preferred_mac, const std::string& password,
@@ -549,8 +1057,12 @@ void RoomMember::Join(const std::string& nick, const std::string& console_id_has
         room_member_impl->loop_thread.reset();
     }
 
+    room_member_impl->direct_connections_enabled = NetSettings::values.enable_direct_connections;
     if (!room_member_impl->client) {
-        room_member_impl->client = enet_host_create(nullptr, 1, NumChannels, 0, 0);
+        // Direct connections need a peer for every other member on top of the room
+        const std::size_t peer_count =
+            room_member_impl->direct_connections_enabled ? MaxConcurrentConnections + 1 : 1;
+        room_member_impl->client = enet_host_create(nullptr, peer_count, NumChannels, 0, 0);
         ASSERT_MSG(room_member_impl->client != nullptr, "Could not create client");
     }
 
@@ -575,6 +1087,11 @@ void RoomMember::Join(const std::string& nick, const std::string& console_id_has
         room_member_impl->StartLoop();
         room_member_impl->SendJoinRequest(nick, console_id_hash, preferred_mac, password, token);
         SendGameInfo(room_member_impl->current_game_info);
+        if (room_member_impl->direct_connections_enabled) {
+            Packet packet;
+            packet << static_cast<u8>(IdDirectConnectRequest);
+            room_member_impl->Send(std::move(packet));
+        }
     } else {
         enet_peer_disconnect(room_member_impl->server, 0);
         room_member_impl->SetState(State::Idle);
@@ -587,14 +1104,29 @@ bool RoomMember::IsConnected() const {
 }
 
 void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
-    Packet packet;
-    packet << static_cast<u8>(IdWifiPacket);
-    packet << static_cast<u8>(wifi_packet.type);
-    packet << wifi_packet.channel;
-    packet << wifi_packet.transmitter_address;
-    packet << wifi_packet.destination_address;
-    packet << wifi_packet.data;
-    room_member_impl->Send(std::move(packet));
+    // Wifi packets are sent at a high rate during local wireless play, so build them straight into
+    // a pooled packet buffer instead of going through a growing Packet. The layout must match what
+    // Packet would produce, see HandleWifiPackets.
+    const auto data_size = static_cast<u32>(wifi_packet.data.size());
+    const std::size_t size = 3 * sizeof(u8) + 2 * sizeof(MacAddress) + sizeof(u32) + data_size;
+    ENetPacket* enet_packet = room_member_impl->CreateWifiPacket(size);
+
+    u8* out = enet_packet->data;
+    *out++ = static_cast<u8>(IdWifiPacket);
+    *out++ = static_cast<u8>(wifi_packet.type);
+    *out++ = wifi_packet.channel;
+    std::memcpy(out, wifi_packet.transmitter_address.data(), sizeof(MacAddress));
+    out += sizeof(MacAddress);
+    std::memcpy(out, wifi_packet.destination_address.data(), sizeof(MacAddress));
+    out += sizeof(MacAddress);
+    const u32_be data_size_be = data_size;
+    std::memcpy(out, &data_size_be, sizeof(u32));
+    out += sizeof(u32);
+    if (data_size > 0) {
+        std::memcpy(out, wifi_packet.data.data(), data_size);
+    }
+
+    room_member_impl->Send(enet_packet);
 }
 
 void RoomMember::SendChatMessage(const std::string& message) {
@@ -682,6 +1214,7 @@ void RoomMember::Leave() {
     room_member_impl->SetState(State::Idle);
     room_member_impl->loop_thread->join();
     room_member_impl->loop_thread.reset();
+    room_member_impl->DiscardPendingSends();
 
     enet_host_destroy(room_member_impl->client);
     room_member_impl->client = nullptr;
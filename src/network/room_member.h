@@ -107,6 +107,13 @@ public:
     };
     using MemberList = std::vector<MemberInformation>;
 
+    struct DirectConnection {
+        MacAddress mac_address; ///< MAC address of the member we're directly connected to.
+        u32 latency;            ///< Round trip time to the member, in milliseconds.
+        u64 frames_sent;        ///< Wifi frames sent to the member over the connection.
+        u64 frames_received;    ///< Wifi frames received from the member over the connection.
+    };
+
     // The handle for the callback functions
     template <typename T>
     using CallbackHandle = std::shared_ptr<std::function<void(const T&)>>;
@@ -151,6 +158,18 @@ public:
      */
     RoomInformation GetRoomInformation() const;
 
+    /**
+     * Returns the round trip time to the room in milliseconds, or 0 if we're not connected.
+     */
+    u32 GetRoomLatency() const;
+
+    /**
+     * Returns the members we currently exchange wifi packets with directly rather than through
+     * the room, along with the latency to each of them. Direct connections are only made when
+     * NetSettings::values.enable_direct_connections was set when joining.
+     */
+    std::vector<DirectConnection> GetDirectConnections() const;
+
     /**
      * Returns whether we're connected to a server or not.
      */
@@ -0,0 +1,52 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include <teakra/teakra.h>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// DSP cycles of one periodic DspLle slice
+constexpr u32 SliceCycles = 16384;
+
+/**
+ * Loads a synthetic program, so no firmware image is needed: a block of nops closed by an
+ * unconditional branch back to the reset vector.
+ */
+void LoadLoopProgram(Teakra::Teakra& teakra) {
+    constexpr std::size_t LoopWords = 0x400;
+    constexpr std::array<u16, 2> Branch{0x4180, 0x0000}; // br 0x00000, always
+
+    teakra.Reset();
+    auto& memory = teakra.GetDspMemory();
+    std::fill(memory.begin(), memory.end(), u8{0}); // nop
+    std::memcpy(memory.data() + LoopWords * sizeof(u16), Branch.data(), sizeof(Branch));
+}
+
+} // Anonymous namespace
+
+// Cost of running the same number of DSP cycles in steps of different lengths, which is what
+// batching the synchronization with the ARM side saves.
+TEST_CASE("Teakra DSP cycle throughput", "[audio_core][lle]") {
+    Teakra::Teakra teakra;
+    LoadLoopProgram(teakra);
+
+    for (const u32 step : {SliceCycles, 2048U, 256U}) {
+        BENCHMARK(fmt::format("{} cycles in steps of {}", SliceCycles, step)) {
+            for (u32 cycles = 0; cycles < SliceCycles; cycles += step) {
+                teakra.Run(step);
+            }
+        };
+    }
+}
+
+} // namespace AudioCore
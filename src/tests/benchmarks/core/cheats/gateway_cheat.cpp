@@ -0,0 +1,31 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/cheats/gateway_cheat.h"
+#include "tests/core/cheats/cheat_environment.h"
+
+namespace Cheats {
+
+TEST_CASE("GatewayCheat execution per tick", "[core][cheats]") {
+    constexpr u32 NumWrites = 500;
+
+    CheatEnvironment env;
+    std::string code;
+    for (u32 i = 0; i < NumWrites; ++i) {
+        code += CodeLine(0x50000000 | (BufferAddress + i * 4), 0);
+        code += CodeLine(BufferAddress + 0x8000 + i * 4, i);
+        code += CodeLine(0xD0000000, 0);
+    }
+    const GatewayCheat cheat("benchmark", code, "");
+
+    BENCHMARK("1500 lines of conditional writes") {
+        env.Run(cheat);
+    };
+    REQUIRE(env.Read32(0x8000 + (NumWrites - 1) * 4) == NumWrites - 1);
+}
+
+} // namespace Cheats
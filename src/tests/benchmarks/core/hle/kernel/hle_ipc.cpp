@@ -0,0 +1,61 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/ipc.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+
+namespace Kernel {
+
+// Measures the HLE side of a SendSyncRequest round trip: translating the request into a pooled
+// context, dispatching it and writing the reply back.
+TEST_CASE("HLE request round trip", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    auto mem = std::make_shared<BufferMem>(Memory::CITRA_PAGE_SIZE);
+    MemoryRef buffer{mem};
+    const VAddr target_address = 0x10000000;
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(target_address, buffer, static_cast<u32>(buffer.GetSize()),
+                                  MemoryState::Private)
+                .Code() == RESULT_SUCCESS);
+
+    const u32_le input[]{
+        IPC::MakeHeader(0x1, 2, 2),
+        0x12345678,
+        0x87654321,
+        IPC::StaticBufferDesc(0x40, 0),
+        target_address,
+    };
+    u32_le output[IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS]{};
+
+    BENCHMARK("Request with a static buffer") {
+        auto context = kernel.AcquireHLERequestContext(server, nullptr);
+        context->PopulateFromIncomingCommandBuffer(input, process);
+
+        u32* cmd_buf = context->CommandBuffer();
+        cmd_buf[0] = IPC::MakeHeader(0x1, 2, 0);
+        cmd_buf[1] = RESULT_SUCCESS.raw;
+        cmd_buf[2] = static_cast<u32>(context->GetStaticBuffer(0).size());
+
+        context->WriteToOutgoingCommandBuffer(output, *process);
+        kernel.ReleaseHLERequestContext(std::move(context));
+    };
+    REQUIRE(output[2] == 0x40);
+
+    REQUIRE(process->vm_manager.UnmapRange(target_address, static_cast<u32>(buffer.GetSize())) ==
+            RESULT_SUCCESS);
+}
+
+} // namespace Kernel
@@ -0,0 +1,57 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/thread.h"
+#include "tests/core/hle/kernel/scheduler_environment.h"
+
+namespace Kernel {
+
+TEST_CASE("Kernel scheduling", "[core][kernel]") {
+    SchedulerEnvironment env;
+
+    SECTION("context switch between threads of the same priority") {
+        auto first = env.CreateThread(30);
+        auto second = env.CreateThread(30);
+        env.Manager().Reschedule();
+
+        BENCHMARK("Sleep, reschedule and resume") {
+            Thread* current = env.Manager().GetCurrentThread();
+            env.SleepAndReschedule();
+            current->ResumeFromWait();
+        };
+    }
+
+    SECTION("wake up of threads waiting on an event") {
+        constexpr std::size_t NumThreads = 32;
+
+        auto event = env.kernel.CreateEvent(ResetType::Sticky);
+        std::vector<std::shared_ptr<Thread>> threads;
+        for (std::size_t i = 0; i < NumThreads; ++i) {
+            threads.push_back(env.CreateThread(static_cast<u32>(ThreadPrioLowest - i)));
+        }
+
+        const auto park_all = [&] {
+            env.Manager().Reschedule();
+            while (Thread* current = env.Manager().GetCurrentThread()) {
+                WaitOnObject(current, event);
+                env.Manager().Reschedule();
+            }
+        };
+
+        park_all();
+        BENCHMARK("Wake up and reschedule 32 threads") {
+            event->Signal();
+            event->Clear();
+            park_all();
+        };
+        REQUIRE(event->GetWaitingThreads().size() == NumThreads);
+    }
+}
+
+} // namespace Kernel
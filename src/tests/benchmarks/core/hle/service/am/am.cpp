@@ -0,0 +1,25 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/service/am/am.h"
+#include "tests/core/hle/service/am/install_environment.h"
+
+namespace Service::AM {
+
+TEST_CASE("InstallCIA throughput", "[core][am]") {
+    constexpr std::size_t ContentSize = 64 * 1024 * 1024;
+
+    InstallEnvironment env;
+    std::mt19937 rng(7);
+    env.WriteCIA(BuildCIA({RandomContent(ContentSize, rng)}));
+
+    BENCHMARK("Install a CIA with 64 MiB of content") {
+        return InstallCIA(env.cia_path);
+    };
+}
+
+} // namespace Service::AM
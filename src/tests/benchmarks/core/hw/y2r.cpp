@@ -0,0 +1,33 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_worker.h"
+#include "core/hw/y2r.h"
+#include "tests/core/hw/y2r_environment.h"
+
+namespace HW::Y2R {
+
+TEST_CASE("HW::Y2R conversion throughput", "[core][y2r]") {
+    Y2REnvironment env;
+    Common::ThreadWorker workers(std::max(std::thread::hardware_concurrency(), 2U) - 1, "Y2R");
+    const auto cvt =
+        env.MakeConfiguration(InputFormat::YUV420_Indiv8, OutputFormat::RGBA8, 400, 240);
+    REQUIRE(env.Convert(cvt, &workers) == env.ReferenceConvert(cvt));
+
+    BENCHMARK("400x240 frame, per pixel reference") {
+        return env.ReferenceConvert(cvt);
+    };
+    BENCHMARK("400x240 frame, calling thread") {
+        return env.Convert(cvt);
+    };
+    BENCHMARK("400x240 frame, worker threads") {
+        return env.Convert(cvt, &workers);
+    };
+}
+
+} // namespace HW::Y2R
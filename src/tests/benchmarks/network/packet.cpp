@@ -0,0 +1,32 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "network/packet.h"
+
+namespace Network {
+
+TEST_CASE("Packet serialization throughput", "[network]") {
+    const std::vector<u8> frame(1024, 0x5A);
+    const std::array<u8, 6> mac{0x00, 0x1F, 0x32, 0x01, 0x02, 0x03};
+
+    BENCHMARK("Build and parse a 1 KiB wifi packet") {
+        Packet packet;
+        packet.Reserve(3 + 2 * mac.size() + sizeof(u32) + frame.size());
+        packet << static_cast<u8>(1) << static_cast<u8>(1) << static_cast<u8>(1) << mac << mac
+               << frame;
+
+        Packet view = Packet::View(packet.GetData(), packet.GetDataSize());
+        u8 id, type, channel;
+        std::array<u8, 6> transmitter, destination;
+        std::vector<u8> data;
+        view >> id >> type >> channel >> transmitter >> destination >> data;
+        return data.size();
+    };
+}
+
+} // namespace Network
@@ -0,0 +1,73 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/hash.h"
+#include "video_core/rasterizer_cache/surface_page_table.h"
+
+namespace VideoCore {
+
+TEST_CASE("SurfacePageTable flush and invalidate patterns", "[video_core][rasterizer_cache]") {
+    constexpr PAddr VRAM = 0x18000000;
+    constexpr PAddr FCRAM = 0x20000000;
+    constexpr u32 FCRAM_SIZE = 0x8000000;
+    constexpr u32 PAGE_BITS = SurfacePageTable::PAGE_BITS;
+
+    // Framebuffers in VRAM and textures spread over the first 32MB of FCRAM
+    SurfacePageTable table;
+    std::unordered_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> per_page;
+    std::mt19937 rng(42);
+    const auto Insert = [&](PAddr addr, u32 size, u32 index) {
+        table.Insert(addr, size, SurfaceId{index});
+        for (u64 page = addr >> PAGE_BITS; page <= (addr + size - 1) >> PAGE_BITS; ++page) {
+            per_page[page].push_back(SurfaceId{index});
+        }
+    };
+    for (u32 i = 0; i < 16; ++i) {
+        Insert(VRAM + i * 0x60000, 400 * 240 * 4, i);
+    }
+    for (u32 i = 16; i < 1024; ++i) {
+        Insert(FCRAM + rng() % 0x2000000, 0x1000 << (rng() % 5), i);
+    }
+
+    const auto Lookups = [&](const char* name, u32 size) {
+        std::vector<PAddr> addresses(1024, FCRAM);
+        for (PAddr& addr : addresses) {
+            addr += rng() % (FCRAM_SIZE - size + 1);
+        }
+
+        std::size_t next = 0;
+        BENCHMARK(name) {
+            std::size_t found = 0;
+            table.ForEachPage(addresses[next++ % addresses.size()], size,
+                              [&found](std::span<const SurfaceId> surfaces) {
+                                  found += surfaces.size();
+                              });
+            return found;
+        };
+
+        // Reference: one hash lookup per 256KB bucket of the region
+        BENCHMARK(std::string(name) + ", per-bucket lookups") {
+            const PAddr addr = addresses[next++ % addresses.size()];
+            std::size_t found = 0;
+            for (u64 page = addr >> PAGE_BITS; page <= (addr + size - 1) >> PAGE_BITS; ++page) {
+                if (const auto it = per_page.find(page); it != per_page.end()) {
+                    found += it->second.size();
+                }
+            }
+            return found;
+        };
+    };
+    Lookups("8 byte CPU write", 8);
+    Lookups("64 KiB vertex buffer", 0x10000);
+    Lookups("FCRAM-wide flush", FCRAM_SIZE);
+}
+
+} // namespace VideoCore
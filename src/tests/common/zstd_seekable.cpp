@@ -0,0 +1,110 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/zstd_seekable.h"
+
+namespace Common::Compression {
+
+TEST_CASE("IOFile reads compressed ROMs through the seek table", "[common][zstd]") {
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    const std::string raw_path = (temp_dir / "citra_seekable_test.3ds").string();
+    const std::string compressed_path = (temp_dir / "citra_seekable_test.z3ds").string();
+
+    // Partly compressible data that does not end on a frame boundary
+    std::mt19937 rng(42);
+    std::vector<u8> data(5 * 64 * 1024 + 123);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = (i / 1000) % 3 == 0 ? static_cast<u8>(rng()) : static_cast<u8>(i);
+    }
+    {
+        FileUtil::IOFile raw(raw_path, "wb");
+        REQUIRE(raw.WriteBytes(data.data(), data.size()) == data.size());
+    }
+    {
+        FileUtil::IOFile raw(raw_path, "rb");
+        FileUtil::IOFile compressed(compressed_path, "wb");
+        REQUIRE(CompressFileSeekable(raw, compressed, 3, 64 * 1024));
+        REQUIRE(compressed.GetSize() < data.size());
+    }
+
+    FileUtil::IOFile file(compressed_path, "rb");
+    REQUIRE(file.IsOpen());
+    REQUIRE(file.GetSize() == data.size());
+
+    std::vector<u8> buffer(data.size());
+    REQUIRE(file.ReadBytes(buffer.data(), buffer.size()) == data.size());
+    REQUIRE(buffer == data);
+
+    // A second file on the same path shares the reader but keeps its own position
+    FileUtil::IOFile other(compressed_path, "rb");
+    for (int i = 0; i < 200; ++i) {
+        const u64 offset = rng() % data.size();
+        const std::size_t length = rng() % (3 * 64 * 1024);
+        const std::size_t expected = std::min<std::size_t>(length, data.size() - offset);
+        other.Seek(offset, SEEK_SET);
+        REQUIRE(other.ReadBytes(buffer.data(), length) == expected);
+        REQUIRE(other.Tell() == offset + expected);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected, data.begin() + offset));
+    }
+
+    file.Close();
+    other.Close();
+    FileUtil::Delete(raw_path);
+    FileUtil::Delete(compressed_path);
+}
+
+TEST_CASE("SeekableReader retries frames that failed to decompress", "[common][zstd]") {
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    const std::string raw_path = (temp_dir / "citra_seekable_retry_test.3ds").string();
+    const std::string compressed_path = (temp_dir / "citra_seekable_retry_test.z3ds").string();
+
+    std::vector<u8> data(2 * 64 * 1024);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i / 7);
+    }
+    {
+        FileUtil::IOFile raw(raw_path, "wb");
+        REQUIRE(raw.WriteBytes(data.data(), data.size()) == data.size());
+    }
+    {
+        FileUtil::IOFile raw(raw_path, "rb");
+        FileUtil::IOFile compressed(compressed_path, "wb");
+        REQUIRE(CompressFileSeekable(raw, compressed, 3, 64 * 1024));
+    }
+
+    // Break the magic number of the first frame while the reader is open
+    const auto write_magic = [&compressed_path](const std::array<u8, 4>& magic) {
+        FileUtil::IOFile patch(compressed_path, "r+b");
+        REQUIRE(patch.WriteBytes(magic.data(), magic.size()) == magic.size());
+    };
+    FileUtil::IOFile file(compressed_path, "rb");
+    REQUIRE(file.IsOpen());
+    std::array<u8, 4> magic;
+    {
+        FileUtil::IOFile original(compressed_path, "r+b");
+        REQUIRE(original.ReadBytes(magic.data(), magic.size()) == magic.size());
+    }
+    write_magic({});
+
+    std::vector<u8> buffer(data.size());
+    REQUIRE(file.ReadBytes(buffer.data(), buffer.size()) == 0);
+
+    write_magic(magic);
+    file.Seek(0, SEEK_SET);
+    REQUIRE(file.ReadBytes(buffer.data(), buffer.size()) == data.size());
+    REQUIRE(buffer == data);
+
+    file.Close();
+    FileUtil::Delete(raw_path);
+    FileUtil::Delete(compressed_path);
+}
+
+} // namespace Common::Compression
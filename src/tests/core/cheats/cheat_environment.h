@@ -0,0 +1,54 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <fmt/format.h>
+#include "core/cheats/gateway_cheat.h"
+#include "tests/core/hle/kernel/kernel_environment.h"
+
+namespace Cheats {
+
+inline constexpr VAddr BufferAddress = Memory::HEAP_VADDR;
+inline constexpr u32 BufferSize = 0x10000;
+
+/// A process with a heap buffer the cheats under test read and write.
+struct CheatEnvironment : Kernel::KernelEnvironment {
+    CheatEnvironment() {
+        process = CreateCurrentProcess();
+        buffer = MapBuffer(*process, BufferAddress, BufferSize);
+    }
+
+    void Run(const GatewayCheat& cheat) {
+        cheat.Execute(GatewayCheat::Environment{
+            memory,
+            [this](VAddr, u32) { invalidations++; },
+            [this] { return pad_state; },
+        });
+    }
+
+    u32 Read32(u32 offset) const {
+        u32 value;
+        std::memcpy(&value, buffer->GetPtr() + offset, sizeof(u32));
+        return value;
+    }
+
+    void Write32(u32 offset, u32 value) {
+        std::memcpy(buffer->GetPtr() + offset, &value, sizeof(u32));
+    }
+
+    std::shared_ptr<Kernel::Process> process;
+    std::shared_ptr<BufferMem> buffer;
+    std::size_t invalidations = 0;
+    u32 pad_state = 0;
+};
+
+inline std::string CodeLine(u32 first, u32 value) {
+    return fmt::format("{:08X} {:08X}\n", first, value);
+}
+
+} // namespace Cheats
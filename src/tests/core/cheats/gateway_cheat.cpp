@@ -0,0 +1,99 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "core/cheats/gateway_cheat.h"
+#include "tests/core/cheats/cheat_environment.h"
+
+namespace Cheats {
+
+TEST_CASE("GatewayCheat writes and conditionals", "[core][cheats]") {
+    CheatEnvironment env;
+    env.Write32(0x10, 5);
+
+    const std::string code = CodeLine(BufferAddress + 0x10, 0x1234) + // word[0x10] = 0x1234
+                             CodeLine(0x50000000 | (BufferAddress + 0x10), 0x1234) + // if == 0x1234
+                             CodeLine(0x20000000 | (BufferAddress + 0x20), 0xAB) + // byte = 0xAB
+                             CodeLine(0xD0000000, 0) +
+                             CodeLine(0x50000000 | (BufferAddress + 0x10), 0) + // if == 0
+                             CodeLine(BufferAddress + 0x30, 0xDEAD) +           // skipped
+                             CodeLine(0xD0000000, 0);
+    const GatewayCheat cheat("test", code, "");
+    env.Run(cheat);
+
+    REQUIRE(env.Read32(0x10) == 0x1234);
+    REQUIRE(env.Read32(0x20) == 0xAB);
+    REQUIRE(env.Read32(0x30) == 0);
+    REQUIRE(env.invalidations == 2);
+
+    // Unchanged values are not written again
+    env.Run(cheat);
+    REQUIRE(env.invalidations == 2);
+}
+
+TEST_CASE("GatewayCheat loops with incremental writes", "[core][cheats]") {
+    CheatEnvironment env;
+    const std::string code = CodeLine(0xD3000000, BufferAddress) + // offset = buffer
+                             CodeLine(0xD5000000, 0x77) +          // reg = 0x77
+                             CodeLine(0xC0000000, 3) +             // loop 3 times
+                             CodeLine(0xD6000000, 0x100) +         // word[0x100 + offset] = reg
+                             CodeLine(0xD2000000, 0);
+    env.Run(GatewayCheat("test", code, ""));
+
+    for (u32 i = 0; i < 4; ++i) {
+        REQUIRE(env.Read32(0x100 + i * 4) == 0x77);
+    }
+    REQUIRE(env.Read32(0x110) == 0);
+}
+
+TEST_CASE("GatewayCheat patches and skips patch payloads", "[core][cheats]") {
+    CheatEnvironment env;
+
+    SECTION("payload is copied") {
+        const std::string code = CodeLine(0xE0000000 | (BufferAddress + 0x200), 10) +
+                                 CodeLine(0x11111111, 0x22222222) +
+                                 CodeLine(0x00003333, 0x44444444) +
+                                 CodeLine(BufferAddress + 0x300, 1); // runs after the payload
+        env.Run(GatewayCheat("test", code, ""));
+        REQUIRE(env.Read32(0x200) == 0x11111111);
+        REQUIRE(env.Read32(0x204) == 0x22222222);
+        REQUIRE(env.Read32(0x208) == 0x3333);
+        REQUIRE(env.Read32(0x300) == 1);
+    }
+
+    SECTION("payload is skipped inside a false conditional") {
+        env.pad_state = 0x1;
+        const std::string code = CodeLine(0xDD000000, 0x2) + // if key 0x2 held
+                                 CodeLine(0xE0000000 | (BufferAddress + 0x200), 8) +
+                                 CodeLine(0xD0000000, 0) + // payload, not an end if
+                                 CodeLine(BufferAddress + 0x300, 1) + CodeLine(0xD0000000, 0) +
+                                 CodeLine(BufferAddress + 0x304, 2);
+        env.Run(GatewayCheat("test", code, ""));
+        REQUIRE(env.Read32(0x200) == 0);
+        REQUIRE(env.Read32(0x300) == 0);
+        REQUIRE(env.Read32(0x304) == 2);
+    }
+}
+
+TEST_CASE("GatewayCheat resolves host pointers again after remapping", "[core][cheats]") {
+    CheatEnvironment env;
+    const GatewayCheat cheat("test", CodeLine(BufferAddress, 0x1234), "");
+    env.Run(cheat);
+    REQUIRE(env.Read32(0) == 0x1234);
+
+    auto other = std::make_shared<BufferMem>(BufferSize);
+    env.process->vm_manager.UnmapRange(BufferAddress, BufferSize);
+    env.process->vm_manager.MapBackingMemory(BufferAddress, MemoryRef{other}, BufferSize,
+                                             Kernel::MemoryState::Private);
+    env.Run(cheat);
+
+    u32 value;
+    std::memcpy(&value, other->GetPtr(), sizeof(u32));
+    REQUIRE(value == 0x1234);
+}
+
+} // namespace Cheats
@@ -0,0 +1,52 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/call_profiler.h"
+
+namespace HLE::CallProfiler {
+
+TEST_CASE("CallProfiler::BucketIndex", "[core][hle]") {
+    REQUIRE(BucketIndex(0) == 0);
+    REQUIRE(BucketIndex(1) == 1);
+    REQUIRE(BucketIndex(2) == 2);
+    REQUIRE(BucketIndex(3) == 2);
+    REQUIRE(BucketIndex(1024) == 11);
+    REQUIRE(BucketIndex(~0ULL) == NumBuckets - 1);
+}
+
+TEST_CASE("CallProfiler::Histogram", "[core][hle]") {
+    Histogram histogram;
+    histogram.Record(100);
+    histogram.Record(3000);
+    REQUIRE(histogram.count == 2);
+    REQUIRE(histogram.total_ns == 3100);
+    REQUIRE(histogram.max_ns == 3000);
+    REQUIRE(histogram.buckets[BucketIndex(100)] == 1);
+    REQUIRE(histogram.buckets[BucketIndex(3000)] == 1);
+
+    histogram.Reset();
+    REQUIRE(histogram.count == 0);
+    REQUIRE(histogram.buckets[BucketIndex(100)] == 0);
+}
+
+TEST_CASE("CallProfiler::ExportJson", "[core][hle]") {
+    Reset();
+    const int service = 0;
+    RecordSVC(0x32, "SendSyncRequest", 500);
+    RecordSVC(0x32, "SendSyncRequest", 700);
+    RecordServiceCommand(&service, 0x00010040, "fs:USER", "Initialize", 2000);
+
+    const std::string json = ExportJson();
+    REQUIRE(json.find("\"id\":50,\"name\":\"SendSyncRequest\",\"count\":2,\"total_ns\":1200") !=
+            std::string::npos);
+    REQUIRE(json.find("\"service\":\"fs:USER\",\"header\":\"0x00010040\",\"name\":\"Initialize\","
+                      "\"count\":1") != std::string::npos);
+
+    Reset();
+    REQUIRE(ExportJson() == "{\"svc\":[],\"service\":[]}");
+}
+
+} // namespace HLE::CallProfiler
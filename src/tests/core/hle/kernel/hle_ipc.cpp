@@ -391,4 +391,37 @@ TEST_CASE("HLERequestContext::WriteToOutgoingCommandBuffer", "[core][kernel]") {
     }
 }
 
+TEST_CASE("KernelSystem::AcquireHLERequestContext", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    SECTION("reuses released contexts") {
+        auto context = kernel.AcquireHLERequestContext(server, nullptr);
+        HLERequestContext* raw = context.get();
+        context->AddStaticBuffer(0, std::vector<u8>(0x20, 0xAB));
+        context->AddOutgoingHandle(MakeObject(kernel));
+        kernel.ReleaseHLERequestContext(std::move(context));
+
+        auto reused = kernel.AcquireHLERequestContext(server, nullptr);
+        REQUIRE(reused.get() == raw);
+        REQUIRE(reused->Session() == server);
+        REQUIRE(reused->GetStaticBuffer(0).empty());
+        REQUIRE(reused->AddOutgoingHandle(nullptr) == 0);
+    }
+
+    SECTION("keeps contexts that are still referenced") {
+        auto context = kernel.AcquireHLERequestContext(server, nullptr);
+        auto held = context;
+        kernel.ReleaseHLERequestContext(std::move(context));
+
+        auto other = kernel.AcquireHLERequestContext(server, nullptr);
+        REQUIRE(other != held);
+        REQUIRE(held->Session() == server);
+    }
+}
+
 } // namespace Kernel
@@ -0,0 +1,37 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+/// A single core kernel on its own memory system, the setup the tests and benchmarks share.
+struct KernelEnvironment {
+    /// Creates an empty process and makes it the current one.
+    std::shared_ptr<Process> CreateCurrentProcess() {
+        auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+        kernel.SetCurrentProcess(process);
+        return process;
+    }
+
+    /// Maps a new buffer of the given size into the process at address.
+    static std::shared_ptr<BufferMem> MapBuffer(Process& process, VAddr address, u32 size) {
+        auto buffer = std::make_shared<BufferMem>(size);
+        process.vm_manager.MapBackingMemory(address, MemoryRef{buffer}, size,
+                                            MemoryState::Private);
+        return buffer;
+    }
+
+    Core::Timing timing{1, 100};
+    Memory::MemorySystem memory;
+    KernelSystem kernel{memory, timing, [] {}, 0, 1, 0};
+};
+
+} // namespace Kernel
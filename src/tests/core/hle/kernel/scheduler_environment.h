@@ -0,0 +1,55 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/hle/kernel/thread.h"
+#include "tests/core/hle/kernel/kernel_environment.h"
+
+namespace Kernel {
+
+/// A single core kernel with an interpreter attached, which is enough to switch thread contexts.
+struct SchedulerEnvironment : KernelEnvironment {
+    static constexpr VAddr EntryPoint = 0x00100000;
+
+    SchedulerEnvironment() {
+        cpu = std::make_shared<ARM_DynCom>(nullptr, memory, USER32MODE, 0, timing.GetTimer(0));
+        kernel.SetCPUs({cpu});
+        kernel.SetRunningCPU(cpu.get());
+
+        process = CreateCurrentProcess();
+        MapBuffer(*process, EntryPoint, Memory::CITRA_PAGE_SIZE);
+    }
+
+    std::shared_ptr<Thread> CreateThread(u32 priority) {
+        return kernel
+            .CreateThread("test", EntryPoint, priority, 0, 0, Memory::HEAP_VADDR_END, process)
+            .Unwrap();
+    }
+
+    ThreadManager& Manager() {
+        return kernel.GetThreadManager(0);
+    }
+
+    /// Puts the running thread to sleep and switches to the best ready thread.
+    Thread* SleepAndReschedule() {
+        Manager().WaitCurrentThread_Sleep();
+        Manager().Reschedule();
+        return Manager().GetCurrentThread();
+    }
+
+    std::shared_ptr<ARM_DynCom> cpu;
+    std::shared_ptr<Process> process;
+};
+
+/// Parks the running thread on an object, the way WaitSynchronization1 does.
+inline void WaitOnObject(Thread* thread, const std::shared_ptr<WaitObject>& object) {
+    thread->status = ThreadStatus::WaitSynchAny;
+    thread->wait_objects = {object};
+    object->AddWaitingThread(SharedFrom(thread));
+}
+
+} // namespace Kernel
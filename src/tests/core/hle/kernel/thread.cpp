@@ -0,0 +1,80 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/kernel/thread.h"
+#include "tests/core/hle/kernel/scheduler_environment.h"
+
+namespace Kernel {
+
+TEST_CASE("ThreadManager::Reschedule picks the highest priority ready thread", "[core][kernel]") {
+    SchedulerEnvironment env;
+    auto low = env.CreateThread(40);
+    auto high = env.CreateThread(20);
+    auto middle = env.CreateThread(30);
+
+    env.Manager().Reschedule();
+    REQUIRE(env.Manager().GetCurrentThread() == high.get());
+
+    // A running thread keeps the core unless a better thread becomes ready.
+    env.Manager().Reschedule();
+    REQUIRE(env.Manager().GetCurrentThread() == high.get());
+
+    REQUIRE(env.SleepAndReschedule() == middle.get());
+    high->ResumeFromWait();
+    env.Manager().Reschedule();
+    REQUIRE(env.Manager().GetCurrentThread() == high.get());
+    REQUIRE(middle->status == ThreadStatus::Ready);
+
+    REQUIRE(env.SleepAndReschedule() == middle.get());
+    REQUIRE(env.SleepAndReschedule() == low.get());
+    REQUIRE(env.SleepAndReschedule() == nullptr);
+    REQUIRE_FALSE(env.Manager().HaveReadyThreads());
+}
+
+TEST_CASE("ThreadManager::Reschedule rotates threads of the same priority", "[core][kernel]") {
+    SchedulerEnvironment env;
+    std::vector<std::shared_ptr<Thread>> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.push_back(env.CreateThread(30));
+    }
+
+    env.Manager().Reschedule();
+    for (int i = 0; i < 6; ++i) {
+        Thread* current = env.Manager().GetCurrentThread();
+        REQUIRE(current == threads[i % 3].get());
+        env.SleepAndReschedule();
+        current->ResumeFromWait();
+    }
+}
+
+TEST_CASE("Thread::SetPriority requeues ready threads", "[core][kernel]") {
+    SchedulerEnvironment env;
+    auto first = env.CreateThread(30);
+    auto second = env.CreateThread(30);
+    auto third = env.CreateThread(40);
+
+    third->SetPriority(20);
+    env.Manager().Reschedule();
+    REQUIRE(env.Manager().GetCurrentThread() == third.get());
+
+    first->SetPriority(35);
+    REQUIRE(env.SleepAndReschedule() == second.get());
+    REQUIRE(env.SleepAndReschedule() == first.get());
+}
+
+TEST_CASE("Thread::Stop removes a ready thread from the ready queue", "[core][kernel]") {
+    SchedulerEnvironment env;
+    auto stopped = env.CreateThread(20);
+    auto other = env.CreateThread(30);
+
+    stopped->Stop();
+    env.Manager().Reschedule();
+    REQUIRE(env.Manager().GetCurrentThread() == other.get());
+    REQUIRE(env.SleepAndReschedule() == nullptr);
+}
+
+} // namespace Kernel
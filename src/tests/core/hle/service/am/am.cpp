@@ -0,0 +1,51 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/service/am/am.h"
+#include "tests/core/hle/service/am/install_environment.h"
+
+namespace Service::AM {
+
+TEST_CASE("InstallCIA writes verified content", "[core][am]") {
+    InstallEnvironment env;
+    std::mt19937 rng(7);
+    // Contents spanning several read chunks, not ending on a chunk boundary
+    const std::vector<std::vector<u8>> contents{
+        RandomContent(5 * 1024 * 1024 + 0x1230, rng),
+        RandomContent(0x4560, rng),
+    };
+    const auto cia = BuildCIA(contents);
+    env.WriteCIA(cia);
+
+    std::size_t last_progress = 0;
+    const auto status = InstallCIA(env.cia_path, [&](std::size_t written, std::size_t total) {
+        REQUIRE(written > last_progress);
+        REQUIRE(total == cia.size());
+        last_progress = written;
+    });
+    REQUIRE(status == InstallStatus::Success);
+    REQUIRE(last_progress == cia.size());
+
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        REQUIRE(env.ReadContent(i) == contents[i]);
+    }
+}
+
+TEST_CASE("InstallCIA keeps content with a wrong hash", "[core][am]") {
+    InstallEnvironment env;
+    std::mt19937 rng(7);
+    auto content = RandomContent(0x10000, rng);
+    auto cia = BuildCIA({content});
+    cia.back() ^= 0xFF;
+    content.back() ^= 0xFF;
+    env.WriteCIA(cia);
+
+    REQUIRE(InstallCIA(env.cia_path) == InstallStatus::Success);
+    REQUIRE(env.ReadContent(0) == content);
+}
+
+} // namespace Service::AM
@@ -0,0 +1,127 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/sha.h>
+#include "common/alignment.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "core/file_sys/cia_common.h"
+#include "core/file_sys/cia_container.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+
+namespace Service::AM {
+
+inline constexpr u64 TestTitleId = 0x000400000F800100;
+
+template <typename T>
+inline void Append(std::vector<u8>& data, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+/// Appends an empty RSA-2048 signature, padded up to the start of the signed body.
+inline void AppendSignature(std::vector<u8>& data) {
+    Append(data, u32_be{FileSys::Rsa2048Sha256});
+    data.resize(data.size() + Common::AlignUp(0x100 + sizeof(u32), 0x40) - sizeof(u32));
+}
+
+/// Builds an unencrypted CIA holding the given contents.
+inline std::vector<u8> BuildCIA(const std::vector<std::vector<u8>>& contents) {
+    std::vector<u8> ticket;
+    AppendSignature(ticket);
+    FileSys::Ticket::Body ticket_body{};
+    ticket_body.title_id = TestTitleId;
+    Append(ticket, ticket_body);
+
+    std::vector<u8> tmd;
+    AppendSignature(tmd);
+    FileSys::TitleMetadata::Body tmd_body{};
+    tmd_body.title_id = TestTitleId;
+    tmd_body.content_count = static_cast<u16>(contents.size());
+    Append(tmd, tmd_body);
+
+    FileSys::CIAContainer::Header header{};
+    header.header_size = sizeof(header);
+    header.tik_size = static_cast<u32>(ticket.size());
+    header.tmd_size = static_cast<u32>(tmd.size());
+    for (u16 i = 0; i < contents.size(); ++i) {
+        FileSys::TitleMetadata::ContentChunk chunk{};
+        chunk.id = i;
+        chunk.index = i;
+        chunk.size = contents[i].size();
+        CryptoPP::SHA256().CalculateDigest(chunk.hash.data(), contents[i].data(),
+                                           contents[i].size());
+        Append(tmd, chunk);
+
+        header.SetContentPresent(i);
+        header.content_size += contents[i].size();
+    }
+
+    std::vector<u8> cia;
+    const auto append_section = [&cia](const std::vector<u8>& section) {
+        cia.insert(cia.end(), section.begin(), section.end());
+        cia.resize(Common::AlignUp(cia.size(), FileSys::CIA_SECTION_ALIGNMENT));
+    };
+    Append(cia, header);
+    cia.resize(Common::AlignUp(cia.size(), FileSys::CIA_SECTION_ALIGNMENT));
+    append_section(ticket);
+    append_section(tmd);
+    for (const auto& content : contents) {
+        cia.insert(cia.end(), content.begin(), content.end());
+    }
+    return cia;
+}
+
+inline std::vector<u8> RandomContent(std::size_t size, std::mt19937& rng) {
+    std::vector<u8> content(size);
+    for (auto& byte : content) {
+        byte = static_cast<u8>(rng());
+    }
+    return content;
+}
+
+/// Redirects the SD card to a temporary directory holding the CIA to install.
+struct InstallEnvironment {
+    InstallEnvironment() : old_sdmc_path{FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir)} {
+        const auto temp_dir = std::filesystem::temp_directory_path() / "citra_am_test";
+        sdmc_path = (temp_dir / "sdmc").string();
+        cia_path = (temp_dir / "test.cia").string();
+        FileUtil::CreateFullPath(sdmc_path + DIR_SEP);
+        FileUtil::UpdateUserPath(FileUtil::UserPath::SDMCDir, sdmc_path);
+    }
+
+    ~InstallEnvironment() {
+        FileUtil::UpdateUserPath(FileUtil::UserPath::SDMCDir, old_sdmc_path);
+        FileUtil::DeleteDirRecursively(sdmc_path);
+        FileUtil::Delete(cia_path);
+    }
+
+    void WriteCIA(const std::vector<u8>& cia) const {
+        FileUtil::IOFile file(cia_path, "wb");
+        REQUIRE(file.WriteBytes(cia.data(), cia.size()) == cia.size());
+    }
+
+    std::vector<u8> ReadContent(std::size_t index) const {
+        std::vector<u8> content;
+        FileUtil::IOFile file(GetTitleContentPath(FS::MediaType::SDMC, TestTitleId, index), "rb");
+        content.resize(file.GetSize());
+        file.ReadBytes(content.data(), content.size());
+        return content;
+    }
+
+    std::string old_sdmc_path;
+    std::string sdmc_path;
+    std::string cia_path;
+};
+
+} // namespace Service::AM
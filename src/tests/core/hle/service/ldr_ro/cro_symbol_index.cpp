@@ -0,0 +1,105 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/service/ldr_ro/cro_symbol_index.h"
+
+namespace Service::LDR {
+
+namespace {
+
+using ExportList = std::vector<std::pair<std::string, VAddr>>;
+
+/// Auto-link modules by address, standing in for the export tables in guest memory
+struct ModuleList {
+    /// Resolves a symbol the way linking without an index does: the first module in list order
+    /// exporting it wins.
+    std::pair<VAddr, VAddr> Walk(const std::string& name) const {
+        for (const VAddr module_address : order) {
+            for (const auto& [export_name, symbol_address] : modules.at(module_address)) {
+                if (export_name == name) {
+                    return {module_address, symbol_address};
+                }
+            }
+        }
+        return {0, 0};
+    }
+
+    void Sync(CROSymbolIndex& index) {
+        index.Sync(order, [this](VAddr module_address) {
+            reads.push_back(module_address);
+            return modules.at(module_address);
+        });
+    }
+
+    std::map<VAddr, ExportList> modules;
+    std::vector<VAddr> order;
+    std::vector<VAddr> reads; ///< Modules whose exports the index read, in order
+};
+
+const std::vector<std::string> SymbolNames{
+    "nnroAeabiAtexit_", "nnroControlObject_", "main", "shared", "local", "missing",
+};
+
+void RequireMatchesWalk(const CROSymbolIndex& index, const ModuleList& list) {
+    for (const auto& name : SymbolNames) {
+        const auto [module_address, symbol_address] = list.Walk(name);
+        const auto* symbol = index.Find(name);
+        if (symbol_address == 0) {
+            REQUIRE(symbol == nullptr);
+            continue;
+        }
+        REQUIRE(symbol != nullptr);
+        REQUIRE(symbol->module_address == module_address);
+        REQUIRE(symbol->symbol_address == symbol_address);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CROSymbolIndex resolves symbols like the module list walk", "[core][ldr_ro]") {
+    ModuleList list;
+    list.modules = {
+        {0x1000, {{"nnroControlObject_", 0x1100}, {"main", 0x1200}}},
+        {0x2000, {{"nnroAeabiAtexit_", 0x2100}, {"shared", 0x2200}}},
+        {0x3000, {{"shared", 0x3200}, {"local", 0x3300}, {"nnroAeabiAtexit_", 0x3100}}},
+    };
+    list.order = {0x1000, 0x2000, 0x3000};
+
+    CROSymbolIndex index;
+    list.Sync(index);
+    RequireMatchesWalk(index, list);
+    REQUIRE(index.FindInModule(0x3000, "shared") == 0x3200);
+    REQUIRE(index.FindInModule(0x3000, "main") == 0);
+    REQUIRE(!index.FindInModule(0x4000, "main"));
+
+    SECTION("unchanged list") {
+        list.reads.clear();
+        list.Sync(index);
+        REQUIRE(list.reads.empty());
+    }
+    SECTION("module unloaded") {
+        list.order = {0x1000, 0x3000};
+        list.reads.clear();
+        list.Sync(index);
+        REQUIRE(list.reads.empty());
+        RequireMatchesWalk(index, list);
+    }
+    SECTION("module loaded at the address of an unloaded one") {
+        list.order = {0x1000, 0x3000};
+        list.Sync(index);
+        list.modules[0x2000] = {{"shared", 0x2400}, {"missing", 0x2500}};
+        list.order = {0x1000, 0x3000, 0x2000};
+        list.reads.clear();
+        list.Sync(index);
+        REQUIRE(list.reads == std::vector<VAddr>{0x2000});
+        RequireMatchesWalk(index, list);
+    }
+}
+
+} // namespace Service::LDR
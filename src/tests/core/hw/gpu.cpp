@@ -0,0 +1,316 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/color.h"
+#include "common/thread_worker.h"
+#include "common/vector_math.h"
+#include "core/hw/gpu.h"
+#include "video_core/utils.h"
+
+namespace GPU {
+
+namespace {
+
+using PixelFormat = Regs::PixelFormat;
+using DisplayTransferConfig = Regs::DisplayTransferConfig;
+
+constexpr PixelFormat PixelFormats[] = {
+    PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565, PixelFormat::RGB5A1,
+    PixelFormat::RGBA4,
+};
+
+/// Bytes past the end of every buffer, to catch reads and writes running over.
+constexpr std::size_t BufferSlack = 64;
+
+std::vector<u8> RandomBytes(std::size_t size, u32 seed) {
+    std::mt19937 rng(seed);
+    std::vector<u8> bytes(size);
+    std::generate(bytes.begin(), bytes.end(), [&rng] { return static_cast<u8>(rng()); });
+    return bytes;
+}
+
+Common::Vec4<u8> ReferenceDecodePixel(PixelFormat input_format, const u8* src_pixel) {
+    switch (input_format) {
+    case PixelFormat::RGBA8:
+        return Common::Color::DecodeRGBA8(src_pixel);
+    case PixelFormat::RGB8:
+        return Common::Color::DecodeRGB8(src_pixel);
+    case PixelFormat::RGB565:
+        return Common::Color::DecodeRGB565(src_pixel);
+    case PixelFormat::RGB5A1:
+        return Common::Color::DecodeRGB5A1(src_pixel);
+    default:
+        return Common::Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+/// The display transfer as it was originally implemented, one pixel at a time.
+void ReferenceDisplayTransfer(const DisplayTransferConfig& config, const u8* src_pointer,
+                              u8* dst_pointer) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u32 input_y = y << vertical_scale;
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 src_offset;
+            u32 dst_offset;
+            if (config.input_linear) {
+                src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                }
+            } else {
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                             (input_y & ~7) * config.input_width * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                }
+            }
+
+            const u8* src_pixel = src_pointer + src_offset;
+            Common::Vec4<u8> src_color = ReferenceDecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                const Common::Vec4<u8> pixel =
+                    ReferenceDecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                const Common::Vec4<u8> pixel1 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
+                const Common::Vec4<u8> pixel2 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                const Common::Vec4<u8> pixel3 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            u8* dst_pixel = dst_pointer + dst_offset;
+            switch (config.output_format) {
+            case PixelFormat::RGBA8:
+                Common::Color::EncodeRGBA8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB8:
+                Common::Color::EncodeRGB8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB565:
+                Common::Color::EncodeRGB565(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB5A1:
+                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
+                break;
+            default:
+                Common::Color::EncodeRGBA4(src_color, dst_pixel);
+                break;
+            }
+        }
+    }
+}
+
+/// The memory fill as it was originally implemented, one value at a time.
+void ReferenceMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    if (config.fill_24bit) {
+        for (u8* ptr = start; ptr < end; ptr += 3) {
+            ptr[0] = static_cast<u8>(config.value_24bit_r);
+            ptr[1] = static_cast<u8>(config.value_24bit_g);
+            ptr[2] = static_cast<u8>(config.value_24bit_b);
+        }
+    } else if (config.fill_32bit) {
+        const u32 value = config.value_32bit;
+        const std::size_t len = (end - start) / sizeof(u32);
+        for (std::size_t i = 0; i < len; ++i) {
+            std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
+        }
+    } else {
+        const u16 value_16bit = config.value_16bit.Value();
+        for (u8* ptr = start; ptr < end; ptr += sizeof(u16)) {
+            std::memcpy(ptr, &value_16bit, sizeof(u16));
+        }
+    }
+}
+
+/// The texture copy one byte at a time, skipping the gaps after each input and output line.
+void ReferenceTextureCopy(const DisplayTransferConfig& config, const u8* src, u8* dst) {
+    const u32 size = config.texture_copy.size & ~0xF;
+    const u32 input_width = config.texture_copy.input_width * 16;
+    const u32 input_gap = config.texture_copy.input_gap * 16;
+    const u32 output_width = config.texture_copy.output_width * 16;
+    const u32 output_gap = config.texture_copy.output_gap * 16;
+
+    for (u32 i = 0; i < size; ++i) {
+        const u32 src_offset =
+            input_gap == 0 ? i : i / input_width * (input_width + input_gap) + i % input_width;
+        const u32 dst_offset =
+            output_gap == 0 ? i : i / output_width * (output_width + output_gap) + i % output_width;
+        dst[dst_offset] = src[src_offset];
+    }
+}
+
+DisplayTransferConfig MakeTransfer(PixelFormat input_format, PixelFormat output_format, u32 width,
+                                   u32 height) {
+    DisplayTransferConfig config{};
+    config.input_width.Assign(width);
+    config.input_height.Assign(height);
+    config.output_width.Assign(width);
+    config.output_height.Assign(height);
+    config.input_format.Assign(input_format);
+    config.output_format.Assign(output_format);
+    return config;
+}
+
+std::size_t OutputSize(const DisplayTransferConfig& config) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    return (config.output_width >> horizontal_scale) * (config.output_height >> vertical_scale) *
+           Regs::BytesPerPixel(config.output_format);
+}
+
+/// Transfers between separate buffers and checks the output against the reference transfer.
+void CheckDisplayTransfer(const DisplayTransferConfig& config,
+                          Common::ThreadWorker* workers = nullptr) {
+    const std::size_t input_size = config.input_width * config.input_height *
+                                   Regs::BytesPerPixel(config.input_format);
+    const auto src = RandomBytes(input_size + BufferSlack, 1);
+    auto dst = RandomBytes(OutputSize(config) + BufferSlack, 2);
+    auto expected = dst;
+
+    PerformDisplayTransfer(config, src.data(), dst.data(), workers);
+    ReferenceDisplayTransfer(config, src.data(), expected.data());
+    REQUIRE(dst == expected);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GPU::DisplayTransfer matches the per pixel transfer", "[core][gpu]") {
+    for (const PixelFormat input_format : PixelFormats) {
+        for (const PixelFormat output_format : PixelFormats) {
+            for (const auto scaling : {DisplayTransferConfig::NoScale,
+                                       DisplayTransferConfig::ScaleX,
+                                       DisplayTransferConfig::ScaleXY}) {
+                for (const u32 input_linear : {0U, 1U}) {
+                    // Scaling is only implemented on tiled input
+                    if (input_linear && scaling != DisplayTransferConfig::NoScale) {
+                        continue;
+                    }
+                    for (const u32 dont_swizzle : {0U, 1U}) {
+                        for (const u32 flip_vertically : {0U, 1U}) {
+                            auto config = MakeTransfer(input_format, output_format, 64, 48);
+                            config.scaling.Assign(scaling);
+                            config.input_linear.Assign(input_linear);
+                            config.dont_swizzle.Assign(dont_swizzle);
+                            config.flip_vertically.Assign(flip_vertically);
+                            CheckDisplayTransfer(config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("GPU::DisplayTransfer on worker threads matches the per pixel transfer",
+          "[core][gpu]") {
+    Common::ThreadWorker workers(3, "GPU test");
+
+    // Large enough to be split across the workers
+    for (const PixelFormat input_format : PixelFormats) {
+        for (const PixelFormat output_format : PixelFormats) {
+            for (const u32 input_linear : {0U, 1U}) {
+                auto config = MakeTransfer(input_format, output_format, 256, 256);
+                config.input_linear.Assign(input_linear);
+                config.flip_vertically.Assign(input_linear);
+                CheckDisplayTransfer(config, &workers);
+            }
+        }
+    }
+
+    for (const auto scaling : {DisplayTransferConfig::ScaleX, DisplayTransferConfig::ScaleXY}) {
+        auto config = MakeTransfer(PixelFormat::RGBA8, PixelFormat::RGB8, 512, 512);
+        config.scaling.Assign(scaling);
+        CheckDisplayTransfer(config, &workers);
+    }
+}
+
+TEST_CASE("GPU::DisplayTransfer in place matches the per pixel transfer", "[core][gpu]") {
+    for (const PixelFormat input_format : PixelFormats) {
+        for (const PixelFormat output_format : PixelFormats) {
+            for (const std::size_t dst_offset : {std::size_t{0}, std::size_t{256}}) {
+                auto config = MakeTransfer(input_format, output_format, 64, 48);
+                auto buffer = RandomBytes(64 * 48 * 4 + dst_offset + BufferSlack, 3);
+                auto expected = buffer;
+
+                PerformDisplayTransfer(config, buffer.data(), buffer.data() + dst_offset);
+                ReferenceDisplayTransfer(config, expected.data(), expected.data() + dst_offset);
+                REQUIRE(buffer == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("GPU::MemoryFill matches the per value fill", "[core][gpu]") {
+    for (const u32 control : {0x000U, 0x100U, 0x200U}) {
+        for (const std::size_t size : {1, 2, 3, 4, 5, 6, 7, 8, 100, 0x1000, 0x1001, 0x12345}) {
+            Regs::MemoryFillConfig config{};
+            config.control = control;
+            config.value_32bit = 0x89ABCDEF;
+
+            auto buffer = RandomBytes(size + BufferSlack, 4);
+            auto expected = buffer;
+
+            PerformMemoryFill(config, buffer.data(), buffer.data() + size);
+            ReferenceMemoryFill(config, expected.data(), expected.data() + size);
+            REQUIRE(buffer == expected);
+        }
+    }
+}
+
+TEST_CASE("GPU::TextureCopy matches the per byte copy", "[core][gpu]") {
+    struct Copy {
+        u32 size;
+        u32 input_width, input_gap;
+        u32 output_width, output_gap;
+    };
+    constexpr Copy Copies[] = {
+        {0x1000, 0, 0, 0, 0},   {0x100F, 4, 0, 0, 0}, {0x1000, 4, 2, 0, 0},
+        {0x1000, 0, 0, 3, 5},   {0x1000, 4, 2, 3, 1}, {0x1230, 7, 1, 5, 3},
+    };
+
+    for (const Copy& copy : Copies) {
+        DisplayTransferConfig config{};
+        config.is_texture_copy.Assign(1);
+        config.texture_copy.size = copy.size;
+        config.texture_copy.input_width.Assign(copy.input_width);
+        config.texture_copy.input_gap.Assign(copy.input_gap);
+        config.texture_copy.output_width.Assign(copy.output_width);
+        config.texture_copy.output_gap.Assign(copy.output_gap);
+
+        // The gaps at most triple the size of the copied range
+        const auto src = RandomBytes(copy.size * 3 + BufferSlack, 5);
+        auto dst = RandomBytes(copy.size * 3 + BufferSlack, 6);
+        auto expected = dst;
+
+        PerformTextureCopy(config, src.data(), dst.data());
+        ReferenceTextureCopy(config, src.data(), expected.data());
+        REQUIRE(dst == expected);
+    }
+}
+
+} // namespace GPU
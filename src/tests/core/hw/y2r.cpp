@@ -0,0 +1,43 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_worker.h"
+#include "core/hw/y2r.h"
+#include "tests/core/hw/y2r_environment.h"
+
+namespace HW::Y2R {
+
+TEST_CASE("HW::Y2R conversion matches the per pixel conversion", "[core][y2r]") {
+    Y2REnvironment env;
+    for (const InputFormat input_format : InputFormats) {
+        for (const auto block_alignment : {BlockAlignment::Linear, BlockAlignment::Block8x8}) {
+            auto cvt = env.MakeConfiguration(input_format, OutputFormat::RGBA8, 64, 48);
+            cvt.block_alignment = block_alignment;
+            REQUIRE(env.Convert(cvt) == env.ReferenceConvert(cvt));
+        }
+    }
+}
+
+TEST_CASE("HW::Y2R conversion on worker threads matches the calling thread", "[core][y2r]") {
+    Y2REnvironment env;
+    Common::ThreadWorker workers(3, "Y2R test");
+
+    for (const InputFormat input_format : InputFormats) {
+        for (const auto output_format : {OutputFormat::RGBA8, OutputFormat::RGB8,
+                                         OutputFormat::RGB5A1, OutputFormat::RGB565}) {
+            for (const auto rotation : {Rotation::None, Rotation::Clockwise_90,
+                                        Rotation::Clockwise_180, Rotation::Clockwise_270}) {
+                for (const auto alignment : {BlockAlignment::Linear, BlockAlignment::Block8x8}) {
+                    auto cvt = env.MakeConfiguration(input_format, output_format, 96, 80);
+                    cvt.rotation = rotation;
+                    cvt.block_alignment = alignment;
+                    REQUIRE(env.Convert(cvt, &workers) == env.Convert(cvt));
+                }
+            }
+        }
+    }
+}
+
+} // namespace HW::Y2R
@@ -0,0 +1,153 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include "common/thread_worker.h"
+#include "core/hle/service/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "tests/core/hle/kernel/kernel_environment.h"
+
+namespace HW::Y2R {
+
+using namespace Service::Y2R;
+
+inline constexpr VAddr BufferAddress = Memory::HEAP_VADDR;
+inline constexpr u32 BufferSize = 0x400000;
+inline constexpr VAddr YAddress = BufferAddress;
+inline constexpr VAddr UAddress = BufferAddress + 0x100000;
+inline constexpr VAddr VAddress = BufferAddress + 0x180000;
+inline constexpr VAddr OutputAddress = BufferAddress + 0x200000;
+
+// ITU Rec. BT.601 with PC ranges
+inline constexpr CoefficientSet Coefficients = {0x100, 0x166,   0xB6,   0x58,
+                                                0x1C5, -0x166F, 0x10EE, -0x1C5B};
+
+/// A process with a buffer holding the Y2R input and output planes.
+struct Y2REnvironment : Kernel::KernelEnvironment {
+    Y2REnvironment() {
+        process = CreateCurrentProcess();
+        buffer = MapBuffer(*process, BufferAddress, BufferSize);
+
+        std::mt19937 rng(42);
+        std::generate_n(buffer->GetPtr(), OutputAddress - BufferAddress, [&rng] {
+            return static_cast<u8>(rng());
+        });
+    }
+
+    ConversionConfiguration MakeConfiguration(InputFormat input_format, OutputFormat output_format,
+                                              u16 width, u16 height) const {
+        ConversionConfiguration cvt{};
+        cvt.input_format = input_format;
+        cvt.output_format = output_format;
+        cvt.input_line_width = width;
+        cvt.input_lines = height;
+        cvt.coefficients = Coefficients;
+        cvt.alpha = 0xFF;
+
+        const bool is_16bit = input_format == InputFormat::YUV422_Indiv16 ||
+                              input_format == InputFormat::YUV420_Indiv16;
+        const u16 sample_size = is_16bit ? 2 : 1;
+        cvt.src_Y = {YAddress, 0, static_cast<u16>(width * sample_size), 0};
+        cvt.src_U = {UAddress, 0, static_cast<u16>(width / 2 * sample_size), 0};
+        cvt.src_V = {VAddress, 0, static_cast<u16>(width / 2 * sample_size), 0};
+        cvt.src_YUYV = {YAddress, 0, static_cast<u16>(width * 2), 0};
+        cvt.dst = {OutputAddress, 0, static_cast<u16>(width * BytesPerPixel(output_format)), 0};
+        return cvt;
+    }
+
+    static u16 BytesPerPixel(OutputFormat output_format) {
+        switch (output_format) {
+        case OutputFormat::RGBA8:
+            return 4;
+        case OutputFormat::RGB8:
+            return 3;
+        default:
+            return 2;
+        }
+    }
+
+    /// Runs a conversion and returns the output image.
+    std::vector<u8> Convert(ConversionConfiguration cvt, Common::ThreadWorker* workers = nullptr) {
+        const std::size_t size = static_cast<std::size_t>(cvt.input_line_width) *
+                                 cvt.input_lines * BytesPerPixel(cvt.output_format);
+        u8* output = memory.GetPointer(OutputAddress);
+        std::memset(output, 0, size);
+        PerformConversion(memory, cvt, workers);
+        return std::vector<u8>(output, output + size);
+    }
+
+    /// Straightforward per pixel YUV to RGBA8 conversion of an unrotated image.
+    std::vector<u8> ReferenceConvert(const ConversionConfiguration& cvt) {
+        const u8* plane_Y = memory.GetPointer(YAddress);
+        const u8* plane_U = memory.GetPointer(UAddress);
+        const u8* plane_V = memory.GetPointer(VAddress);
+        const unsigned int width = cvt.input_line_width;
+        const unsigned int sample_size = cvt.input_format == InputFormat::YUV422_Indiv16 ||
+                                                 cvt.input_format == InputFormat::YUV420_Indiv16
+                                             ? 2
+                                             : 1;
+
+        std::vector<u8> output(width * cvt.input_lines * 4);
+        for (unsigned int y = 0; y < cvt.input_lines; ++y) {
+            for (unsigned int x = 0; x < width; ++x) {
+                s32 Y, U, V;
+                switch (cvt.input_format) {
+                case InputFormat::YUYV422_Interleaved:
+                    Y = plane_Y[(y * width + x) * 2];
+                    U = plane_Y[(y * width + x / 2 * 2) * 2 + 1];
+                    V = plane_Y[(y * width + x / 2 * 2) * 2 + 3];
+                    break;
+                case InputFormat::YUV420_Indiv8:
+                case InputFormat::YUV420_Indiv16:
+                    Y = plane_Y[(y * width + x) * sample_size];
+                    U = plane_U[(y / 2 * width / 2 + x / 2) * sample_size];
+                    V = plane_V[(y / 2 * width / 2 + x / 2) * sample_size];
+                    break;
+                default:
+                    Y = plane_Y[(y * width + x) * sample_size];
+                    U = plane_U[(y * width / 2 + x / 2) * sample_size];
+                    V = plane_V[(y * width / 2 + x / 2) * sample_size];
+                    break;
+                }
+
+                const auto& c = cvt.coefficients;
+                const s32 r = ((c[0] * Y + c[1] * V) >> 3) + c[5] + 0x18;
+                const s32 g = ((c[0] * Y - c[2] * V - c[3] * U) >> 3) + c[6] + 0x18;
+                const s32 b = ((c[0] * Y + c[4] * U) >> 3) + c[7] + 0x18;
+
+                std::size_t index = y * width + x;
+                if (cvt.block_alignment == BlockAlignment::Block8x8) {
+                    std::size_t morton = 0;
+                    for (unsigned int bit = 0; bit < 3; ++bit) {
+                        morton |= ((x >> bit) & 1) << (bit * 2);
+                        morton |= ((y >> bit) & 1) << (bit * 2 + 1);
+                    }
+                    index = ((y / 8) * (width / 8) + x / 8) * 64 + morton;
+                }
+                u8* pixel = &output[index * 4];
+                pixel[0] = static_cast<u8>(cvt.alpha);
+                pixel[1] = static_cast<u8>(std::clamp(b >> 5, 0, 0xFF));
+                pixel[2] = static_cast<u8>(std::clamp(g >> 5, 0, 0xFF));
+                pixel[3] = static_cast<u8>(std::clamp(r >> 5, 0, 0xFF));
+            }
+        }
+        return output;
+    }
+
+    std::shared_ptr<Kernel::Process> process;
+    std::shared_ptr<BufferMem> buffer;
+};
+
+inline constexpr InputFormat InputFormats[] = {
+    InputFormat::YUV422_Indiv8,  InputFormat::YUV420_Indiv8,       InputFormat::YUV422_Indiv16,
+    InputFormat::YUV420_Indiv16, InputFormat::YUYV422_Interleaved,
+};
+
+} // namespace HW::Y2R
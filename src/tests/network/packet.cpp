@@ -0,0 +1,82 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+#include "network/packet.h"
+
+namespace Network {
+
+TEST_CASE("Packet round-trips values", "[network]") {
+    const std::vector<u8> payload{0x00, 0x01, 0x7F, 0x80, 0xFF};
+    const std::array<u8, 6> mac{0x00, 0x1F, 0x32, 0xAB, 0xCD, 0xEF};
+    const std::vector<u32> words{0x12345678, 0x9ABCDEF0};
+
+    Packet packet;
+    packet << static_cast<u8>(7) << static_cast<u32>(0xDEADBEEF) << std::string("citra") << mac
+           << payload << words;
+
+    SECTION("owning packet") {
+        Packet copy;
+        copy.Append(packet.GetData(), packet.GetDataSize());
+
+        u8 id;
+        u32 value;
+        std::string name;
+        std::array<u8, 6> mac_out;
+        std::vector<u8> payload_out;
+        std::vector<u32> words_out;
+        copy >> id >> value >> name >> mac_out >> payload_out >> words_out;
+
+        REQUIRE(copy);
+        REQUIRE(copy.EndOfPacket());
+        REQUIRE(id == 7);
+        REQUIRE(value == 0xDEADBEEF);
+        REQUIRE(name == "citra");
+        REQUIRE(mac_out == mac);
+        REQUIRE(payload_out == payload);
+        REQUIRE(words_out == words);
+    }
+
+    SECTION("view packet") {
+        Packet view = Packet::View(packet.GetData(), packet.GetDataSize());
+        REQUIRE(view.GetData() == packet.GetData());
+
+        u8 id;
+        u32 value;
+        std::string name;
+        std::array<u8, 6> mac_out;
+        std::vector<u8> payload_out;
+        std::vector<u32> words_out;
+        view >> id >> value >> name >> mac_out >> payload_out >> words_out;
+
+        REQUIRE(view);
+        REQUIRE(view.EndOfPacket());
+        REQUIRE(id == 7);
+        REQUIRE(value == 0xDEADBEEF);
+        REQUIRE(name == "citra");
+        REQUIRE(mac_out == mac);
+        REQUIRE(payload_out == payload);
+        REQUIRE(words_out == words);
+    }
+
+    SECTION("truncated byte vector is rejected") {
+        Packet view = Packet::View(packet.GetData(), packet.GetDataSize() - 15);
+
+        u8 id;
+        u32 value;
+        std::string name;
+        std::array<u8, 6> mac_out;
+        std::vector<u8> payload_out;
+        view >> id >> value >> name >> mac_out >> payload_out;
+
+        REQUIRE(!view);
+        REQUIRE(payload_out.empty());
+    }
+}
+
+} // namespace Network
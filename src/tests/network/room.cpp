@@ -0,0 +1,166 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+#include "network/network.h"
+#include "network/network_settings.h"
+#include "network/room.h"
+#include "network/room_member.h"
+#include "network/verify_user.h"
+
+namespace {
+
+constexpr u16 LoadTestPort = 24873;
+constexpr auto LoadTestTimeout = std::chrono::seconds(30);
+
+template <typename Predicate>
+bool WaitFor(Predicate&& predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + LoadTestTimeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+// Load test for the room server against localhost. It is hidden from the default run because it
+// opens sockets and takes several seconds; run it with `tests "[room]"`.
+TEST_CASE("Room relays broadcast wifi packets to many members", "[.][room]") {
+    constexpr u32 NumMembers = 64;
+    constexpr u32 PacketsPerMember = 100;
+
+    REQUIRE(Network::Init());
+
+    Network::Room room;
+    REQUIRE(room.Create("Load test", "", "127.0.0.1", LoadTestPort, "", NumMembers, "", "", 0,
+                        std::make_unique<Network::VerifyUser::NullBackend>()));
+
+    std::atomic<u32> received{0};
+    std::vector<std::unique_ptr<Network::RoomMember>> members;
+    for (u32 i = 0; i < NumMembers; ++i) {
+        auto& member = members.emplace_back(std::make_unique<Network::RoomMember>());
+        member->BindOnWifiPacketReceived([&received](const Network::WifiPacket&) { ++received; });
+        member->Join(fmt::format("member{:04}", i), fmt::format("{:016X}", i), "127.0.0.1",
+                     LoadTestPort);
+    }
+
+    REQUIRE(WaitFor([&members] {
+        return std::all_of(members.begin(), members.end(), [](const auto& member) {
+            return member->GetState() == Network::RoomMember::State::Joined;
+        });
+    }));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < PacketsPerMember; ++i) {
+        for (auto& member : members) {
+            Network::WifiPacket packet{};
+            packet.type = Network::WifiPacket::PacketType::Data;
+            packet.data.resize(512);
+            packet.transmitter_address = member->GetMacAddress();
+            packet.destination_address = Network::BroadcastMac;
+            member->SendWifiPacket(packet);
+        }
+    }
+
+    constexpr u32 expected = NumMembers * PacketsPerMember * (NumMembers - 1);
+    REQUIRE(WaitFor([&received] { return received == expected; }));
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    WARN(fmt::format("Relayed {} packets to {} members in {:.3f}s ({:.0f} packets/s)", expected,
+                     NumMembers, elapsed.count(), expected / elapsed.count()));
+
+    for (auto& member : members) {
+        member->Leave();
+    }
+    room.Destroy();
+    Network::Shutdown();
+}
+
+TEST_CASE("Room members exchange wifi packets directly", "[.][room]") {
+    constexpr u32 NumMembers = 4;
+
+    REQUIRE(Network::Init());
+    NetSettings::values.enable_direct_connections = true;
+
+    Network::Room room;
+    REQUIRE(room.Create("Direct test", "", "127.0.0.1", LoadTestPort, "", NumMembers, "", "", 0,
+                        std::make_unique<Network::VerifyUser::NullBackend>(), {}, false, true));
+
+    std::array<std::atomic<u32>, NumMembers> received{};
+    std::vector<std::unique_ptr<Network::RoomMember>> members;
+    for (u32 i = 0; i < NumMembers; ++i) {
+        auto& member = members.emplace_back(std::make_unique<Network::RoomMember>());
+        member->BindOnWifiPacketReceived([&received, i](const Network::WifiPacket&) {
+            ++received[i];
+        });
+        member->Join(fmt::format("member{:04}", i), fmt::format("{:016X}", i), "127.0.0.1",
+                     LoadTestPort);
+    }
+
+    // Every member ends up directly connected to every other member
+    REQUIRE(WaitFor([&members] {
+        return std::all_of(members.begin(), members.end(), [](const auto& member) {
+            return member->GetDirectConnections().size() == NumMembers - 1;
+        });
+    }));
+
+    Network::WifiPacket packet{};
+    packet.type = Network::WifiPacket::PacketType::Data;
+    packet.data.resize(64);
+    packet.transmitter_address = members[0]->GetMacAddress();
+    packet.destination_address = members[1]->GetMacAddress();
+    members[0]->SendWifiPacket(packet);
+
+    packet.destination_address = Network::BroadcastMac;
+    members[0]->SendWifiPacket(packet);
+
+    REQUIRE(WaitFor([&received] {
+        return received[1] == 2 && received[2] == 1 && received[3] == 1;
+    }));
+    REQUIRE(received[0] == 0);
+
+    // Both frames went over the direct connections rather than through the room
+    const auto frames_to = [](u32 i) { return i == 1 ? 2U : 1U; };
+    for (const auto& connection : members[0]->GetDirectConnections()) {
+        const auto to = std::find_if(members.begin(), members.end(), [&connection](const auto& m) {
+            return m->GetMacAddress() == connection.mac_address;
+        });
+        REQUIRE(to != members.end());
+        REQUIRE(connection.frames_sent == frames_to(static_cast<u32>(to - members.begin())));
+        REQUIRE(connection.frames_received == 0);
+    }
+    for (u32 i = 1; i < NumMembers; ++i) {
+        const auto connections = members[i]->GetDirectConnections();
+        const auto from = std::find_if(
+            connections.begin(), connections.end(), [&members](const auto& connection) {
+                return connection.mac_address == members[0]->GetMacAddress();
+            });
+        REQUIRE(from != connections.end());
+        REQUIRE(from->frames_received == frames_to(i));
+    }
+
+    for (const auto& connection : members[0]->GetDirectConnections()) {
+        WARN(fmt::format("{:02X}: {}ms direct, {}ms through the room", connection.mac_address[5],
+                         connection.latency, members[0]->GetRoomLatency()));
+    }
+
+    for (auto& member : members) {
+        member->Leave();
+    }
+    room.Destroy();
+    NetSettings::values.enable_direct_connections = false;
+    Network::Shutdown();
+}
@@ -0,0 +1,254 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/alignment.h"
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_accelerated.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr PAddr VertexBase = Memory::VRAM_PADDR;
+constexpr u32 ByteCount = 6;
+constexpr u32 StrideAlignment = 4;
+constexpr u32 Stride = Common::AlignUp(ByteCount, StrideAlignment);
+
+/// An indexed draw from the vertex and index data at the given offsets from VertexBase
+struct GuestDraw {
+    u32 vertex_offset;
+    u32 index_offset;
+    std::vector<u16> indices;
+    bool index_u16 = true;
+    bool second_loader = false;
+};
+
+/// Accelerated rasterizer that resolves the host draws it issues to the vertices they read
+class TestRasterizer final : public RasterizerAccelerated {
+public:
+    explicit TestRasterizer(Memory::MemorySystem& memory) : RasterizerAccelerated{memory} {}
+
+    bool AccelerateDrawBatch(bool is_indexed) override {
+        vertex_info = AnalyzeVertexArray(is_indexed, StrideAlignment);
+        if (CanMergeDraw(is_indexed)) {
+            MergeDraw();
+            return true;
+        }
+        DrawPendingTriangles();
+
+        // Setting up the draw syncs the shader configurations and the LUTs
+        dirty_regs = DirtyRegs::None;
+        uniform_block_data.lighting_lut_dirty_any = false;
+        uniform_block_data.fog_lut_dirty = false;
+        uniform_block_data.proctex_noise_lut_dirty = false;
+        uniform_block_data.proctex_color_map_dirty = false;
+        uniform_block_data.proctex_alpha_map_dirty = false;
+        uniform_block_data.proctex_lut_dirty = false;
+        uniform_block_data.proctex_diff_lut_dirty = false;
+
+        // Upload the vertices of the first attribute loader with the aligned stride
+        const auto& vertex_attributes = regs.pipeline.vertex_attributes;
+        const u32 vertex_min = vertex_info.vs_input_index_min;
+        const u32 vertex_count = vertex_info.vs_input_index_max - vertex_min + 1;
+        const u8* vertex_data =
+            memory.GetPhysicalPointer(vertex_attributes.GetPhysicalBaseAddress() +
+                                      vertex_attributes.attribute_loaders[0].data_offset +
+                                      vertex_min * ByteCount);
+        HostDraw draw{
+            .vertex_offset = iterator,
+            .base_vertex = -static_cast<s64>(vertex_min),
+        };
+        for (u32 vertex = 0; vertex < vertex_count; ++vertex) {
+            std::memcpy(buffer.data() + iterator + vertex * Stride,
+                        vertex_data + vertex * ByteCount, ByteCount);
+        }
+        iterator += vertex_count * Stride;
+
+        const u8* index_data = memory.GetPhysicalPointer(
+            vertex_attributes.GetPhysicalBaseAddress() + regs.pipeline.index_array.offset);
+        for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
+            draw.indices.push_back(regs.pipeline.index_array.format != 0
+                                       ? reinterpret_cast<const u16*>(index_data)[index]
+                                       : index_data[index]);
+        }
+
+        if (HoldMergedDraw(is_indexed, StrideAlignment)) {
+            held_draw = std::move(draw);
+            return true;
+        }
+        Record(draw);
+        return true;
+    }
+
+    /// Vertex data read by each host draw, in the order of its indices
+    std::vector<std::vector<u8>> draws;
+
+    /// Moves the upload of the appended vertices to the start of the buffer
+    bool wrap_merged_upload = false;
+
+private:
+    struct HostDraw {
+        std::size_t vertex_offset;
+        s64 base_vertex;
+        std::vector<u32> indices;
+    };
+
+    void DrawMergedBatch() override {
+        if (merged_draw.draws == 1) {
+            Record(held_draw);
+            return;
+        }
+
+        if (wrap_merged_upload) {
+            iterator = 0;
+        }
+        const MergedUpload upload =
+            UploadMergedVertices(buffer.data() + iterator, iterator, held_draw.vertex_offset);
+        iterator += upload.size;
+
+        HostDraw draw{.vertex_offset = upload.base_offset, .base_vertex = 0};
+        draw.indices.resize(merged_draw.indices.size());
+        WriteMergedIndices(draw.indices.data(), upload);
+        Record(draw);
+    }
+
+    void Record(const HostDraw& draw) {
+        std::vector<u8> vertices;
+        for (const u32 index : draw.indices) {
+            const u8* vertex =
+                buffer.data() + draw.vertex_offset + (index + draw.base_vertex) * Stride;
+            vertices.insert(vertices.end(), vertex, vertex + ByteCount);
+        }
+        draws.push_back(std::move(vertices));
+    }
+
+    void DrawVertexBatch() override {}
+    bool IsRegionDirty(PAddr addr, u32 size) const override {
+        return false;
+    }
+    void TrackRegion(PAddr addr, u32 size, bool track) override {}
+    u64 GetWriteTick(PAddr addr, u32 size) const override {
+        return 0;
+    }
+    void SyncFixedState() override {}
+    void NotifyFixedFunctionPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void InvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void ClearAll(bool flush) override {}
+
+    std::vector<u8> buffer = std::vector<u8>(0x10000);
+    std::size_t iterator = 0x8000;
+    HostDraw held_draw{};
+};
+
+struct MergeEnvironment {
+    MergeEnvironment() {
+        auto& regs = Pica::g_state.regs;
+        regs.reg_array.fill(0);
+        regs.pipeline.vertex_attributes.base_address.Assign(VertexBase / 16);
+        regs.pipeline.triangle_topology.Assign(Pica::PipelineRegs::TriangleTopology::List);
+
+        std::mt19937 rng(0x5EED);
+        u8* vertex_data = memory.GetPhysicalPointer(VertexBase);
+        std::generate_n(vertex_data, 0x800, [&rng] { return static_cast<u8>(rng()); });
+    }
+
+    /// Sets up the registers and memory for draw and issues it
+    void Draw(const GuestDraw& draw) {
+        auto& pipeline = Pica::g_state.regs.pipeline;
+        for (std::size_t i = 0; i < 2; ++i) {
+            auto& loader = pipeline.vertex_attributes.attribute_loaders[i];
+            const bool enabled = i == 0 || draw.second_loader;
+            loader.data_offset.Assign(draw.vertex_offset + static_cast<u32>(i) * 0x200);
+            loader.byte_count.Assign(enabled ? ByteCount : 0);
+            loader.component_count.Assign(enabled ? 1 : 0);
+        }
+        pipeline.index_array.offset.Assign(draw.index_offset);
+        pipeline.index_array.format.Assign(draw.index_u16 ? pipeline.index_array.SHORT
+                                                          : pipeline.index_array.BYTE);
+        pipeline.num_vertices = static_cast<u32>(draw.indices.size());
+
+        u8* index_data = memory.GetPhysicalPointer(VertexBase + draw.index_offset);
+        for (std::size_t i = 0; i < draw.indices.size(); ++i) {
+            if (draw.index_u16) {
+                std::memcpy(index_data + i * sizeof(u16), &draw.indices[i], sizeof(u16));
+            } else {
+                index_data[i] = static_cast<u8>(draw.indices[i]);
+            }
+        }
+
+        REQUIRE(rasterizer.AccelerateDrawBatch(true));
+    }
+
+    /// Returns the vertex data draw reads from guest memory, in the order of its indices
+    std::vector<u8> Expected(const GuestDraw& draw) {
+        const u8* vertex_data = memory.GetPhysicalPointer(VertexBase + draw.vertex_offset);
+        std::vector<u8> vertices;
+        for (const u16 index : draw.indices) {
+            vertices.insert(vertices.end(), vertex_data + index * ByteCount,
+                            vertex_data + (index + 1) * ByteCount);
+        }
+        return vertices;
+    }
+
+    Memory::MemorySystem memory;
+    TestRasterizer rasterizer{memory};
+};
+
+std::vector<u8> Concat(std::vector<u8> a, const std::vector<u8>& b) {
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+const GuestDraw DrawA{0x000, 0x600, {0, 1, 2, 2, 1, 3}};
+const GuestDraw DrawB{0x040, 0x680, {7, 5, 6, 6, 5, 9}};
+
+} // Anonymous namespace
+
+TEST_CASE("RasterizerAccelerated merges draws with the same state", "[video_core]") {
+    MergeEnvironment env;
+    SECTION("appended vertices after the held back ones") {}
+    SECTION("appended vertices before the held back ones") {
+        env.rasterizer.wrap_merged_upload = true;
+    }
+
+    env.Draw(DrawA);
+    env.Draw(DrawB);
+    env.rasterizer.DrawPendingTriangles();
+
+    REQUIRE(env.rasterizer.draws.size() == 1);
+    REQUIRE(env.rasterizer.draws[0] == Concat(env.Expected(DrawA), env.Expected(DrawB)));
+}
+
+TEST_CASE("RasterizerAccelerated keeps draws apart", "[video_core]") {
+    MergeEnvironment env;
+    GuestDraw draw_b = DrawB;
+
+    env.Draw(DrawA);
+    SECTION("state change") {
+        Pica::g_state.regs.vs.max_input_attribute_index.Assign(1);
+    }
+    SECTION("index format change") {
+        draw_b.index_u16 = false;
+    }
+    SECTION("vertex data in separate buffers") {
+        draw_b.second_loader = true;
+    }
+    env.Draw(draw_b);
+    env.rasterizer.DrawPendingTriangles();
+
+    REQUIRE(env.rasterizer.draws.size() == 2);
+    REQUIRE(env.rasterizer.draws[0] == env.Expected(DrawA));
+    REQUIRE(env.rasterizer.draws[1] == env.Expected(draw_b));
+}
+
+} // namespace VideoCore
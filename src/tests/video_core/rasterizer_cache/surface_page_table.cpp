@@ -0,0 +1,55 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/rasterizer_cache/surface_page_table.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr PAddr VRAM = 0x18000000;
+constexpr PAddr FCRAM = 0x20000000;
+constexpr u32 FCRAM_SIZE = 0x8000000;
+
+std::vector<u32> Collect(const SurfacePageTable& table, PAddr addr, u64 size) {
+    std::vector<u32> indices;
+    table.ForEachPage(addr, size, [&](std::span<const SurfaceId> surfaces) {
+        for (const SurfaceId surface_id : surfaces) {
+            indices.push_back(surface_id.index);
+        }
+    });
+    return indices;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SurfacePageTable lookups", "[video_core][rasterizer_cache]") {
+    SurfacePageTable table;
+    table.Insert(VRAM, 0x60000, SurfaceId{2});           // Buckets 0-1
+    table.Insert(VRAM + 0x50000, 0x10000, SurfaceId{3}); // Bucket 1
+    table.Insert(FCRAM + FCRAM_SIZE - 0x100, 0x100, SurfaceId{4});
+
+    REQUIRE(Collect(table, VRAM, 0x100) == std::vector<u32>{2});
+    REQUIRE(Collect(table, VRAM + 0x40000, 0x100) == std::vector<u32>{2, 3});
+    REQUIRE(Collect(table, 0, 0xFFFFFFFF) == std::vector<u32>{2, 2, 3, 4});
+    REQUIRE(table.IsEmpty(VRAM + 0x80000, FCRAM_SIZE));
+    REQUIRE(!table.IsEmpty(FCRAM, FCRAM_SIZE));
+
+    // The callback may stop the iteration
+    std::size_t visited = 0;
+    table.ForEachPage(0, 0xFFFFFFFF, [&](std::span<const SurfaceId>) { return ++visited == 2; });
+    REQUIRE(visited == 2);
+
+    REQUIRE(table.Erase(VRAM, 0x60000, SurfaceId{2}));
+    REQUIRE(!table.Erase(VRAM, 0x60000, SurfaceId{2}));
+    REQUIRE(Collect(table, VRAM, 0x80000) == std::vector<u32>{3});
+    REQUIRE(table.IsEmpty(VRAM, 0x40000));
+
+    table.Clear();
+    REQUIRE(table.IsEmpty(0, 0xFFFFFFFF));
+}
+
+} // namespace VideoCore
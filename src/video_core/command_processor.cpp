@@ -49,6 +49,17 @@ static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     return "unknown shader";
 }
 
+/// Returns true if writes to the register upload LUT entries, which changes state even when the
+/// written value repeats
+static bool IsLutDataReg(u32 id) {
+    const auto InRange = [id](u32 first, u32 last) { return id >= first && id <= last; };
+    return InRange(PICA_REG_INDEX(lighting.lut_data[0]), PICA_REG_INDEX(lighting.lut_data[7])) ||
+           InRange(PICA_REG_INDEX(texturing.fog_lut_data[0]),
+                   PICA_REG_INDEX(texturing.fog_lut_data[7])) ||
+           InRange(PICA_REG_INDEX(texturing.proctex_lut_data[0]),
+                   PICA_REG_INDEX(texturing.proctex_lut_data[7]));
+}
+
 static void WriteUniformBoolReg(Shader::ShaderSetup& setup, u32 value) {
     for (unsigned i = 0; i < setup.uniforms.b.size(); ++i)
         setup.uniforms.b[i] = (value & (1 << i)) != 0;
@@ -128,8 +139,16 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     u32 old_value = regs.reg_array[id];
 
     const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    // Triangles kept back for merging are drawn with the current state, so draw them before it
+    // changes. The registers from the pipeline onwards only feed vertex processing, which has
+    // already run for them.
+    if (id < PICA_REG_INDEX(pipeline) && (new_value != old_value || IsLutDataReg(id))) {
+        VideoCore::g_renderer->Rasterizer()->DrawPendingTriangles();
+    }
+
+    regs.reg_array[id] = new_value;
 
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
@@ -241,8 +260,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     g_state.geometry_pipeline.Setup(shader_engine);
                     g_state.geometry_pipeline.SubmitVertex(output);
 
-                    // TODO: If drawing after every immediate mode triangle kills performance,
-                    // change it to flush triangles whenever a drawing config register changes
+                    // The rasterizer merges immediate mode triangles until a drawing config
+                    // register changes.
                     // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
                     VideoCore::g_renderer->Rasterizer()->DrawTriangles();
                     if (g_debug_context) {
@@ -673,6 +692,9 @@ void ProcessCommandList(PAddr list, u32 size) {
             WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
         }
     }
+
+    // The CPU may modify textures or read the framebuffers once the list is done
+    VideoCore::g_renderer->Rasterizer()->DrawPendingTriangles();
 }
 
 } // namespace Pica::CommandProcessor
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include "common/alignment.h"
 #include "core/memory.h"
@@ -10,6 +13,46 @@
 
 namespace VideoCore {
 
+/// Bounds the size of the vertex upload of merged draws
+constexpr std::size_t MAX_MERGED_VERTICES = 3 * 4096;
+
+/// Number of frames an index range stays cached without being used
+constexpr u64 MAX_INDEX_RANGE_AGE = 60;
+
+/// Returns true if the held back draw depends on the register, which are the vertex formats
+/// without the data addresses and the shader unit inputs. The registers before the pipeline are
+/// left out, as writing a new value to them draws the held back draw, see WritePicaReg.
+static constexpr bool IsMergeStateReg(std::size_t id) {
+    constexpr std::size_t loaders_begin =
+        PICA_REG_INDEX(pipeline.vertex_attributes.attribute_loaders[0]);
+    constexpr std::size_t loader_words =
+        PICA_REG_INDEX(pipeline.vertex_attributes.attribute_loaders[1]) - loaders_begin;
+    if (id > PICA_REG_INDEX(pipeline.vertex_attributes) &&
+        id < PICA_REG_INDEX(pipeline.index_array)) {
+        return id < loaders_begin || (id - loaders_begin) % loader_words != 0;
+    }
+    return id >= PICA_REG_INDEX(vs) && id < PICA_REG_INDEX(vs.uniform_setup);
+}
+
+/// Registers compared by IsSameMergeState
+static constexpr auto MERGE_STATE_REGS = [] {
+    constexpr std::size_t count = [] {
+        std::size_t count = 0;
+        for (std::size_t id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+            count += IsMergeStateReg(id) ? 1 : 0;
+        }
+        return count;
+    }();
+    std::array<u16, count> ids{};
+    std::size_t index = 0;
+    for (std::size_t id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+        if (IsMergeStateReg(id)) {
+            ids[index++] = static_cast<u16>(id);
+        }
+    }
+    return ids;
+}();
+
 static Common::Vec4f ColorRGBA8(const u32 color) {
     const auto rgba =
         Common::Vec4u{color >> 0 & 0xFF, color >> 8 & 0xFF, color >> 16 & 0xFF, color >> 24 & 0xFF};
@@ -88,6 +131,247 @@ void RasterizerAccelerated::AddTriangle(const Pica::Shader::OutputVertex& v0,
     vertex_batch.emplace_back(v2, AreQuaternionsOpposite(v0.quat, v2.quat));
 }
 
+void RasterizerAccelerated::DrawTriangles() {
+    if (vertex_batch.size() == submitted_vertices) {
+        return;
+    }
+
+    // Keep the triangles back while the draw state stays the same, consecutive draws are then
+    // issued as one host draw with a single vertex upload
+    submitted_vertices = vertex_batch.size();
+    draw_stats.submitted++;
+    if (submitted_vertices >= MAX_MERGED_VERTICES || IsSamplingColorBuffer()) {
+        DrawPendingTriangles();
+    }
+}
+
+void RasterizerAccelerated::DrawPendingTriangles() {
+    if (merged_draw.draws != 0) {
+        DrawMergedBatch();
+        merged_draw.draws = 0;
+        merged_draw.vertices.clear();
+        merged_draw.indices.clear();
+    }
+    if (vertex_batch.empty()) {
+        return;
+    }
+    DrawVertexBatch();
+    vertex_batch.clear();
+    submitted_vertices = 0;
+}
+
+bool RasterizerAccelerated::IsSamplingColorBuffer() const {
+    // Each draw of a feedback loop has to see the output of the previous one
+    const PAddr color_addr = regs.framebuffer.framebuffer.GetColorBufferPhysicalAddress();
+    return std::ranges::any_of(regs.texturing.GetTextures(), [color_addr](const auto& texture) {
+        return texture.enabled && texture.config.GetPhysicalAddress() == color_addr;
+    });
+}
+
+std::optional<std::size_t> RasterizerAccelerated::SingleAttributeLoader() const {
+    const auto& loaders = regs.pipeline.vertex_attributes.attribute_loaders;
+    std::optional<std::size_t> single;
+    for (std::size_t i = 0; i < std::size(loaders); ++i) {
+        if (loaders[i].component_count == 0 || loaders[i].byte_count == 0) {
+            continue;
+        }
+        if (single) {
+            return std::nullopt;
+        }
+        single = i;
+    }
+    return single;
+}
+
+bool RasterizerAccelerated::IsMergeableDraw(bool is_indexed) const {
+    // Strips and fans can't be concatenated and shadow rendering needs a barrier after each draw.
+    // Appended draws are addressed through rebased 16-bit indices.
+    return is_indexed &&
+           regs.pipeline.triangle_topology == Pica::PipelineRegs::TriangleTopology::List &&
+           regs.pipeline.use_gs == Pica::PipelineRegs::UseGS::No &&
+           !regs.framebuffer.IsShadowRendering() &&
+           vertex_info.vs_input_index_max - vertex_info.vs_input_index_min < MAX_MERGED_VERTICES &&
+           regs.pipeline.num_vertices <= MAX_MERGED_VERTICES;
+}
+
+RasterizerAccelerated::MergedDraw::Source RasterizerAccelerated::CurrentMergeSource(
+    std::size_t loader) const {
+    const auto& vertex_attributes = regs.pipeline.vertex_attributes;
+    const auto& attribute_loader = vertex_attributes.attribute_loaders[loader];
+    const PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
+    const u32 vertex_min = vertex_info.vs_input_index_min;
+    return {
+        .vertex_addr = base_address + attribute_loader.data_offset +
+                       vertex_min * attribute_loader.byte_count,
+        .vertex_count = vertex_info.vs_input_index_max - vertex_min + 1,
+        .index_addr = base_address + regs.pipeline.index_array.offset,
+        .index_count = regs.pipeline.num_vertices,
+        .index_min = vertex_min,
+        .index_u16 = regs.pipeline.index_array.format != 0,
+    };
+}
+
+bool RasterizerAccelerated::HoldMergedDraw(bool is_indexed, u32 stride_alignment) {
+    const auto loader = SingleAttributeLoader();
+    if (!loader || !IsMergeableDraw(is_indexed)) {
+        return false;
+    }
+
+    const u32 byte_count = regs.pipeline.vertex_attributes.attribute_loaders[*loader].byte_count;
+    merged_draw.draws = 1;
+    merged_draw.byte_count = byte_count;
+    merged_draw.stride = Common::AlignUp(byte_count, stride_alignment);
+    merged_draw.first = CurrentMergeSource(*loader);
+
+    const auto& default_attributes = Pica::g_state.input_default_attributes.attr;
+    merged_draw.state_regs.resize(MERGE_STATE_REGS.size());
+    std::ranges::transform(MERGE_STATE_REGS, merged_draw.state_regs.begin(),
+                           [this](u16 id) { return regs.reg_array[id]; });
+    std::copy(std::begin(default_attributes), std::end(default_attributes),
+              merged_draw.default_attributes.begin());
+    merged_draw.vs_uniforms.uniforms.SetFromRegs(regs.vs, Pica::g_state.vs);
+    merged_draw.fs_uniforms = uniform_block_data.data;
+    return true;
+}
+
+bool RasterizerAccelerated::IsSameMergeState() const {
+    // Program changes are tracked by the dirty registers
+    for (std::size_t i = 0; i < MERGE_STATE_REGS.size(); ++i) {
+        if (regs.reg_array[MERGE_STATE_REGS[i]] != merged_draw.state_regs[i]) {
+            return false;
+        }
+    }
+
+    const auto& default_attributes = Pica::g_state.input_default_attributes.attr;
+    const auto same_attribute = [](const auto& a, const auto& b) {
+        return std::memcmp(&a, &b, sizeof(a)) == 0;
+    };
+    if (!std::equal(std::begin(default_attributes), std::end(default_attributes),
+                    merged_draw.default_attributes.begin(), same_attribute)) {
+        return false;
+    }
+
+    Pica::Shader::VSUniformData vs_uniforms{};
+    vs_uniforms.uniforms.SetFromRegs(regs.vs, Pica::g_state.vs);
+    return std::memcmp(&vs_uniforms, &merged_draw.vs_uniforms, sizeof(vs_uniforms)) == 0 &&
+           std::memcmp(&uniform_block_data.data, &merged_draw.fs_uniforms,
+                       sizeof(Pica::Shader::UniformData)) == 0;
+}
+
+bool RasterizerAccelerated::CanMergeDraw(bool is_indexed) const {
+    // Triangles kept back by DrawTriangles have to be drawn in between
+    if (merged_draw.draws == 0 || !vertex_batch.empty() || !IsMergeableDraw(is_indexed)) {
+        return false;
+    }
+
+    // The shader configurations and the LUTs are synced when a host draw is set up
+    const auto& uniforms = uniform_block_data;
+    if (dirty_regs != DirtyRegs::None || uniforms.lighting_lut_dirty_any ||
+        uniforms.fog_lut_dirty || uniforms.proctex_noise_lut_dirty ||
+        uniforms.proctex_color_map_dirty || uniforms.proctex_alpha_map_dirty ||
+        uniforms.proctex_lut_dirty || uniforms.proctex_diff_lut_dirty) {
+        return false;
+    }
+    if (IsSamplingColorBuffer()) {
+        return false;
+    }
+
+    const auto loader = SingleAttributeLoader();
+    if (!loader) {
+        return false;
+    }
+    const MergedDraw::Source source = CurrentMergeSource(*loader);
+    if (source.index_u16 != merged_draw.first.index_u16) {
+        return false;
+    }
+    if (merged_draw.VertexCount() + source.vertex_count > MAX_MERGED_VERTICES ||
+        merged_draw.IndexCount() + source.index_count > MAX_MERGED_VERTICES) {
+        return false;
+    }
+
+    // Flushing rendered vertex data would be recorded ahead of the held back draw
+    const u32 vertex_size = source.vertex_count * merged_draw.byte_count;
+    if (IsRegionDirty(source.vertex_addr, vertex_size) ||
+        memory.GetPhysicalRef(source.vertex_addr).GetSize() < vertex_size) {
+        return false;
+    }
+
+    return IsSameMergeState();
+}
+
+std::size_t RasterizerAccelerated::MergedUploadSize() const {
+    const MergedDraw::Source source = CurrentMergeSource(*SingleAttributeLoader());
+    const u32 stride = merged_draw.stride;
+    const std::size_t vertex_size = merged_draw.vertices.size() + source.vertex_count * stride;
+    const std::size_t index_count = merged_draw.IndexCount() + source.index_count;
+    // The appended vertices are moved by up to a stride to line up with the held back draw's
+    return Common::AlignUp(vertex_size + stride, 4) + index_count * sizeof(u32);
+}
+
+void RasterizerAccelerated::MergeDraw() {
+    if (merged_draw.indices.empty()) {
+        AppendMergeIndices(merged_draw.first, 0);
+    }
+
+    // Expand the guest stride to the uploaded one
+    const MergedDraw::Source source = CurrentMergeSource(*SingleAttributeLoader());
+    const u32 stride = merged_draw.stride;
+    const u32 byte_count = merged_draw.byte_count;
+    const std::size_t vertex_offset = merged_draw.vertices.size();
+    const u8* vertex_data = memory.GetPhysicalPointer(source.vertex_addr);
+    merged_draw.vertices.resize(vertex_offset + source.vertex_count * stride);
+    u8* vertices = merged_draw.vertices.data() + vertex_offset;
+    if (stride == byte_count) {
+        std::memcpy(vertices, vertex_data, source.vertex_count * byte_count);
+    } else {
+        for (u32 vertex = 0; vertex < source.vertex_count; ++vertex) {
+            std::memcpy(vertices + vertex * stride, vertex_data + vertex * byte_count, byte_count);
+        }
+    }
+    AppendMergeIndices(source, static_cast<u32>(vertex_offset / stride));
+
+    merged_draw.draws++;
+    draw_stats.submitted++;
+}
+
+void RasterizerAccelerated::AppendMergeIndices(const MergedDraw::Source& source,
+                                               u32 base_vertex) {
+    const u8* index_address_8 = memory.GetPhysicalPointer(source.index_addr);
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    for (u32 index = 0; index < source.index_count; ++index) {
+        const u32 vertex = source.index_u16 ? index_address_16[index] : index_address_8[index];
+        merged_draw.indices.push_back(static_cast<u16>(vertex - source.index_min + base_vertex));
+    }
+}
+
+RasterizerAccelerated::MergedUpload RasterizerAccelerated::UploadMergedVertices(
+    u8* buffer, u64 offset, u64 first_offset) const {
+    // Start the appended vertices a whole number of strides away from the held back draw's, so
+    // one binding addresses both
+    const u32 stride = merged_draw.stride;
+    const u64 padding = (first_offset % stride + stride - offset % stride) % stride;
+    const u64 appended_offset = offset + padding;
+    std::memcpy(buffer + padding, merged_draw.vertices.data(), merged_draw.vertices.size());
+
+    const u64 base_offset = std::min(first_offset, appended_offset);
+    return {
+        .base_offset = base_offset,
+        .size = padding + merged_draw.vertices.size(),
+        .first_vertex = static_cast<u32>((first_offset - base_offset) / stride),
+        .appended_vertex = static_cast<u32>((appended_offset - base_offset) / stride),
+    };
+}
+
+void RasterizerAccelerated::WriteMergedIndices(u32* indices, const MergedUpload& upload) const {
+    const std::size_t first_count = merged_draw.first.index_count;
+    for (std::size_t i = 0; i < first_count; ++i) {
+        indices[i] = merged_draw.indices[i] + upload.first_vertex;
+    }
+    for (std::size_t i = first_count; i < merged_draw.indices.size(); ++i) {
+        indices[i] = merged_draw.indices[i] + upload.appended_vertex;
+    }
+}
+
 RasterizerAccelerated::VertexArrayInfo RasterizerAccelerated::AnalyzeVertexArray(
     bool is_indexed, u32 stride_alignment) {
     const auto& vertex_attributes = regs.pipeline.vertex_attributes;
@@ -97,19 +381,39 @@ RasterizerAccelerated::VertexArrayInfo RasterizerAccelerated::AnalyzeVertexArray
     if (is_indexed) {
         const auto& index_info = regs.pipeline.index_array;
         const PAddr address = vertex_attributes.GetPhysicalBaseAddress() + index_info.offset;
-        const u8* index_address_8 = memory.GetPhysicalPointer(address);
-        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
         const bool index_u16 = index_info.format != 0;
-
-        vertex_min = 0xFFFF;
-        vertex_max = 0;
-        const u32 size = regs.pipeline.num_vertices * (index_u16 ? 2 : 1);
-        FlushRegion(address, size);
-        for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
-            const u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
-            vertex_min = std::min(vertex_min, vertex);
-            vertex_max = std::max(vertex_max, vertex);
+        const IndexArrayKey key = {address, regs.pipeline.num_vertices, index_u16 ? 2U : 1U};
+        const u32 size = key.count * key.index_size;
+
+        // Static index arrays are drawn every frame, scan them again only once they are written
+        const auto [it, inserted] = index_ranges.try_emplace(key);
+        IndexRange& range = it->second;
+        if (inserted) {
+            TrackRegion(address, size, true);
+        }
+        const u64 write_tick = GetWriteTick(address, size);
+        if (inserted || range.write_tick != write_tick) {
+            if (merged_draw.draws != 0 && IsRegionDirty(address, size)) {
+                // The held back draw may have rendered the indices, and it has to be recorded
+                // before the download
+                DrawPendingTriangles();
+            }
+            FlushRegion(address, size);
+
+            const u8* index_address_8 = memory.GetPhysicalPointer(address);
+            const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+            range.min = 0xFFFF;
+            range.max = 0;
+            for (u32 index = 0; index < key.count; ++index) {
+                const u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+                range.min = std::min(range.min, vertex);
+                range.max = std::max(range.max, vertex);
+            }
+            range.write_tick = write_tick;
         }
+        range.last_used_frame = frame_count;
+        vertex_min = range.min;
+        vertex_max = range.max;
     } else {
         vertex_min = regs.pipeline.vertex_offset;
         vertex_max = regs.pipeline.vertex_offset + regs.pipeline.num_vertices - 1;
@@ -128,9 +432,29 @@ RasterizerAccelerated::VertexArrayInfo RasterizerAccelerated::AnalyzeVertexArray
     return {vertex_min, vertex_max, vs_input_size};
 }
 
+void RasterizerAccelerated::TickIndexRanges() {
+    std::erase_if(index_ranges, [this](const auto& pair) {
+        const auto& [key, range] = pair;
+        if (frame_count - range.last_used_frame < MAX_INDEX_RANGE_AGE) {
+            return false;
+        }
+        TrackRegion(key.addr, key.count * key.index_size, false);
+        return true;
+    });
+    frame_count++;
+}
+
+void RasterizerAccelerated::ClearIndexRanges() {
+    for (const auto& [key, range] : index_ranges) {
+        TrackRegion(key.addr, key.count * key.index_size, false);
+    }
+    index_ranges.clear();
+}
+
 void RasterizerAccelerated::SyncEntireState() {
     // Sync renderer-specific fixed-function state
     SyncFixedState();
+    dirty_regs = DirtyRegs::All;
 
     // Sync uniforms
     SyncClipCoef();
@@ -177,12 +501,13 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
 
     // Depth buffering
     case PICA_REG_INDEX(rasterizer.depthmap_enable):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // Shadow texture
     case PICA_REG_INDEX(texturing.shadow):
         SyncShadowTextureBias();
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // Fog state
@@ -205,7 +530,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(texturing.proctex_lut):
     case PICA_REG_INDEX(texturing.proctex_lut_offset):
         SyncProcTexBias();
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     case PICA_REG_INDEX(texturing.proctex_noise_u):
@@ -245,7 +570,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     // Alpha test
     case PICA_REG_INDEX(framebuffer.output_merger.alpha_test):
         SyncAlphaTest();
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     case PICA_REG_INDEX(framebuffer.shadow):
@@ -254,16 +579,16 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
 
     // Scissor test
     case PICA_REG_INDEX(rasterizer.scissor_test.mode):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     case PICA_REG_INDEX(texturing.main_config):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // Texture 0 type
     case PICA_REG_INDEX(texturing.texture0.type):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // TEV stages
@@ -293,7 +618,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(texturing.tev_stage5.color_op):
     case PICA_REG_INDEX(texturing.tev_stage5.color_scale):
     case PICA_REG_INDEX(texturing.tev_combiner_buffer_input):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
     case PICA_REG_INDEX(texturing.tev_stage0.const_r):
         SyncTevConstColor(0, regs.texturing.tev_stage0);
@@ -328,6 +653,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(lighting.lut_input):
     case PICA_REG_INDEX(lighting.lut_scale):
     case PICA_REG_INDEX(lighting.light_enable):
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // Fragment lighting specular 0 color
@@ -511,7 +837,7 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(lighting.light[5].config):
     case PICA_REG_INDEX(lighting.light[6].config):
     case PICA_REG_INDEX(lighting.light[7].config):
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
         break;
 
     // Fragment lighting distance attenuation bias
@@ -605,6 +931,45 @@ void RasterizerAccelerated::NotifyPicaRegisterChanged(u32 id) {
         SyncClipCoef();
         break;
 
+    // Shadow rendering mode, this register also holds the blend enable
+    case PICA_REG_INDEX(framebuffer.output_merger.fragment_operation_mode):
+        dirty_regs |= DirtyRegs::FragmentConfig;
+        NotifyFixedFunctionPicaRegisterChanged(id);
+        break;
+
+    // Vertex shader program and its outputs
+    case PICA_REG_INDEX(vs.main_offset):
+    case PICA_REG_INDEX(vs.program.set_word[0]):
+    case PICA_REG_INDEX(vs.program.set_word[1]):
+    case PICA_REG_INDEX(vs.program.set_word[2]):
+    case PICA_REG_INDEX(vs.program.set_word[3]):
+    case PICA_REG_INDEX(vs.program.set_word[4]):
+    case PICA_REG_INDEX(vs.program.set_word[5]):
+    case PICA_REG_INDEX(vs.program.set_word[6]):
+    case PICA_REG_INDEX(vs.program.set_word[7]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[1]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[2]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[3]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[4]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[5]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[6]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[7]):
+        dirty_regs |= DirtyRegs::VertexConfig;
+        break;
+
+    case PICA_REG_INDEX(vs.output_mask):
+    case PICA_REG_INDEX(rasterizer.vs_output_total):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[0]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[1]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[2]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[3]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[4]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[5]):
+    case PICA_REG_INDEX(rasterizer.vs_output_attributes[6]):
+        dirty_regs |= DirtyRegs::VertexConfig | DirtyRegs::GeometryConfig;
+        break;
+
     default:
         // Forward registers that map to fixed function API features to the video backend
         NotifyFixedFunctionPicaRegisterChanged(id);
@@ -4,32 +4,111 @@
 
 #pragma once
 
+#include <optional>
+#include <unordered_map>
+#include "common/common_funcs.h"
+#include "common/hash.h"
 #include "common/vector_math.h"
+#include "video_core/pica_types.h"
 #include "video_core/rasterizer_interface.h"
-#include "video_core/regs_texturing.h"
+#include "video_core/regs.h"
 #include "video_core/shader/shader_uniforms.h"
 
 namespace Memory {
 class MemorySystem;
 }
 
-namespace Pica {
-struct Regs;
-}
-
 namespace VideoCore {
 
+/// Groups of PICA registers that the backend shader configurations are built from
+enum class DirtyRegs : u32 {
+    None = 0,
+    FragmentConfig = 1 << 0, ///< Registers read by the fragment shader configuration
+    VertexConfig = 1 << 1,   ///< Shader unit and output registers read by the vertex shader
+    GeometryConfig = 1 << 2, ///< Output registers read by the fixed geometry shader
+    All = FragmentConfig | VertexConfig | GeometryConfig,
+};
+DECLARE_ENUM_FLAG_OPERATORS(DirtyRegs)
+
 class RasterizerAccelerated : public RasterizerInterface {
 public:
+    /// Per-frame draw counters
+    struct DrawStats {
+        u32 submitted{}; ///< PICA draws that produced primitives
+        u32 issued{};    ///< Host draws recorded for them
+    };
+
     RasterizerAccelerated(Memory::MemorySystem& memory);
     virtual ~RasterizerAccelerated() = default;
 
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
+    void DrawTriangles() override;
+    void DrawPendingTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override;
     void SyncEntireState() override;
 
+    /// Returns the draw counters of the last completed frame
+    const DrawStats& GetDrawStats() const noexcept {
+        return last_draw_stats;
+    }
+
 protected:
+    /// Issues a single host draw for the triangles in the vertex batch
+    virtual void DrawVertexBatch() = 0;
+
+    /// Returns true if a texture unit samples the color buffer being rendered to
+    bool IsSamplingColorBuffer() const;
+
+    /// Issues the accelerated draw held back by HoldMergedDraw, as one host draw over the merged
+    /// vertex and index data if other draws were appended to it
+    virtual void DrawMergedBatch() = 0;
+
+    /// Returns true if the region holds rendered data that was not written back to guest memory
+    virtual bool IsRegionDirty(PAddr addr, u32 size) const = 0;
+
+    /// Starts or stops tracking the guest writes to a region the rasterizer keeps data of
+    virtual void TrackRegion(PAddr addr, u32 size, bool track) = 0;
+
+    /// Returns a value that changes with every guest write to a tracked region overlapping it
+    virtual u64 GetWriteTick(PAddr addr, u32 size) const = 0;
+
+    /// Drops the index ranges that were not used recently, called once per frame
+    void TickIndexRanges();
+
+    /// Drops all the index ranges, before the backend stops tracking guest writes
+    void ClearIndexRanges();
+
+    /// Holds back the accelerated draw that was just set up, so the following draws with the same
+    /// state can be appended to it. Returns true if its host draw must not be issued yet.
+    bool HoldMergedDraw(bool is_indexed, u32 stride_alignment);
+
+    /// Returns true if the accelerated draw being set up only differs from the held back one in
+    /// its vertex and index data
+    bool CanMergeDraw(bool is_indexed) const;
+
+    /// Appends the vertex and index data of the accelerated draw being set up to the held back one
+    void MergeDraw();
+
+    /// Returns the upper bound of the size of the appended vertex data, aligned to 4 bytes, and the
+    /// 32-bit indices of the batch once the accelerated draw being set up is appended
+    std::size_t MergedUploadSize() const;
+
+    /// Location of the vertex data of a batch, see UploadMergedVertices
+    struct MergedUpload {
+        u64 base_offset;     ///< Buffer offset the indices of the batch are relative to
+        u64 size;            ///< Bytes used from the offset the vertices were uploaded at
+        u32 first_vertex;    ///< Vertex of the held back draw's data
+        u32 appended_vertex; ///< Vertex of the data of the appended draws
+    };
+
+    /// Uploads the vertices of the appended draws to buffer, mapped at offset, so that the
+    /// vertices the held back draw uploaded at first_offset in the same buffer are reused
+    MergedUpload UploadMergedVertices(u8* buffer, u64 offset, u64 first_offset) const;
+
+    /// Writes the indices of the batch for the vertex data placed by UploadMergedVertices
+    void WriteMergedIndices(u32* indices, const MergedUpload& upload) const;
+
     /// Sync fixed-function pipeline state
     virtual void SyncFixedState() = 0;
 
@@ -136,16 +215,98 @@ protected:
         u32 vs_input_size;
     };
 
+    /// Index array of an indexed draw
+    struct IndexArrayKey {
+        PAddr addr;
+        u32 count;
+        u32 index_size;
+
+        bool operator==(const IndexArrayKey&) const noexcept = default;
+    };
+
+    struct IndexArrayKeyHash {
+        std::size_t operator()(const IndexArrayKey& key) const noexcept {
+            return Common::ComputeStructHash64(key);
+        }
+    };
+
+    /// Lowest and highest index of an index array, valid until the guest writes to it
+    struct IndexRange {
+        u32 min;
+        u32 max;
+        u64 write_tick;
+        u64 last_used_frame;
+    };
+
     /// Retrieve the range and the size of the input vertex
     VertexArrayInfo AnalyzeVertexArray(bool is_indexed, u32 stride_alignment = 1);
 
+    /// Accelerated draw whose host draw is held back to append the following draws to it
+    struct MergedDraw {
+        /// Guest vertex and index data of a draw with a single attribute loader
+        struct Source {
+            PAddr vertex_addr;
+            u32 vertex_count;
+            PAddr index_addr;
+            u32 index_count;
+            u32 index_min;
+            bool index_u16;
+        };
+
+        u32 draws{};              ///< PICA draws in the batch, 0 if no draw is held back
+        u32 stride{};             ///< Stride of the vertex data as uploaded
+        u32 byte_count{};         ///< Stride of the guest vertex data
+        Source first{};           ///< Data of the held back draw, its vertices are uploaded
+        std::vector<u8> vertices; ///< Vertex data of the appended draws
+        /// Indices of the batch, filled once a draw is appended. The held back draw's indices come
+        /// first and are relative to its vertices, the others are relative to vertices.
+        std::vector<u16> indices;
+
+        // State the appended draws are compared against
+        std::vector<u32> state_regs; ///< Values of the registers in MERGE_STATE_REGS
+        std::array<Common::Vec4<Pica::float24>, 16> default_attributes{};
+        Pica::Shader::VSUniformData vs_uniforms{};
+        Pica::Shader::UniformData fs_uniforms{};
+
+        /// Returns the number of vertices in the batch
+        u32 VertexCount() const {
+            return first.vertex_count + static_cast<u32>(vertices.size() / stride);
+        }
+
+        /// Returns the number of indices in the batch
+        u32 IndexCount() const {
+            return indices.empty() ? first.index_count : static_cast<u32>(indices.size());
+        }
+    };
+
+    /// Returns the index of the only attribute loader that provides data, if there is one
+    std::optional<std::size_t> SingleAttributeLoader() const;
+
+    /// Returns true if the current draw has a layout that can be merged
+    bool IsMergeableDraw(bool is_indexed) const;
+
+    /// Returns the data of the accelerated draw being set up
+    MergedDraw::Source CurrentMergeSource(std::size_t loader) const;
+
+    /// Returns true if the state the current draw depends on matches the held back draw
+    bool IsSameMergeState() const;
+
+    /// Appends the indices of source, rebased to start at base_vertex, to the merged indices
+    void AppendMergeIndices(const MergedDraw::Source& source, u32 base_vertex);
+
 protected:
     Memory::MemorySystem& memory;
     Pica::Regs& regs;
 
     VertexArrayInfo vertex_info{};
     std::vector<HardwareVertex> vertex_batch;
-    bool shader_dirty = true;
+    std::size_t submitted_vertices{};
+    MergedDraw merged_draw{};
+    std::unordered_map<IndexArrayKey, IndexRange, IndexArrayKeyHash> index_ranges;
+    u64 frame_count{};
+    DirtyRegs dirty_regs = DirtyRegs::All;
+    DrawStats draw_stats{};
+    DrawStats last_draw_stats{};
 
     UniformBlockData uniform_block_data{};
     std::array<std::array<Common::Vec2f, 256>, Pica::LightingRegs::NumLightingSampler>
@@ -2,11 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <limits>
 #include "common/bit_util.h"
 #include "common/file_util.h"
 #include "common/hash.h"
 #include "common/image_util.h"
 #include "common/scratch_buffer.h"
+#include "common/settings.h"
+#include "common/string_util.h"
 #include "core/core.h"
 #include "video_core/rasterizer_cache/custom_tex_manager.h"
 #include "video_core/rasterizer_cache/surface_params.h"
@@ -17,6 +21,111 @@ namespace {
 
 using namespace Common;
 
+constexpr u32 IndexMagic = 0x58495443; // "CTIX"
+constexpr u32 IndexVersion = 1;
+
+/// Maximum number of remembered source data hashes before the cache is cleared
+constexpr std::size_t MaxHashCacheSize = 1 << 18;
+
+/**
+ * Metadata of a texture file stored in the pack index, so the file does not have to be read
+ * at boot. An entry is only used if the size of the file has not changed since it was indexed.
+ */
+struct IndexEntry {
+    u64 file_size;
+    u64 staging_size;
+    u32 width;
+    u32 height;
+    CustomPixelFormat format;
+    u32 path_size;
+};
+static_assert(std::is_trivially_copyable_v<IndexEntry>);
+
+/// Parameters of a guest texture that affect its decoded data
+struct SourceLayout {
+    u32 width;
+    u32 height;
+    u32 stride;
+    PixelFormat format;
+    u32 is_tiled;
+};
+
+using TextureIndex = std::unordered_map<std::string, IndexEntry>;
+
+std::string GetIndexPath(u64 program_id) {
+    return fmt::format("{}custom_textures/{:016X}.idx",
+                       GetUserPath(FileUtil::UserPath::CacheDir), program_id);
+}
+
+TextureIndex LoadIndex(const std::string& path) {
+    TextureIndex index;
+    FileUtil::IOFile file{path, "rb"};
+    if (!file.IsOpen()) {
+        return index;
+    }
+
+    u32 magic{};
+    u32 version{};
+    u64 num_entries{};
+    if (file.ReadBytes(&magic, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&version, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&num_entries, sizeof(u64)) != sizeof(u64) || magic != IndexMagic ||
+        version != IndexVersion) {
+        LOG_WARNING(Render, "Ignoring invalid custom texture index {}", path);
+        return index;
+    }
+
+    for (u64 i = 0; i < num_entries; i++) {
+        IndexEntry entry;
+        std::string texture_path;
+        if (file.ReadBytes(&entry, sizeof(IndexEntry)) != sizeof(IndexEntry)) {
+            break;
+        }
+        texture_path.resize(entry.path_size);
+        if (file.ReadArray(texture_path.data(), entry.path_size) != entry.path_size) {
+            break;
+        }
+        index.emplace(std::move(texture_path), entry);
+    }
+    return index;
+}
+
+void SaveIndex(const std::string& path,
+               const std::vector<std::unique_ptr<CustomTexture>>& textures,
+               const std::vector<FileUtil::FSTEntry>& files) {
+    std::string folder;
+    Common::SplitPath(path, &folder, nullptr, nullptr);
+    FileUtil::CreateFullPath(folder);
+
+    FileUtil::IOFile file{path, "wb"};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render, "Unable to create custom texture index {}", path);
+        return;
+    }
+
+    const u64 num_entries = std::ranges::count_if(
+        textures, [](const auto& texture) { return texture && texture->staging_size != 0; });
+    file.WriteObject(IndexMagic);
+    file.WriteObject(IndexVersion);
+    file.WriteObject(num_entries);
+    for (std::size_t i = 0; i < textures.size(); i++) {
+        const auto& texture = textures[i];
+        if (!texture || texture->staging_size == 0) {
+            continue;
+        }
+        const IndexEntry entry = {
+            .file_size = files[i].size,
+            .staging_size = texture->staging_size,
+            .width = texture->width,
+            .height = texture->height,
+            .format = texture->format,
+            .path_size = static_cast<u32>(texture->path.size()),
+        };
+        file.WriteObject(entry);
+        file.WriteString(texture->path);
+    }
+}
+
 CustomFileFormat MakeFileFormat(std::string_view ext) {
     if (ext == "png") {
         return CustomFileFormat::PNG;
@@ -90,6 +199,12 @@ void CustomTexManager::FindCustomTextures() {
     const std::size_t num_textures = textures.size();
     custom_textures.resize(num_textures);
 
+    // Querying every file is slow for large packs, so their metadata is kept in an index
+    const std::string index_path = GetIndexPath(program_id);
+    const TextureIndex index = LoadIndex(index_path);
+    std::atomic<std::size_t> index_hits = 0;
+    std::atomic<bool> index_outdated = false;
+
     const auto load = [&](std::size_t begin, std::size_t end) {
         u32 width{};
         u32 height{};
@@ -119,8 +234,18 @@ void CustomTexManager::FindCustomTextures() {
             texture.hash = hash;
             texture.path = path;
 
-            // Query the file for the rest
+            // Take the rest from the index if the file is unchanged or query the file for it
+            const auto it = index.find(path);
+            if (it != index.end() && it->second.file_size == file.size) {
+                texture.width = it->second.width;
+                texture.height = it->second.height;
+                texture.format = it->second.format;
+                texture.staging_size = it->second.staging_size;
+                index_hits++;
+                continue;
+            }
             QueryTexture(texture);
+            index_outdated = true;
         }
     };
 
@@ -136,6 +261,10 @@ void CustomTexManager::FindCustomTextures() {
 
     workers->WaitForRequests();
 
+    if (index_outdated || index_hits != index.size()) {
+        SaveIndex(index_path, custom_textures, textures);
+    }
+
     // Assign each texture to the hash map
     for (const auto& texture : custom_textures) {
         if (!texture) {
@@ -152,9 +281,31 @@ void CustomTexManager::FindCustomTextures() {
     }
 
     textures_loaded = true;
+
+    if (Settings::values.preload_textures) {
+        PreloadTextures();
+    }
 }
 
 u64 CustomTexManager::ComputeHash(const SurfaceParams& params, std::span<u8> data) {
+    // Hashing the guest data is much cheaper than decoding it, so remember which decoded hash
+    // each source produced and only decode the data the first time it is seen.
+    const SourceLayout layout = {
+        .width = params.width,
+        .height = params.height,
+        .stride = params.stride,
+        .format = params.pixel_format,
+        .is_tiled = params.is_tiled,
+    };
+    const u64 source_hash =
+        HashCombine(ComputeHash64(data.data(), data.size()), ComputeStructHash64(layout));
+    if (const auto it = hash_cache.find(source_hash); it != hash_cache.end()) {
+        return it->second;
+    }
+    if (hash_cache.size() >= MaxHashCacheSize) {
+        hash_cache.clear();
+    }
+
     const u32 decoded_size = params.width * params.height * GetBytesPerPixel(params.pixel_format);
     if (temp_buffer.size() < decoded_size) {
         temp_buffer.resize(decoded_size);
@@ -165,7 +316,9 @@ u64 CustomTexManager::ComputeHash(const SurfaceParams& params, std::span<u8> dat
     // this must be done...
     const auto decoded = std::span{temp_buffer.data(), decoded_size};
     DecodeTexture(params, params.addr, params.end, data, decoded);
-    return ComputeHash64(decoded.data(), decoded_size);
+    const u64 hash = ComputeHash64(decoded.data(), decoded_size);
+    hash_cache.emplace(source_hash, hash);
+    return hash;
 }
 
 void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::span<u8> data) {
@@ -233,6 +386,7 @@ CustomTexture& CustomTexManager::GetTexture(u64 data_hash) {
 }
 
 void CustomTexManager::DecodeToStaging(CustomTexture& texture, StagingData& staging) {
+    texture.last_use = ++use_tick;
     if (texture.state == DecodeState::Decoded) {
         // Nothing to do here, just copy over the data
         ASSERT_MSG(staging.size == texture.staging_size,
@@ -241,54 +395,123 @@ void CustomTexManager::DecodeToStaging(CustomTexture& texture, StagingData& stag
         return;
     }
     if (texture.state == DecodeState::Pending) {
-        // Can occur if a texture is re-uploaded shortly after a decode started.
-        // Since this is quite rare just wait for the data.
-        LOG_WARNING(Render, "Texture requested while pending decode!");
-        texture.state.wait(DecodeState::Pending);
+        // Either a preload that has not started yet, which is decoded here instead of waiting
+        // for the preload queue to reach it, or a texture re-uploaded shortly after its decode
+        // started, which is waited for.
+        if (!texture.decode_started.test_and_set()) {
+            Decode(texture);
+            texture.MarkDecoded();
+        } else {
+            LOG_DEBUG(Render, "Texture {:016X} requested while pending decode", texture.hash);
+            texture.state.wait(DecodeState::Pending);
+        }
         std::memcpy(staging.mapped.data(), texture.data.data(), texture.data.size());
         return;
     }
 
+    MakeResident(texture);
+
     // Set an atomic flag in staging data so the backend can wait until the data is finished
     staging.flag = &texture.state;
     texture.state = DecodeState::Pending;
+    texture.decode_started.test_and_set();
 
     const auto decode = [this, &texture, mapped = staging.mapped]() {
-        // Read the file this is potentially the most expensive step
-        FileUtil::IOFile file{texture.path, "rb"};
-        ScratchBuffer<u8> file_data{file.GetSize()};
-        file.ReadBytes(file_data.Data(), file.GetSize());
-
-        // Resize the decoded data buffer
-        std::vector<u8>& decoded_data = texture.data;
-        decoded_data.resize(texture.staging_size);
-
-        // Decode
-        switch (texture.file_format) {
-        case CustomFileFormat::PNG:
-            if (!DecodePNG(file_data.Span(), decoded_data)) {
-                LOG_ERROR(Render, "Failed to decode png {}", texture.path);
-            }
-            if (compatibility_mode) {
-                const u32 stride = texture.width * 4;
-                FlipTexture(decoded_data, texture.width, texture.height, stride);
-            }
-            break;
-        case CustomFileFormat::DDS:
-        case CustomFileFormat::KTX:
-            // Compressed formats don't need CPU decoding and must be pre-flipped.
-            LoadDDSKTX(file_data.Span(), decoded_data);
-            break;
-        }
+        Decode(texture);
 
         // Copy it over to the staging memory and notify the backend that decode is done,
-        std::memcpy(mapped.data(), decoded_data.data(), decoded_data.size());
+        std::memcpy(mapped.data(), texture.data.data(), texture.data.size());
         texture.MarkDecoded();
     };
 
     workers->QueueWork(std::move(decode));
 }
 
+void CustomTexManager::Decode(CustomTexture& texture) {
+    // Read the file this is potentially the most expensive step
+    FileUtil::IOFile file{texture.path, "rb"};
+    ScratchBuffer<u8> file_data{file.GetSize()};
+    file.ReadBytes(file_data.Data(), file.GetSize());
+
+    // Resize the decoded data buffer
+    std::vector<u8>& decoded_data = texture.data;
+    decoded_data.resize(texture.staging_size);
+
+    // Decode
+    switch (texture.file_format) {
+    case CustomFileFormat::PNG:
+        if (!DecodePNG(file_data.Span(), decoded_data)) {
+            LOG_ERROR(Render, "Failed to decode png {}", texture.path);
+        }
+        if (compatibility_mode) {
+            const u32 stride = texture.width * 4;
+            FlipTexture(decoded_data, texture.width, texture.height, stride);
+        }
+        break;
+    case CustomFileFormat::DDS:
+    case CustomFileFormat::KTX:
+        // Compressed formats don't need CPU decoding and must be pre-flipped.
+        LoadDDSKTX(file_data.Span(), decoded_data);
+        break;
+    }
+}
+
+std::size_t CustomTexManager::DecodedBudget() const {
+    const u64 budget = u64{Settings::values.custom_textures_budget.GetValue()} << 20;
+    return budget != 0 ? budget : std::numeric_limits<std::size_t>::max();
+}
+
+void CustomTexManager::MakeResident(CustomTexture& texture) {
+    const std::size_t budget = DecodedBudget();
+    if (resident_size + texture.staging_size > budget) {
+        // Evict down to a bit below the budget, so this does not run on every decode.
+        // Textures still being decoded can't be evicted.
+        const std::size_t target = budget - budget / 8;
+        std::ranges::sort(resident_textures, {}, &CustomTexture::last_use);
+        std::size_t num_kept = 0;
+        for (CustomTexture* resident : resident_textures) {
+            if (resident_size + texture.staging_size <= target ||
+                resident->state != DecodeState::Decoded) {
+                resident_textures[num_kept++] = resident;
+                continue;
+            }
+            resident_size -= resident->staging_size;
+            resident->data = {};
+            resident->state = DecodeState::None;
+            resident->decode_started.clear();
+        }
+        LOG_DEBUG(Render, "Evicted {} decoded custom textures",
+                  resident_textures.size() - num_kept);
+        resident_textures.resize(num_kept);
+    }
+    resident_size += texture.staging_size;
+    resident_textures.push_back(&texture);
+}
+
+void CustomTexManager::PreloadTextures() {
+    preload_workers = std::make_unique<Common::ThreadWorker>(
+        std::max<std::size_t>(workers->NumWorkers() / 2, 1), "Custom textures preload");
+
+    const std::size_t budget = DecodedBudget();
+    for (const auto& [hash, texture] : custom_texture_map) {
+        if (resident_size + texture->staging_size > budget) {
+            LOG_WARNING(Render, "Custom textures exceed the memory budget, "
+                                "the remaining ones will be loaded on demand");
+            break;
+        }
+        MakeResident(*texture);
+        texture->state = DecodeState::Pending;
+        preload_workers->QueueWork([this, texture] {
+            // The texture may have been requested and decoded on demand already
+            if (texture->decode_started.test_and_set()) {
+                return;
+            }
+            Decode(*texture);
+            texture->MarkDecoded();
+        });
+    }
+}
+
 void CustomTexManager::QueryTexture(CustomTexture& texture) {
     // Read the file
     FileUtil::IOFile file{texture.path, "rb"};
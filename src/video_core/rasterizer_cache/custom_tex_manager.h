@@ -44,6 +44,10 @@ struct CustomTexture {
     std::size_t staging_size;
     std::vector<u8> data;
     std::atomic<DecodeState> state{};
+    /// Set by the job that decodes the texture, so a queued preload and an on-demand request
+    /// don't both decode it
+    std::atomic_flag decode_started;
+    u64 last_use{};
 
     operator bool() const noexcept {
         return hash != 0;
@@ -83,16 +87,35 @@ private:
     /// Fills the texture structure with information from the file in path
     void QueryTexture(CustomTexture& texture);
 
+    /// Reads and decodes the file of texture into its data buffer
+    void Decode(CustomTexture& texture);
+
+    /// Returns the upper bound of decoded texture data kept in memory
+    std::size_t DecodedBudget() const;
+
+    /// Accounts for a texture about to be decoded, evicting the least recently used ones
+    /// if the decoded data would exceed the budget
+    void MakeResident(CustomTexture& texture);
+
+    /// Decodes textures in the background until the budget is filled. The decodes run on their
+    /// own workers, so textures requested by the game are not queued behind them.
+    void PreloadTextures();
+
 private:
     Core::System& system;
     std::unique_ptr<Common::ThreadWorker> workers;
     std::unordered_set<u64> dumped_textures;
     std::unordered_map<u64, CustomTexture*> custom_texture_map;
     std::vector<std::unique_ptr<CustomTexture>> custom_textures;
+    std::vector<CustomTexture*> resident_textures;
+    std::size_t resident_size{};
+    u64 use_tick{};
+    std::unordered_map<u64, u64> hash_cache;
     std::vector<u8> temp_buffer;
     CustomTexture dummy_texture{};
     bool textures_loaded{};
     bool compatibility_mode{true};
+    std::unique_ptr<Common::ThreadWorker> preload_workers;
 };
 
 } // namespace VideoCore
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
@@ -166,6 +167,8 @@ bool RasterizerCache<T>::AccelerateTextureCopy(const GPU::Regs::DisplayTransferC
     runtime.CopyTextures(src_surface, dst_surface, texture_copy);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
+    QueueDownload(src_surface_id);
+    QueueDownload(dst_surface_id);
     return true;
 }
 
@@ -228,6 +231,8 @@ bool RasterizerCache<T>::AccelerateDisplayTransfer(const GPU::Regs::DisplayTrans
     runtime.BlitTextures(src_surface, dst_surface, texture_blit);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
+    QueueDownload(src_surface_id);
+    QueueDownload(dst_surface_id);
     return true;
 }
 
@@ -295,16 +300,8 @@ void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, size_t size, Func&&
     using FuncReturn = typename std::invoke_result<Func, SurfaceId, Surface&>::type;
     static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
     boost::container::small_vector<SurfaceId, 32> surfaces;
-    ForEachPage(addr, size, [this, &surfaces, addr, size, func](u64 page) {
-        const auto it = page_table.find(page);
-        if (it == page_table.end()) {
-            if constexpr (BOOL_BREAK) {
-                return false;
-            } else {
-                return;
-            }
-        }
-        for (const SurfaceId surface_id : it->second) {
+    page_table.ForEachPage(addr, size, [&](std::span<const SurfaceId> page_surfaces) {
+        for (const SurfaceId surface_id : page_surfaces) {
             Surface& surface = slot_surfaces[surface_id];
             if (surface.picked) {
                 continue;
@@ -413,6 +410,9 @@ SurfaceId RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch
         });
     });
 
+    if (match_surface) {
+        slot_surfaces[match_surface].last_use_frame = frame_tick;
+    }
     return match_surface;
 }
 
@@ -783,6 +783,14 @@ auto RasterizerCache<T>::GetFramebufferSurfaces(bool using_color_fb, bool using_
                         boost::icl::length(depth_vp_interval));
     }
 
+    // The game is done rendering to the previous targets, so a readback started now has
+    // likely finished by the time the CPU reads them
+    if (render_targets.color_surface_id != color_surface_id) {
+        QueueDownload(render_targets.color_surface_id);
+    }
+    if (render_targets.depth_surface_id != depth_surface_id) {
+        QueueDownload(render_targets.depth_surface_id);
+    }
     render_targets = RenderTargets{
         .color_surface_id = color_surface_id,
         .depth_surface_id = depth_surface_id,
@@ -949,6 +957,7 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
     if (!source_ptr) [[unlikely]] {
         return;
     }
+    stats.uploads++;
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
 
@@ -1004,6 +1013,9 @@ bool RasterizerCache<T>::UploadCustomSurface(Surface& surface, const SurfacePara
         LOG_ERROR(HW_GPU, "Custom compressed format {} unsupported by host GPU", texture.format);
         return false;
     }
+    if (is_base_level) {
+        SetMemorySize(surface, texture.staging_size);
+    }
 
     // Ensure surface has a compatible allocation before proceeding
     if (!surface.IsCustom() || surface.CustomFormat() != texture.format) {
@@ -1034,25 +1046,54 @@ bool RasterizerCache<T>::UploadCustomSurface(Surface& surface, const SurfacePara
 }
 
 template <class T>
-void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval interval) {
+void RasterizerCache<T>::DownloadSurface(SurfaceId surface_id, SurfaceInterval interval) {
+    Surface& surface = slot_surfaces[surface_id];
     const SurfaceParams flush_info = surface.FromInterval(interval);
     const u32 flush_start = boost::icl::first(interval);
     const u32 flush_end = boost::icl::last_next(interval);
     ASSERT(flush_start >= surface.addr && flush_end <= surface.end);
 
-    const u32 flush_size =
-        flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel();
-    const StagingData staging = runtime.FindStaging(flush_size, false);
+    const auto stall_start = std::chrono::steady_clock::now();
+    StagingData staging{};
+    bool queued = false;
+    if constexpr (Runtime::ASYNC_DOWNLOADS) {
+        const auto IsMatch = [&](const PendingDownload& pending) {
+            return pending.surface_id == surface_id &&
+                   pending.flush_interval == flush_info.GetInterval() &&
+                   pending.modification_tick == surface.ModificationTick() &&
+                   pending.cycle == runtime.DownloadCycle();
+        };
+        const auto it = std::ranges::find_if(pending_downloads, IsMatch);
+        if (it != pending_downloads.end()) {
+            runtime.Wait(it->tick);
+            staging = it->staging;
+            pending_downloads.erase(it);
+            queued = true;
+        }
+    }
 
-    const BufferTextureCopy download = {
-        .buffer_offset = 0,
-        .buffer_size = staging.size,
-        .texture_rect = surface.GetSubRect(flush_info),
-        .texture_level = surface.LevelOf(flush_start),
-    };
-    surface.Download(download, staging);
+    if (queued) {
+        stats.async_downloads++;
+    } else {
+        const u32 flush_size =
+            flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel();
+        staging = runtime.FindStaging(flush_size, false);
+
+        const BufferTextureCopy download = {
+            .buffer_offset = 0,
+            .buffer_size = staging.size,
+            .texture_rect = surface.GetSubRect(flush_info),
+            .texture_level = surface.LevelOf(flush_start),
+        };
+        surface.Download(download, staging);
 
-    runtime.Finish();
+        runtime.Finish();
+        surface.readback_interval = interval;
+        stats.downloads++;
+    }
+    stats.download_stall_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - stall_start)
+                                   .count();
 
     MemoryRef dest_ptr = memory.GetPhysicalRef(flush_start);
     if (!dest_ptr) [[unlikely]] {
@@ -1064,6 +1105,59 @@ void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval inter
                   runtime.NeedsConvertion(surface.pixel_format));
 }
 
+template <class T>
+void RasterizerCache<T>::QueueDownload(SurfaceId surface_id) {
+    if constexpr (Runtime::ASYNC_DOWNLOADS) {
+        if (!slot_surfaces.contains(surface_id)) {
+            return;
+        }
+        Surface& surface = slot_surfaces[surface_id];
+        const SurfaceInterval interval = surface.readback_interval;
+        if (!surface.registered || boost::icl::is_empty(interval) ||
+            surface.type == SurfaceType::Fill || surface.type == SurfaceType::DepthStencil) {
+            return;
+        }
+
+        // Only regions last written by this surface are flushed from it
+        const auto owners = RangeFromInterval(dirty_regions, interval);
+        if (std::none_of(owners.begin(), owners.end(),
+                         [surface_id](const auto& pair) { return pair.second == surface_id; })) {
+            return;
+        }
+        const u64 modification_tick = surface.ModificationTick();
+        std::erase_if(pending_downloads, [&](const PendingDownload& pending) {
+            return pending.surface_id == surface_id &&
+                   pending.modification_tick != modification_tick;
+        });
+        if (std::ranges::any_of(pending_downloads, [surface_id](const PendingDownload& pending) {
+                return pending.surface_id == surface_id;
+            })) {
+            return;
+        }
+
+        const SurfaceParams flush_info = surface.FromInterval(interval);
+        const u32 flush_size =
+            flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel();
+        const StagingData staging = runtime.FindStaging(flush_size, false);
+        const BufferTextureCopy download = {
+            .buffer_offset = 0,
+            .buffer_size = staging.size,
+            .texture_rect = surface.GetSubRect(flush_info),
+            .texture_level = surface.LevelOf(flush_info.addr),
+        };
+        surface.Download(download, staging);
+
+        pending_downloads.push_back(PendingDownload{
+            .surface_id = surface_id,
+            .flush_interval = flush_info.GetInterval(),
+            .modification_tick = modification_tick,
+            .tick = runtime.Submit(),
+            .cycle = runtime.DownloadCycle(),
+            .staging = staging,
+        });
+    }
+}
+
 template <class T>
 void RasterizerCache<T>::DownloadFillSurface(Surface& surface, SurfaceInterval interval) {
     const u32 flush_start = boost::icl::first(interval);
@@ -1129,7 +1223,7 @@ template <class T>
 bool RasterizerCache<T>::IntervalHasInvalidPixelFormat(SurfaceParams params,
                                                        SurfaceInterval interval) {
     bool invalid_format_found = false;
-    ForEachSurfaceInRegion(params.addr, params.end, [&](SurfaceId surface_id, Surface& surface) {
+    ForEachSurfaceInRegion(params.addr, params.size, [&](SurfaceId surface_id, Surface& surface) {
         if (surface.pixel_format == PixelFormat::Invalid) {
             LOG_DEBUG(HW_GPU, "Surface {:#x} found with invalid pixel format", surface.addr);
             invalid_format_found = true;
@@ -1186,8 +1280,97 @@ void RasterizerCache<T>::ClearAll(bool flush) {
     // Remove the whole cache without really looking at it.
     cached_pages -= flush_interval;
     dirty_regions -= SurfaceInterval(0x0, 0xFFFFFFFF);
-    page_table.clear();
+    page_table.Clear();
     remove_surfaces.clear();
+    pending_downloads.clear();
+
+    // The surfaces are no longer reachable from the page table
+    for (auto [surface_id, surface] : slot_surfaces) {
+        surface->registered = false;
+    }
+    memory_size = 0;
+    live_surfaces = 0;
+}
+
+template <class T>
+void RasterizerCache<T>::TickFrame() {
+    const u64 budget = u64{Settings::values.texture_cache_budget.GetValue()} << 20;
+    if (budget != 0 && memory_size > budget) {
+        EvictSurfaces(budget);
+    }
+
+    // Readbacks of surfaces that were drawn to again will not be used
+    if constexpr (Runtime::ASYNC_DOWNLOADS) {
+        std::erase_if(pending_downloads, [this](const PendingDownload& pending) {
+            return pending.modification_tick !=
+                       slot_surfaces[pending.surface_id].ModificationTick() ||
+                   pending.cycle != runtime.DownloadCycle();
+        });
+    }
+
+    stats.live_surfaces = live_surfaces;
+    stats.memory_size = memory_size;
+    LOG_TRACE(HW_GPU, "Surface cache: {} surfaces using {} KiB, {} evictions, {} uploads",
+              stats.live_surfaces, stats.memory_size >> 10, stats.evictions, stats.uploads);
+    LOG_TRACE(HW_GPU, "Downloads: {} blocking, {} queued, {} us stalled", stats.downloads,
+              stats.async_downloads, stats.download_stall_us);
+    last_stats = std::exchange(stats, {});
+    frame_tick++;
+}
+
+template <class T>
+void RasterizerCache<T>::EvictSurfaces(u64 budget) {
+    std::vector<std::pair<u64, SurfaceId>> candidates;
+    for (auto [surface_id, surface] : slot_surfaces) {
+        const bool is_render_target = surface_id == render_targets.color_surface_id ||
+                                      surface_id == render_targets.depth_surface_id;
+        if (surface->registered && surface->memory_size != 0 &&
+            surface->last_use_frame < frame_tick && !is_render_target) {
+            candidates.emplace_back(surface->last_use_frame, surface_id);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    const auto IsDirty = [this](SurfaceId surface_id, const Surface& surface) {
+        for (const auto& [interval, owner_id] :
+             RangeFromInterval(dirty_regions, surface.GetInterval())) {
+            if (owner_id == surface_id) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Clean surfaces can be recreated from guest memory, so drop the stale ones first
+    for (auto& [last_use_frame, surface_id] : candidates) {
+        if (memory_size <= budget || frame_tick - last_use_frame < MIN_EVICTION_AGE) {
+            break;
+        }
+        if (IsDirty(surface_id, slot_surfaces[surface_id])) {
+            continue;
+        }
+        UnregisterSurface(surface_id);
+        stats.evictions++;
+        surface_id = {};
+    }
+
+    // Past the hard cap anything not used this frame goes, dirty surfaces are written back first
+    if (memory_size <= budget + budget / 2) {
+        return;
+    }
+    for (const auto& [last_use_frame, surface_id] : candidates) {
+        if (memory_size <= budget) {
+            break;
+        }
+        if (!surface_id) {
+            continue;
+        }
+        const Surface& surface = slot_surfaces[surface_id];
+        FlushRegion(surface.addr, surface.size, surface_id);
+        UnregisterSurface(surface_id);
+        stats.evictions++;
+    }
 }
 
 template <class T>
@@ -1219,7 +1402,7 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
         if (surface.type == SurfaceType::Fill) {
             DownloadFillSurface(surface, interval);
         } else {
-            DownloadSurface(surface, interval);
+            DownloadSurface(surface_id, interval);
         }
 
         flushed_intervals += interval;
@@ -1229,6 +1412,48 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
     dirty_regions -= flushed_intervals;
 }
 
+template <class T>
+bool RasterizerCache<T>::IsRegionDirty(PAddr addr, u32 size) const {
+    if (size == 0) [[unlikely]] {
+        return false;
+    }
+    return boost::icl::intersects(dirty_regions, SurfaceInterval(addr, addr + size));
+}
+
+template <class T>
+void RasterizerCache<T>::TrackRegion(PAddr addr, u32 size, bool track) {
+    if (size == 0) [[unlikely]] {
+        return;
+    }
+
+    // Marking the pages as cached routes the CPU writes to them through InvalidateRegion
+    const SurfaceInterval interval{addr, addr + size};
+    UpdatePagesCachedCount(addr, size, track ? 1 : -1);
+    tracked_regions.add({interval, track ? 1 : -1});
+    if (track) {
+        return;
+    }
+
+    // Forget the writes to the parts no longer tracked
+    SurfaceRegions released{interval};
+    for (const auto& [tracked_interval, count] : RangeFromInterval(tracked_regions, interval)) {
+        released -= tracked_interval;
+    }
+    for (const auto& released_interval : released) {
+        write_ticks.erase(released_interval);
+    }
+}
+
+template <class T>
+u64 RasterizerCache<T>::GetWriteTick(PAddr addr, u32 size) const {
+    const SurfaceInterval interval{addr, addr + size};
+    u64 tick = 0;
+    for (const auto& [written_interval, written_tick] : RangeFromInterval(write_ticks, interval)) {
+        tick = std::max(tick, written_tick);
+    }
+    return tick;
+}
+
 template <class T>
 void RasterizerCache<T>::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
@@ -1243,6 +1468,9 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     MICROPROFILE_SCOPE(RasterizerCache_Invalidation);
 
     const SurfaceInterval invalid_interval{addr, addr + size};
+    if (boost::icl::intersects(tracked_regions, invalid_interval)) {
+        write_ticks.add({invalid_interval, ++write_tick});
+    }
     if (region_owner_id) {
         Surface& region_owner = slot_surfaces[region_owner_id];
         // Texture surfaces are not renderable
@@ -1294,6 +1522,7 @@ SurfaceId RasterizerCache<T>::CreateSurface(const SurfaceParams& params) {
     SurfaceId surface_id = slot_surfaces.insert(runtime, params);
     Surface& surface = slot_surfaces[surface_id];
     surface.MarkInvalid(surface.GetInterval());
+    surface.last_use_frame = frame_tick;
     return surface_id;
 }
 
@@ -1304,8 +1533,15 @@ void RasterizerCache<T>::RegisterSurface(SurfaceId surface_id) {
 
     surface.registered = true;
     UpdatePagesCachedCount(surface.addr, surface.size, 1);
-    ForEachPage(surface.addr, surface.size,
-                [&](u64 page) { page_table[page].push_back(surface_id); });
+    page_table.Insert(surface.addr, surface.size, surface_id);
+
+    live_surfaces++;
+    if (surface.type != SurfaceType::Fill) {
+        // Mipmap chains add up to a third of the base level size
+        const u64 base_size = u64{surface.GetScaledWidth()} * surface.GetScaledHeight() *
+                              surface.GetInternalBytesPerPixel();
+        SetMemorySize(surface, surface.levels > 1 ? base_size * 4 / 3 : base_size);
+    }
 }
 
 template <class T>
@@ -1313,24 +1549,17 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
     Surface& surface = slot_surfaces[surface_id];
     ASSERT_MSG(surface.registered, "Trying to unregister an already unregistered surface");
 
+    std::erase_if(pending_downloads, [surface_id](const PendingDownload& pending) {
+        return pending.surface_id == surface_id;
+    });
+    SetMemorySize(surface, 0);
     surface.registered = false;
+    live_surfaces--;
     UpdatePagesCachedCount(surface.addr, surface.size, -1);
 
-    ForEachPage(surface.addr, surface.size, [&](u64 page) {
-        const auto page_it = page_table.find(page);
-        if (page_it == page_table.end()) {
-            ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << CITRA_PAGEBITS);
-            return;
-        }
-        std::vector<SurfaceId>& surface_ids = page_it->second;
-        const auto vector_it = std::find(surface_ids.begin(), surface_ids.end(), surface_id);
-        if (vector_it == surface_ids.end()) {
-            ASSERT_MSG(false, "Unregistering unregistered surface in page=0x{:x}",
-                       page << CITRA_PAGEBITS);
-            return;
-        }
-        surface_ids.erase(vector_it);
-    });
+    if (!page_table.Erase(surface.addr, surface.size, surface_id)) {
+        ASSERT_MSG(false, "Unregistering unregistered surface at addr=0x{:x}", surface.addr);
+    }
 
     slot_surfaces.erase(surface_id);
 }
@@ -1338,12 +1567,16 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 template <class T>
 void RasterizerCache<T>::UnregisterAll() {
     FlushAll();
-    for (auto& [page, surfaces] : page_table) {
-        while (!surfaces.empty()) {
-            UnregisterSurface(surfaces.back());
+    std::vector<SurfaceId> registered_surfaces;
+    for (auto [surface_id, surface] : slot_surfaces) {
+        if (surface->registered) {
+            registered_surfaces.push_back(surface_id);
         }
     }
-    page_table.clear();
+    for (const SurfaceId surface_id : registered_surfaces) {
+        UnregisterSurface(surface_id);
+    }
+    page_table.Clear();
     texture_cube_cache.clear();
     remove_surfaces.clear();
     runtime.Clear();
@@ -1385,4 +1618,12 @@ void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta)
     }
 }
 
+template <class T>
+void RasterizerCache<T>::SetMemorySize(Surface& surface, u64 size) {
+    if (surface.registered) {
+        memory_size = memory_size - surface.memory_size + size;
+    }
+    surface.memory_size = size;
+}
+
 } // namespace VideoCore
@@ -10,6 +10,7 @@
 #include <unordered_set>
 #include <boost/icl/interval_map.hpp>
 #include "video_core/rasterizer_cache/sampler_params.h"
+#include "video_core/rasterizer_cache/surface_page_table.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/utils.h"
 #include "video_core/texture/texture_decode.h"
@@ -38,10 +39,21 @@ DECLARE_ENUM_FLAG_OPERATORS(MatchFlags);
 
 class CustomTexManager;
 
+/// Host memory usage of the surface cache and the work it did during a frame
+struct CacheStats {
+    u32 live_surfaces{};
+    u64 memory_size{};
+    u32 evictions{};
+    u32 uploads{};
+    u32 downloads{};       ///< Downloads that waited for the GPU to finish all work
+    u32 async_downloads{}; ///< Downloads served by a readback queued ahead of time
+    u64 download_stall_us{};
+};
+
 template <class T>
 class RasterizerCache {
-    /// Address shift for caching surfaces into a hash table
-    static constexpr u64 CITRA_PAGEBITS = 18;
+    /// Number of frames a clean surface must stay unused before it may be evicted
+    static constexpr u64 MIN_EVICTION_AGE = 60;
 
     using Runtime = typename T::Runtime;
     using Surface = typename T::Surface;
@@ -55,6 +67,12 @@ class RasterizerCache {
 
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
     using PageMap = boost::icl::interval_map<u32, int>;
+    using TrackedMap = boost::icl::interval_map<PAddr, int, boost::icl::partial_absorber,
+                                                std::less, boost::icl::inplace_plus,
+                                                boost::icl::inter_section, SurfaceInterval>;
+    using WriteTickMap = boost::icl::interval_map<PAddr, u64, boost::icl::partial_absorber,
+                                                  std::less, boost::icl::inplace_max,
+                                                  boost::icl::inter_section, SurfaceInterval>;
 
     struct RenderTargets {
         SurfaceId color_surface_id;
@@ -66,6 +84,16 @@ class RasterizerCache {
         std::array<s64, 6> ticks{};
     };
 
+    /// Readback of a surface region recorded before the CPU asked for it
+    struct PendingDownload {
+        SurfaceId surface_id;
+        SurfaceInterval flush_interval;
+        u64 modification_tick;
+        u64 tick;
+        u64 cycle;
+        StagingData staging;
+    };
+
 public:
     RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
                     Runtime& runtime);
@@ -118,6 +146,15 @@ public:
     /// Write any cached resources overlapping the region back to memory (if dirty)
     void FlushRegion(PAddr addr, u32 size, SurfaceId flush_surface_id = {});
 
+    /// Returns true if a cached resource overlapping the region was not written back to memory
+    bool IsRegionDirty(PAddr addr, u32 size) const;
+
+    /// Starts or stops tracking the writes to a region the rasterizer keeps a host copy of
+    void TrackRegion(PAddr addr, u32 size, bool track);
+
+    /// Returns a value that changes with every write to a tracked region overlapping the region
+    u64 GetWriteTick(PAddr addr, u32 size) const;
+
     /// Mark region as being invalidated by region_owner (nullptr if 3DS memory)
     void InvalidateRegion(PAddr addr, u32 size, SurfaceId region_owner_id = {});
 
@@ -127,23 +164,15 @@ public:
     /// Clear all cached resources tracked by this cache manager
     void ClearAll(bool flush);
 
-private:
-    /// Iterate over all page indices in a range
-    template <typename Func>
-    void ForEachPage(PAddr addr, size_t size, Func&& func) {
-        static constexpr bool RETURNS_BOOL = std::is_same_v<std::invoke_result<Func, u64>, bool>;
-        const u64 page_end = (addr + size - 1) >> CITRA_PAGEBITS;
-        for (u64 page = addr >> CITRA_PAGEBITS; page <= page_end; ++page) {
-            if constexpr (RETURNS_BOOL) {
-                if (func(page)) {
-                    break;
-                }
-            } else {
-                func(page);
-            }
-        }
+    /// Marks the end of a frame and evicts surfaces if the memory budget is exceeded
+    void TickFrame();
+
+    /// Returns the statistics of the last completed frame
+    const CacheStats& GetStats() const noexcept {
+        return last_stats;
     }
 
+private:
     /// Iterates over all the surfaces in a region calling func
     template <typename Func>
     void ForEachSurfaceInRegion(PAddr addr, size_t size, Func&& func);
@@ -167,7 +196,10 @@ private:
                              std::span<u8> upload_data);
 
     /// Copies pixel data in interval from the host GPU surface to the guest VRAM
-    void DownloadSurface(Surface& surface, SurfaceInterval interval);
+    void DownloadSurface(SurfaceId surface_id, SurfaceInterval interval);
+
+    /// Starts reading back the region of the surface the CPU read last time, if still dirty
+    void QueueDownload(SurfaceId surface_id);
 
     /// Downloads a fill surface to guest VRAM
     void DownloadFillSurface(Surface& surface, SurfaceInterval interval);
@@ -198,19 +230,29 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Sets the host memory size accounted for a surface
+    void SetMemorySize(Surface& surface, u64 size);
+
+    /// Unregisters least recently used surfaces until the cache fits in budget bytes
+    void EvictSurfaces(u64 budget);
+
 private:
     Memory::MemorySystem& memory;
     Runtime& runtime;
     CustomTexManager& custom_tex_manager;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
+    TrackedMap tracked_regions;
+    WriteTickMap write_ticks;
+    u64 write_tick{};
     std::vector<SurfaceId> remove_surfaces;
+    std::vector<PendingDownload> pending_downloads;
     u16 resolution_scale_factor;
 
     // The internal surface cache is based on buckets of 256KB.
     // This fits better for the purpose of this cache as textures are normaly
     // large in size.
-    std::unordered_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
+    SurfacePageTable page_table;
     std::unordered_map<SamplerParams, SamplerId> samplers;
     std::unordered_map<TextureCubeConfig, CubeParams> texture_cube_cache;
 
@@ -218,6 +260,13 @@ private:
     SlotVector<Sampler> slot_samplers;
     RenderTargets render_targets;
 
+    // Memory budget
+    u64 frame_tick = 0;
+    u64 memory_size = 0;
+    u32 live_surfaces = 0;
+    CacheStats stats{};
+    CacheStats last_stats{};
+
     // Custom textures
     bool dump_textures;
     bool use_custom_textures;
@@ -115,6 +115,11 @@ public:
         return SlotId{index};
     }
 
+    [[nodiscard]] bool contains(SlotId id) const noexcept {
+        return id && id.index / 64 < stored_bitset.size() &&
+               ((stored_bitset[id.index / 64] >> (id.index % 64)) & 1) != 0;
+    }
+
     void erase(SlotId id) noexcept {
         values[id.index].object.~T();
         free_list.push_back(id.index);
@@ -127,7 +132,7 @@ public:
         if (it == stored_bitset.end()) {
             return end();
         }
-        const u32 word_index = static_cast<u32>(std::distance(it, stored_bitset.begin()));
+        const u32 word_index = static_cast<u32>(std::distance(stored_bitset.begin(), it));
         const SlotId first_id{word_index * 64 + static_cast<u32>(std::countr_zero(*it))};
         return Iterator(this, first_id);
     }
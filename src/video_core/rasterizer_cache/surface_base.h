@@ -77,6 +77,9 @@ public:
     std::array<u8, 4> fill_data;
     u32 fill_size = 0;
     u64 modification_tick = 1;
+    u64 last_use_frame = 0;
+    u64 memory_size = 0;
+    SurfaceInterval readback_interval{};
 };
 
 } // namespace VideoCore
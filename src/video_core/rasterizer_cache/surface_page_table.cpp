@@ -0,0 +1,61 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "video_core/rasterizer_cache/surface_page_table.h"
+
+namespace VideoCore {
+
+void SurfacePageTable::Insert(PAddr addr, u32 size, SurfaceId surface_id) {
+    const u64 page_end = (u64{addr} + size - 1) >> PAGE_BITS;
+    for (u64 page = addr >> PAGE_BITS; page <= page_end; ++page) {
+        std::unique_ptr<Chunk>& chunk = chunks[page / 64];
+        if (!chunk) {
+            chunk = std::make_unique<Chunk>();
+        }
+        chunk->pages[page % 64].push_back(surface_id);
+        occupied[page / 64] |= 1ULL << (page % 64);
+    }
+}
+
+bool SurfacePageTable::Erase(PAddr addr, u32 size, SurfaceId surface_id) {
+    bool found = true;
+    const u64 page_end = (u64{addr} + size - 1) >> PAGE_BITS;
+    for (u64 page = addr >> PAGE_BITS; page <= page_end; ++page) {
+        const std::unique_ptr<Chunk>& chunk = chunks[page / 64];
+        if (!chunk) {
+            found = false;
+            continue;
+        }
+        std::vector<SurfaceId>& surface_ids = chunk->pages[page % 64];
+        const auto it = std::find(surface_ids.begin(), surface_ids.end(), surface_id);
+        if (it == surface_ids.end()) {
+            found = false;
+            continue;
+        }
+        surface_ids.erase(it);
+        if (surface_ids.empty()) {
+            occupied[page / 64] &= ~(1ULL << (page % 64));
+        }
+    }
+    return found;
+}
+
+void SurfacePageTable::Clear() {
+    for (std::unique_ptr<Chunk>& chunk : chunks) {
+        chunk.reset();
+    }
+    occupied.fill(0);
+}
+
+bool SurfacePageTable::IsEmpty(PAddr addr, u64 size) const {
+    bool empty = true;
+    ForEachPage(addr, size, [&empty](std::span<const SurfaceId>) {
+        empty = false;
+        return true;
+    });
+    return empty;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,87 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "video_core/rasterizer_cache/utils.h"
+
+namespace VideoCore {
+
+/**
+ * Maps the guest physical address space, in buckets of 256KB, to the surfaces overlapping each
+ * bucket. A bitmap of the occupied buckets lets lookups skip 16MB of uncached memory per word,
+ * so the cost of a lookup scales with the number of cached buckets in the region instead of
+ * the size of the region. The surface lists are allocated in chunks matching the bitmap words.
+ */
+class SurfacePageTable {
+public:
+    /// Address shift of the buckets
+    static constexpr u32 PAGE_BITS = 18;
+
+    /// Adds the surface to all buckets overlapping the region
+    void Insert(PAddr addr, u32 size, SurfaceId surface_id);
+
+    /// Removes the surface from all buckets overlapping the region.
+    /// Returns false if it was missing from any of them.
+    bool Erase(PAddr addr, u32 size, SurfaceId surface_id);
+
+    /// Removes all surfaces
+    void Clear();
+
+    /// Returns true if no bucket overlapping the region holds a surface
+    [[nodiscard]] bool IsEmpty(PAddr addr, u64 size) const;
+
+    /// Calls func with the surfaces of every occupied bucket overlapping the region in address
+    /// order. Stops early if func returns true.
+    template <typename Func>
+    void ForEachPage(PAddr addr, u64 size, Func&& func) const {
+        static constexpr bool RETURNS_BOOL =
+            std::is_same_v<std::invoke_result_t<Func, std::span<const SurfaceId>>, bool>;
+        if (size == 0) {
+            return;
+        }
+        const u64 page_start = addr >> PAGE_BITS;
+        const u64 page_end = std::min<u64>((addr + size - 1) >> PAGE_BITS, NUM_PAGES - 1);
+        for (u64 word = page_start / 64; word <= page_end / 64; ++word) {
+            u64 bits = occupied[word];
+            if (word == page_start / 64) {
+                bits &= ~0ULL << (page_start % 64);
+            }
+            if (word == page_end / 64) {
+                bits &= ~0ULL >> (63 - page_end % 64);
+            }
+            while (bits != 0) {
+                const std::span<const SurfaceId> surfaces =
+                    chunks[word]->pages[std::countr_zero(bits)];
+                bits &= bits - 1;
+                if constexpr (RETURNS_BOOL) {
+                    if (func(surfaces)) {
+                        return;
+                    }
+                } else {
+                    func(surfaces);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t NUM_PAGES = (1ULL << 32) >> PAGE_BITS;
+
+    struct Chunk {
+        std::array<std::vector<SurfaceId>, 64> pages;
+    };
+
+    std::array<std::unique_ptr<Chunk>, NUM_PAGES / 64> chunks;
+    std::array<u64, NUM_PAGES / 64> occupied{};
+};
+
+} // namespace VideoCore
@@ -32,9 +32,13 @@ public:
                              const Pica::Shader::OutputVertex& v1,
                              const Pica::Shader::OutputVertex& v2) = 0;
 
-    /// Draw the current batch of triangles
+    /// Draw the current batch of triangles. The rasterizer may keep them back to merge them with
+    /// the triangles of the following draws.
     virtual void DrawTriangles() = 0;
 
+    /// Draw the triangles and the accelerated draws kept back for merging
+    virtual void DrawPendingTriangles() {}
+
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
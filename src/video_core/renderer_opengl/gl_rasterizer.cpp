@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <utility>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -25,6 +26,7 @@ MICROPROFILE_DEFINE(OpenGL_VS, "OpenGL", "Vertex Shader Setup", MP_RGB(192, 128,
 MICROPROFILE_DEFINE(OpenGL_GS, "OpenGL", "Geometry Shader Setup", MP_RGB(128, 192, 128));
 MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
 
+using VideoCore::DirtyRegs;
 using VideoCore::SurfaceType;
 
 constexpr std::size_t VERTEX_BUFFER_SIZE = 16 * 1024 * 1024;
@@ -164,6 +166,7 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
     state.Apply();
 
     std::array<bool, 16> enable_attributes{};
+    attrib_pointers.clear();
 
     for (const auto& loader : vertex_attributes.attribute_loaders) {
         if (loader.component_count == 0 || loader.byte_count == 0) {
@@ -185,6 +188,7 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                     GLsizei stride = loader.byte_count;
                     glVertexAttribPointer(input_reg, size, type, GL_FALSE, stride,
                                           reinterpret_cast<GLvoid*>(buffer_offset + offset));
+                    attrib_pointers.push_back({input_reg, size, type, offset});
                     enable_attributes[input_reg] = true;
 
                     offset += vertex_attributes.GetStride(attribute_index);
@@ -233,11 +237,13 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
 
 bool RasterizerOpenGL::SetupVertexShader() {
     MICROPROFILE_SCOPE(OpenGL_VS);
+    dirty_regs &= ~DirtyRegs::VertexConfig;
     return shader_program_manager.UseProgrammableVertexShader(regs, Pica::g_state.vs);
 }
 
 bool RasterizerOpenGL::SetupGeometryShader() {
     MICROPROFILE_SCOPE(OpenGL_GS);
+    dirty_regs &= ~DirtyRegs::GeometryConfig;
 
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
         LOG_ERROR(Render_OpenGL, "Accelerate draw doesn't support geometry shader");
@@ -249,6 +255,10 @@ bool RasterizerOpenGL::SetupGeometryShader() {
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
+    if (!vertex_batch.empty()) {
+        DrawPendingTriangles();
+    }
+
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
         if (regs.pipeline.gs_config.mode != Pica::PipelineRegs::GSMode::Point) {
             return false;
@@ -258,12 +268,20 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
         }
     }
 
+    vertex_info = AnalyzeVertexArray(is_indexed);
+    if (CanMergeDraw(is_indexed) && MergedUploadSize() <= VERTEX_BUFFER_SIZE) {
+        MergeDraw();
+        return true;
+    }
+    DrawPendingTriangles();
+
     if (!SetupVertexShader())
         return false;
 
     if (!SetupGeometryShader())
         return false;
 
+    draw_stats.submitted++;
     return Draw(true, is_indexed);
 }
 
@@ -285,7 +303,7 @@ static GLenum MakePrimitiveMode(Pica::PipelineRegs::TriangleTopology topology) {
 
 bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
     const GLenum primitive_mode = MakePrimitiveMode(regs.pipeline.triangle_topology);
-    auto [vs_input_index_min, vs_input_index_max, vs_input_size] = AnalyzeVertexArray(is_indexed);
+    const auto [vs_input_index_min, vs_input_index_max, vs_input_size] = vertex_info;
 
     if (vs_input_size > VERTEX_BUFFER_SIZE) {
         LOG_WARNING(Render_OpenGL, "Too large vertex input size {}", vs_input_size);
@@ -299,6 +317,7 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
     GLintptr buffer_offset;
     std::tie(buffer_ptr, buffer_offset, std::ignore) = vertex_buffer.Map(vs_input_size, 4);
     SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
+    const GLintptr vertex_offset = buffer_offset;
     vertex_buffer.Unmap(vs_input_size);
 
     shader_program_manager.ApplyTo(state);
@@ -320,24 +339,83 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
         std::memcpy(buffer_ptr, index_data, index_buffer_size);
         index_buffer.Unmap(index_buffer_size);
 
-        glDrawRangeElementsBaseVertex(
-            primitive_mode, vs_input_index_min, vs_input_index_max, regs.pipeline.num_vertices,
-            index_u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
-            reinterpret_cast<const void*>(buffer_offset), -static_cast<GLint>(vs_input_index_min));
+        const DrawParams params = {
+            .mode = primitive_mode,
+            .index_min = vs_input_index_min,
+            .index_max = vs_input_index_max,
+            .count = static_cast<GLsizei>(regs.pipeline.num_vertices),
+            .index_type = index_u16 ? GLenum{GL_UNSIGNED_SHORT} : GLenum{GL_UNSIGNED_BYTE},
+            .index_offset = buffer_offset,
+            .base_vertex = -static_cast<GLint>(vs_input_index_min),
+        };
+        if (HoldMergedDraw(is_indexed, 1)) {
+            held_draw = params;
+            held_vertex_offset = vertex_offset;
+            return true;
+        }
+        DrawElements(params);
     } else {
         glDrawArrays(primitive_mode, 0, regs.pipeline.num_vertices);
     }
     return true;
 }
 
-void RasterizerOpenGL::DrawTriangles() {
-    if (vertex_batch.empty())
+void RasterizerOpenGL::DrawMergedBatch() {
+    if (merged_draw.draws == 1) {
+        DrawElements(held_draw);
         return;
+    }
+
+    // The held back draw left its vertex array, program and framebuffer bound, and its vertices
+    // in the vertex buffer. Only the vertices of the appended draws are uploaded next to them.
+    // The buffer is large enough that wrapping around can't overwrite the held back vertices.
+    u8* buffer_ptr;
+    GLintptr vertex_offset;
+    const std::size_t vertex_size = merged_draw.vertices.size() + merged_draw.stride;
+    std::tie(buffer_ptr, vertex_offset, std::ignore) = vertex_buffer.Map(vertex_size, 4);
+    const MergedUpload upload = UploadMergedVertices(buffer_ptr, vertex_offset, held_vertex_offset);
+    vertex_buffer.Unmap(upload.size);
+    for (const AttribPointer& pointer : attrib_pointers) {
+        glVertexAttribPointer(pointer.index, pointer.size, pointer.type, GL_FALSE,
+                              static_cast<GLsizei>(merged_draw.stride),
+                              reinterpret_cast<GLvoid*>(upload.base_offset + pointer.offset));
+    }
+
+    const std::size_t index_size = merged_draw.indices.size() * sizeof(u32);
+    GLintptr index_offset;
+    std::tie(buffer_ptr, index_offset, std::ignore) = index_buffer.Map(index_size, 4);
+    WriteMergedIndices(reinterpret_cast<u32*>(buffer_ptr), upload);
+    index_buffer.Unmap(index_size);
+
+    const auto appended_vertices =
+        static_cast<u32>(merged_draw.vertices.size() / merged_draw.stride);
+    const u32 vertex_end = std::max(upload.first_vertex + merged_draw.first.vertex_count,
+                                    upload.appended_vertex + appended_vertices);
+    DrawElements({
+        .mode = GL_TRIANGLES,
+        .index_min = 0,
+        .index_max = vertex_end - 1,
+        .count = static_cast<GLsizei>(merged_draw.indices.size()),
+        .index_type = GL_UNSIGNED_INT,
+        .index_offset = index_offset,
+        .base_vertex = 0,
+    });
+}
+
+void RasterizerOpenGL::DrawElements(const DrawParams& params) {
+    glDrawRangeElementsBaseVertex(params.mode, params.index_min, params.index_max, params.count,
+                                  params.index_type,
+                                  reinterpret_cast<const void*>(params.index_offset),
+                                  params.base_vertex);
+}
+
+void RasterizerOpenGL::DrawVertexBatch() {
     Draw(false, false);
 }
 
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
+    draw_stats.issued++;
 
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
     const bool has_stencil = regs.framebuffer.HasStencil();
@@ -404,9 +482,9 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     SyncTextureUnits(framebuffer);
 
     // Sync and bind the shader
-    if (shader_dirty) {
+    if (True(dirty_regs & DirtyRegs::FragmentConfig)) {
         SetShader();
-        shader_dirty = false;
+        dirty_regs &= ~DirtyRegs::FragmentConfig;
     }
 
     // Sync the LUTs within the texture buffer
@@ -649,6 +727,18 @@ void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
     res_cache.FlushRegion(addr, size);
 }
 
+bool RasterizerOpenGL::IsRegionDirty(PAddr addr, u32 size) const {
+    return res_cache.IsRegionDirty(addr, size);
+}
+
+void RasterizerOpenGL::TrackRegion(PAddr addr, u32 size, bool track) {
+    res_cache.TrackRegion(addr, size, track);
+}
+
+u64 RasterizerOpenGL::GetWriteTick(PAddr addr, u32 size) const {
+    return res_cache.GetWriteTick(addr, size);
+}
+
 void RasterizerOpenGL::InvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size);
 }
@@ -659,9 +749,18 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
 }
 
 void RasterizerOpenGL::ClearAll(bool flush) {
+    ClearIndexRanges();
     res_cache.ClearAll(flush);
 }
 
+void RasterizerOpenGL::TickFrame() {
+    LOG_TRACE(Render_OpenGL, "Draws: {} submitted, {} issued", draw_stats.submitted,
+              draw_stats.issued);
+    last_draw_stats = std::exchange(draw_stats, {});
+    TickIndexRanges();
+    res_cache.TickFrame();
+}
+
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     return res_cache.AccelerateDisplayTransfer(config);
 }
@@ -772,7 +871,7 @@ void RasterizerOpenGL::SyncBlendColor() {
 void RasterizerOpenGL::SyncLogicOp() {
     if (driver.IsOpenGLES()) {
         // With GLES, we need this in the fragment shader to emulate logic operations
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
     }
 
     state.logic_op = PicaToGL::LogicOp(regs.framebuffer.output_merger.logic_op);
@@ -36,7 +36,6 @@ public:
     void LoadDiskResources(const std::atomic_bool& stop_loading,
                            const VideoCore::DiskResourceLoadCallback& callback) override;
 
-    void DrawTriangles() override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
@@ -51,8 +50,35 @@ public:
 
     void SyncFixedState() override;
 
+    /// Marks the end of a frame, resets the draw counters and trims the texture cache
+    void TickFrame();
+
 private:
+    /// Arguments of an indexed accelerated draw
+    struct DrawParams {
+        GLenum mode;
+        GLuint index_min;
+        GLuint index_max;
+        GLsizei count;
+        GLenum index_type;
+        GLintptr index_offset;
+        GLint base_vertex;
+    };
+
+    /// Vertex attribute pointer, relative to the start of the vertex data
+    struct AttribPointer {
+        GLuint index;
+        GLint size;
+        GLenum type;
+        u32 offset;
+    };
+
     void NotifyFixedFunctionPicaRegisterChanged(u32 id) override;
+    void DrawVertexBatch() override;
+    void DrawMergedBatch() override;
+    bool IsRegionDirty(PAddr addr, u32 size) const override;
+    void TrackRegion(PAddr addr, u32 size, bool track) override;
+    u64 GetWriteTick(PAddr addr, u32 size) const override;
 
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
@@ -109,12 +135,15 @@ private:
     /// Upload the uniform blocks to the uniform buffer object
     void UploadUniforms(bool accelerate_draw);
 
-    /// Generic draw function for DrawTriangles and AccelerateDrawBatch
+    /// Generic draw function for DrawVertexBatch and AccelerateDrawBatch
     bool Draw(bool accelerate, bool is_indexed);
 
     /// Internal implementation for AccelerateDrawBatch
     bool AccelerateDrawBatchInternal(bool is_indexed);
 
+    /// Issues an indexed accelerated draw
+    void DrawElements(const DrawParams& params);
+
     /// Setup vertex array for AccelerateDrawBatch
     void SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
                           GLuint vs_input_index_max);
@@ -135,6 +164,9 @@ private:
     OGLVertexArray sw_vao; // VAO for software shader draw
     OGLVertexArray hw_vao; // VAO for hardware shader / accelerate draw
     std::array<bool, 16> hw_vao_enabled_attributes{};
+    std::vector<AttribPointer> attrib_pointers; ///< Set up for the last accelerated draw
+    DrawParams held_draw{};
+    GLintptr held_vertex_offset{}; ///< Offset of the vertex data of the held back draw
 
     StreamBuffer vertex_buffer;
     StreamBuffer uniform_buffer;
@@ -499,15 +499,15 @@ private:
                         dot = fmt::format("dot(vec3({}), vec3({}))", src1, src2);
                     }
                 } else {
+                    // DPH uses 1.0 for the w component of the first operand
+                    const std::string src1_ =
+                        (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
+                            ? fmt::format("vec4({}.xyz, 1.0)", src1)
+                            : std::move(src1);
                     if (sanitize_mul) {
-                        const std::string src1_ =
-                            (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
-                                ? fmt::format("vec4({}.xyz, 1.0)", src1)
-                                : std::move(src1);
-
                         dot = fmt::format("dot(sanitize_mul({}, {}), vec4(1.0))", src1_, src2);
                     } else {
-                        dot = fmt::format("dot({}, {})", src1, src2);
+                        dot = fmt::format("dot({}, {})", src1_, src2);
                     }
                 }
 
@@ -84,6 +84,9 @@ class TextureRuntime {
     friend class Framebuffer;
 
 public:
+    /// Downloads read pixels synchronously into a single shared staging buffer
+    static constexpr bool ASYNC_DOWNLOADS = false;
+
     explicit TextureRuntime(Driver& driver);
     ~TextureRuntime();
 
@@ -325,6 +325,8 @@ void RendererOpenGL::SwapBuffers() {
     }
 
     m_current_frame++;
+    rasterizer.TickFrame();
+
     system.perf_stats->EndSystemFrame();
 
     render_window.PollEvents();
@@ -982,6 +982,7 @@ void RendererVulkan::SwapBuffers() {
     RenderToMailbox(layout, mailbox, false);
 
     m_current_frame++;
+    rasterizer.TickFrame();
 
     system.perf_stats->EndSystemFrame();
     render_window.PollEvents();
@@ -2,20 +2,25 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <boost/container/static_vector.hpp>
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
 #include "video_core/renderer_vulkan/pica_to_vk.h"
 #include "video_core/renderer_vulkan/vk_descriptor_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_pipeline_manifest.h"
 #include "video_core/renderer_vulkan/vk_renderpass_cache.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_gen_spv.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/video_core.h"
 
 MICROPROFILE_DEFINE(Vulkan_Pipeline, "Vulkan", "Pipeline Building", MP_RGB(0, 192, 32));
 MICROPROFILE_DEFINE(Vulkan_Bind, "Vulkan", "Pipeline Bind", MP_RGB(192, 32, 32));
@@ -62,6 +67,17 @@ vk::ShaderStageFlagBits MakeShaderStage(std::size_t index) {
     return vk::ShaderStageFlagBits::eVertex;
 }
 
+/// Returns true when both infos produce the same pipeline, regardless of the dynamic state support
+bool IsSamePipelineState(const PipelineInfo& lhs, const PipelineInfo& rhs) {
+    const auto equal = [](const auto& a, const auto& b) {
+        return std::memcmp(&a, &b, sizeof(a)) == 0;
+    };
+    return equal(lhs.vertex_layout, rhs.vertex_layout) &&
+           equal(lhs.attachments, rhs.attachments) &&
+           equal(lhs.rasterization, rhs.rasterization) &&
+           equal(lhs.depth_stencil, rhs.depth_stencil) && equal(lhs.blending, rhs.blending);
+}
+
 u64 PipelineInfo::Hash(const Instance& instance) const {
     u64 info_hash = 0;
     const auto AppendHash = [&info_hash](const auto& data) {
@@ -413,7 +429,8 @@ PipelineCache::~PipelineCache() {
     device.destroyPipelineCache(pipeline_cache);
 }
 
-void PipelineCache::LoadDiskCache() {
+void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
+                                  const VideoCore::DiskResourceLoadCallback& callback) {
     if (!Settings::values.use_disk_shader_cache || !EnsureDirectories()) {
         return;
     }
@@ -446,6 +463,169 @@ void PipelineCache::LoadDiskCache() {
 
     vk::Device device = instance.GetDevice();
     pipeline_cache = device.createPipelineCache(cache_info);
+
+    manifest_path = GetPipelineManifestPath();
+    if (manifest_path.empty()) {
+        return;
+    }
+
+    manifest = std::make_unique<PipelineManifest>();
+    if (manifest->Load(manifest_path)) {
+        BuildManifestPipelines(stop_loading, callback);
+    }
+}
+
+void PipelineCache::BuildManifestPipelines(const std::atomic_bool& stop_loading,
+                                           const VideoCore::DiskResourceLoadCallback& callback) {
+    const vk::Device device = instance.GetDevice();
+    const bool emit_spirv = Settings::values.spirv_shader_gen.GetValue();
+    std::vector<Shader*> shaders;
+
+    for (const auto& [hash, vertex_shader] : manifest->VertexShaders()) {
+        const std::string* program = manifest->FindVertexProgram(vertex_shader.program_hash);
+        if (!program) {
+            continue;
+        }
+        auto [iter, new_program] = programmable_vertex_cache.try_emplace(*program, instance);
+        auto& shader = iter->second;
+        if (new_program) {
+            shader.program = *program;
+            workers.QueueWork([device, &shader] {
+                shader.module = Compile(shader.program, vk::ShaderStageFlagBits::eVertex, device,
+                                        ShaderOptimization::High);
+                shader.MarkDone();
+            });
+            shaders.push_back(&shader);
+        }
+        programmable_vertex_map.try_emplace({vertex_shader.config, hash}, &shader);
+    }
+
+    if (instance.UseGeometryShaders()) {
+        for (const auto& [hash, gs_config] : manifest->GeometryShaders()) {
+            auto [it, new_shader] = fixed_geometry_shaders.try_emplace({gs_config, hash}, instance);
+            auto& shader = it->second;
+            if (new_shader) {
+                workers.QueueWork([gs_config, device, &shader] {
+                    const std::string code = GenerateFixedGeometryShader(gs_config);
+                    shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device,
+                                            ShaderOptimization::High);
+                    shader.MarkDone();
+                });
+                shaders.push_back(&shader);
+            }
+        }
+    }
+
+    for (const auto& [hash, config] : manifest->FragmentShaders()) {
+        auto [it, new_shader] = fragment_shaders.try_emplace({config, hash}, instance);
+        auto& shader = it->second;
+        if (new_shader) {
+            workers.QueueWork([config, device, emit_spirv, &shader] {
+                if (emit_spirv) {
+                    const std::vector code = GenerateFragmentShaderSPV(config);
+                    shader.module = CompileSPV(code, device);
+                } else {
+                    const std::string code = GenerateFragmentShader(config);
+                    shader.module = Compile(code, vk::ShaderStageFlagBits::eFragment, device,
+                                            ShaderOptimization::Debug);
+                }
+                shader.MarkDone();
+            });
+            shaders.push_back(&shader);
+        }
+    }
+
+    for (std::size_t i = 0; i < shaders.size(); i++) {
+        if (stop_loading) {
+            workers.WaitForRequests();
+            return;
+        }
+        shaders[i]->WaitDone();
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Decompile, i + 1, shaders.size());
+        }
+    }
+
+    // Resolves the shaders of a recorded pipeline the way the Use*Shader functions bind them
+    const auto find_stages = [&](const PipelineManifest::Pipeline& entry,
+                                 std::array<Shader*, MAX_SHADER_STAGES>& stages) {
+        stages[ProgramType::VS] = &trivial_vertex_shader;
+        if (const u64 vs_hash = entry.shader_hashes[ProgramType::VS]; vs_hash != 0) {
+            const auto config = manifest->VertexShaders().find(vs_hash);
+            if (config == manifest->VertexShaders().end()) {
+                return false;
+            }
+            const auto it = programmable_vertex_map.find({config->second.config, vs_hash});
+            if (it == programmable_vertex_map.end() || !it->second) {
+                return false;
+            }
+            stages[ProgramType::VS] = it->second;
+        }
+
+        stages[ProgramType::GS] = nullptr;
+        if (const u64 gs_hash = entry.shader_hashes[ProgramType::GS]; gs_hash != 0) {
+            const auto config = manifest->GeometryShaders().find(gs_hash);
+            if (config == manifest->GeometryShaders().end()) {
+                return false;
+            }
+            const auto it = fixed_geometry_shaders.find({config->second, gs_hash});
+            if (it == fixed_geometry_shaders.end()) {
+                return false;
+            }
+            stages[ProgramType::GS] = &it->second;
+        }
+
+        const u64 fs_hash = entry.shader_hashes[ProgramType::FS];
+        const auto config = manifest->FragmentShaders().find(fs_hash);
+        if (config == manifest->FragmentShaders().end()) {
+            return false;
+        }
+        const auto it = fragment_shaders.find({config->second, fs_hash});
+        if (it == fragment_shaders.end()) {
+            return false;
+        }
+        stages[ProgramType::FS] = &it->second;
+        return true;
+    };
+
+    std::vector<GraphicsPipeline*> pipelines;
+    for (const auto& [pipeline_hash, entry] : manifest->Pipelines()) {
+        std::array<Shader*, MAX_SHADER_STAGES> stages;
+        if (!find_stages(entry, stages)) {
+            continue;
+        }
+
+        // Skip pipelines recorded while the driver reported different dynamic state support
+        u64 shader_hash = 0;
+        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+            shader_hash = Common::HashCombine(shader_hash, entry.shader_hashes[i]);
+        }
+        if (Common::HashCombine(shader_hash, entry.info.Hash(instance)) != pipeline_hash) {
+            continue;
+        }
+
+        auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
+        if (new_pipeline) {
+            it->second = std::make_unique<GraphicsPipeline>(
+                instance, renderpass_cache, entry.info, pipeline_cache,
+                desc_manager.GetPipelineLayout(), stages, &workers);
+            pipelines.push_back(it->second.get());
+        }
+    }
+
+    for (std::size_t i = 0; i < pipelines.size(); i++) {
+        if (stop_loading) {
+            workers.WaitForRequests();
+            return;
+        }
+        pipelines[i]->WaitDone();
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Build, i + 1, pipelines.size());
+        }
+    }
+
+    LOG_INFO(Render_Vulkan, "Built {} shaders and {} pipelines from the pipeline manifest",
+             shaders.size(), pipelines.size());
 }
 
 void PipelineCache::SaveDiskCache() {
@@ -453,6 +633,10 @@ void PipelineCache::SaveDiskCache() {
         return;
     }
 
+    if (manifest) {
+        manifest->Save(manifest_path);
+    }
+
     const std::string cache_file_path = fmt::format("{}{:x}{:x}.bin", GetPipelineCacheDir(),
                                                     instance.GetVendorID(), instance.GetDeviceID());
     FileUtil::IOFile cache_file{cache_file_path, "wb"};
@@ -474,22 +658,37 @@ void PipelineCache::SaveDiskCache() {
 bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
     MICROPROFILE_SCOPE(Vulkan_Bind);
 
-    u64 shader_hash = 0;
-    for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
-        shader_hash = Common::HashCombine(shader_hash, shader_hashes[i]);
-    }
+    // Most draws use the same state as the previous one, skip hashing it in that case
+    if (!last_pipeline || shader_hashes != last_shader_hashes ||
+        !IsSamePipelineState(info, last_pipeline_info)) {
+        u64 shader_hash = 0;
+        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+            shader_hash = Common::HashCombine(shader_hash, shader_hashes[i]);
+        }
 
-    const u64 info_hash = info.Hash(instance);
-    const u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
+        const u64 info_hash = info.Hash(instance);
+        const u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
 
-    auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
-    if (new_pipeline) {
-        it->second = std::make_unique<GraphicsPipeline>(
-            instance, renderpass_cache, info, pipeline_cache, desc_manager.GetPipelineLayout(),
-            current_shaders, &workers);
+        auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
+        if (new_pipeline) {
+            it->second = std::make_unique<GraphicsPipeline>(
+                instance, renderpass_cache, info, pipeline_cache, desc_manager.GetPipelineLayout(),
+                current_shaders, &workers);
+        }
+        lookup_stats.hash_lookups++;
+
+        last_pipeline = it->second.get();
+        last_pipeline_info = info;
+        last_shader_hashes = shader_hashes;
+        if (manifest && last_pipeline->MarkUsed()) {
+            manifest->RecordPipeline(pipeline_hash, info, shader_hashes);
+        }
+    } else {
+        lookup_stats.pipeline_reuses++;
     }
 
-    GraphicsPipeline* const pipeline{it->second.get()};
+    GraphicsPipeline* const pipeline{last_pipeline};
+
     if (!wait_built && !pipeline->IsDone()) {
         return false;
     }
@@ -518,15 +717,14 @@ bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
 
 bool PipelineCache::UseProgrammableVertexShader(const Pica::Regs& regs,
                                                 Pica::Shader::ShaderSetup& setup,
-                                                const VertexLayout& layout) {
-    PicaVSConfig config{regs.rasterizer, regs.vs, setup, instance};
-    config.state.use_geometry_shader = instance.UseGeometryShaders();
-
+                                                const VertexLayout& layout, bool config_dirty) {
+    std::array<AttribLoadFlags, 16> load_flags;
+    load_flags.fill(AttribLoadFlags::Float);
     for (u32 i = 0; i < layout.attribute_count; i++) {
         const VertexAttribute& attr = layout.attributes[i];
         const FormatTraits& traits = instance.GetTraits(attr.type, attr.size);
         const u32 location = attr.location.Value();
-        AttribLoadFlags& flags = config.state.load_flags[location];
+        AttribLoadFlags& flags = load_flags[location];
 
         if (traits.requires_conversion) {
             flags = MakeAttribLoadFlag(attr.type);
@@ -536,12 +734,38 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::Regs& regs,
         }
     }
 
-    auto [it, new_config] = programmable_vertex_map.try_emplace(config);
+    // The configuration only changes with the shader registers, the attribute formats and
+    // the accurate multiplication setting.
+    LastShader<PicaVSConfig>& last = last_vertex_shader;
+    if (!config_dirty && last.valid && last.config.state.load_flags == load_flags &&
+        last.config.state.sanitize_mul == VideoCore::g_hw_shader_accurate_mul) {
+        lookup_stats.config_reuses++;
+        if (!last.shader) {
+            return false;
+        }
+        current_shaders[ProgramType::VS] = last.shader;
+        shader_hashes[ProgramType::VS] = last.hash;
+        return true;
+    }
+
+    PicaVSConfig config{regs.rasterizer, regs.vs, setup, instance};
+    config.state.use_geometry_shader = instance.UseGeometryShaders();
+    config.state.load_flags = load_flags;
+    const u64 config_hash = config.Hash();
+    lookup_stats.config_builds++;
+    lookup_stats.hash_lookups++;
+
+    last.config = config;
+    last.hash = config_hash;
+    last.shader = nullptr;
+    last.valid = true;
+
+    auto [it, new_config] = programmable_vertex_map.try_emplace({config, config_hash});
     if (new_config) {
         auto code = GenerateVertexShader(setup, config);
         if (!code) {
             LOG_ERROR(Render_Vulkan, "Failed to retrieve programmable vertex shader");
-            programmable_vertex_map[config] = nullptr;
+            it->second = nullptr;
             return false;
         }
 
@@ -561,6 +785,9 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::Regs& regs,
         }
 
         it->second = &shader;
+        if (manifest) {
+            manifest->RecordVertexShader(config_hash, config, shader.program);
+        }
     }
 
     Shader* const shader{it->second};
@@ -569,8 +796,9 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::Regs& regs,
         return false;
     }
 
+    last.shader = shader;
     current_shaders[ProgramType::VS] = shader;
-    shader_hashes[ProgramType::VS] = config.Hash();
+    shader_hashes[ProgramType::VS] = config_hash;
 
     return true;
 }
@@ -580,14 +808,26 @@ void PipelineCache::UseTrivialVertexShader() {
     shader_hashes[ProgramType::VS] = 0;
 }
 
-bool PipelineCache::UseFixedGeometryShader(const Pica::Regs& regs) {
+bool PipelineCache::UseFixedGeometryShader(const Pica::Regs& regs, bool config_dirty) {
     if (!instance.UseGeometryShaders()) {
         UseTrivialGeometryShader();
         return true;
     }
 
+    LastShader<PicaFixedGSConfig>& last = last_geometry_shader;
+    if (!config_dirty && last.valid) {
+        lookup_stats.config_reuses++;
+        current_shaders[ProgramType::GS] = last.shader;
+        shader_hashes[ProgramType::GS] = last.hash;
+        return true;
+    }
+
     const PicaFixedGSConfig gs_config{regs, instance};
-    auto [it, new_shader] = fixed_geometry_shaders.try_emplace(gs_config, instance);
+    const u64 config_hash = gs_config.Hash();
+    lookup_stats.config_builds++;
+    lookup_stats.hash_lookups++;
+
+    auto [it, new_shader] = fixed_geometry_shaders.try_emplace({gs_config, config_hash}, instance);
     auto& shader = it->second;
 
     if (new_shader) {
@@ -598,10 +838,14 @@ bool PipelineCache::UseFixedGeometryShader(const Pica::Regs& regs) {
                 Compile(code, vk::ShaderStageFlagBits::eGeometry, device, ShaderOptimization::High);
             shader.MarkDone();
         });
+        if (manifest) {
+            manifest->RecordGeometryShader(config_hash, gs_config);
+        }
     }
 
+    last = {gs_config, config_hash, &shader, true};
     current_shaders[ProgramType::GS] = &shader;
-    shader_hashes[ProgramType::GS] = gs_config.Hash();
+    shader_hashes[ProgramType::GS] = config_hash;
 
     return true;
 }
@@ -613,8 +857,21 @@ void PipelineCache::UseTrivialGeometryShader() {
 
 void PipelineCache::UseFragmentShader(const Pica::Regs& regs) {
     const PicaFSConfig config{regs, instance};
+    lookup_stats.config_builds++;
+
+    // Games often rewrite registers with the values they already hold
+    LastShader<PicaFSConfig>& last = last_fragment_shader;
+    if (last.valid && last.config == config) {
+        lookup_stats.config_reuses++;
+        current_shaders[ProgramType::FS] = last.shader;
+        shader_hashes[ProgramType::FS] = last.hash;
+        return;
+    }
+
+    const u64 config_hash = config.Hash();
+    lookup_stats.hash_lookups++;
 
-    auto [it, new_shader] = fragment_shaders.try_emplace(config, instance);
+    auto [it, new_shader] = fragment_shaders.try_emplace({config, config_hash}, instance);
     auto& shader = it->second;
 
     if (new_shader) {
@@ -636,10 +893,22 @@ void PipelineCache::UseFragmentShader(const Pica::Regs& regs) {
                 shader.MarkDone();
             });
         }
+        if (manifest) {
+            manifest->RecordFragmentShader(config_hash, config);
+        }
     }
 
+    last = {config, config_hash, &shader, true};
     current_shaders[ProgramType::FS] = &shader;
-    shader_hashes[ProgramType::FS] = config.Hash();
+    shader_hashes[ProgramType::FS] = config_hash;
+}
+
+void PipelineCache::TickFrame() {
+    LOG_TRACE(Render_Vulkan,
+              "Shader configs: {} built, {} reused. Lookups: {} hashed, {} pipelines reused",
+              lookup_stats.config_builds, lookup_stats.config_reuses, lookup_stats.hash_lookups,
+              lookup_stats.pipeline_reuses);
+    last_lookup_stats = std::exchange(lookup_stats, {});
 }
 
 void PipelineCache::BindTexture(u32 binding, vk::ImageView image_view, vk::Sampler sampler) {
@@ -873,4 +1142,16 @@ std::string PipelineCache::GetPipelineCacheDir() const {
     return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + "vulkan" + DIR_SEP;
 }
 
+std::string PipelineCache::GetPipelineManifestPath() const {
+    // Skip games without title id
+    u64 program_id{};
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+            Loader::ResultStatus::Success ||
+        program_id == 0) {
+        return {};
+    }
+    return fmt::format("{}{:016X}_{:x}{:x}.manifest", GetPipelineCacheDir(), program_id,
+                       instance.GetVendorID(), instance.GetDeviceID());
+}
+
 } // namespace Vulkan
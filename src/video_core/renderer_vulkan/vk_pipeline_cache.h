@@ -5,11 +5,15 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <utility>
 #include "common/async_handle.h"
 #include "common/bit_field.h"
 #include "common/hash.h"
 #include "common/thread_worker.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/renderer_vulkan/vk_shader_gen.h"
 
@@ -126,6 +130,7 @@ class Instance;
 class Scheduler;
 class RenderpassCache;
 class DescriptorManager;
+class PipelineManifest;
 
 /**
  * Stores a collection of rasterizer pipelines used during rendering.
@@ -160,6 +165,11 @@ class PipelineCache {
             return pipeline;
         }
 
+        /// Returns true the first time the pipeline is bound
+        [[nodiscard]] bool MarkUsed() noexcept {
+            return !std::exchange(used, true);
+        }
+
     private:
         bool ShouldTryCompile();
 
@@ -167,6 +177,7 @@ class PipelineCache {
         const Instance& instance;
         RenderpassCache& renderpass_cache;
         Common::ThreadWorker* worker;
+        bool used{};
 
         vk::Pipeline pipeline;
         vk::PipelineLayout pipeline_layout;
@@ -177,12 +188,21 @@ class PipelineCache {
     };
 
 public:
+    /// Shader configuration and pipeline lookups done by the draws of a frame
+    struct LookupStats {
+        u64 config_builds{};   ///< Shader configurations built from the PICA registers
+        u64 config_reuses{};   ///< Shader binds that reused the configuration of the last draw
+        u64 hash_lookups{};    ///< Shader and pipeline lookups that hashed their key
+        u64 pipeline_reuses{}; ///< Pipeline binds that reused the last pipeline without hashing
+    };
+
     PipelineCache(const Instance& instance, Scheduler& scheduler, RenderpassCache& renderpass_cache,
                   DescriptorManager& desc_manager);
     ~PipelineCache();
 
-    /// Loads the pipeline cache stored to disk
-    void LoadDiskCache();
+    /// Loads the pipeline cache stored to disk and builds the pipelines the title used before
+    void LoadDiskCache(const std::atomic_bool& stop_loading,
+                       const VideoCore::DiskResourceLoadCallback& callback);
 
     /// Stores the generated pipeline cache to disk
     void SaveDiskCache();
@@ -190,15 +210,18 @@ public:
     /// Binds a pipeline using the provided information
     bool BindPipeline(const PipelineInfo& info, bool wait_built = false);
 
-    /// Binds a PICA decompiled vertex shader
+    /**
+     * Binds a PICA decompiled vertex shader
+     * @param config_dirty true when the registers the shader configuration is built from changed
+     */
     bool UseProgrammableVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup,
-                                     const VertexLayout& layout);
+                                     const VertexLayout& layout, bool config_dirty);
 
     /// Binds a passthrough vertex shader
     void UseTrivialVertexShader();
 
-    /// Binds a PICA decompiled geometry shader
-    bool UseFixedGeometryShader(const Pica::Regs& regs);
+    /// Binds a PICA decompiled geometry shader, the configuration is rebuilt when config_dirty
+    bool UseFixedGeometryShader(const Pica::Regs& regs, bool config_dirty);
 
     /// Binds a passthrough geometry shader
     void UseTrivialGeometryShader();
@@ -221,6 +244,14 @@ public:
     /// Sets the dynamic offset for the uniform buffer at binding
     void SetBufferOffset(u32 binding, u32 offset);
 
+    /// Finishes the lookup counters of the current frame
+    void TickFrame();
+
+    /// Returns the lookup counters of the last completed frame
+    const LookupStats& GetLookupStats() const noexcept {
+        return last_lookup_stats;
+    }
+
 private:
     /// Applies dynamic pipeline state to the current command buffer
     void ApplyDynamic(const PipelineInfo& info, bool is_dirty);
@@ -228,6 +259,10 @@ private:
     /// Builds the rasterizer pipeline layout
     void BuildLayout();
 
+    /// Builds the shaders and pipelines recorded in the pipeline manifest on the workers
+    void BuildManifestPipelines(const std::atomic_bool& stop_loading,
+                                const VideoCore::DiskResourceLoadCallback& callback);
+
     /// Returns true when the disk data can be used by the current driver
     bool IsCacheValid(const u8* data, u64 size) const;
 
@@ -237,6 +272,9 @@ private:
     /// Returns the pipeline cache storage dir
     std::string GetPipelineCacheDir() const;
 
+    /// Returns the path of the pipeline manifest of the running title, empty if it has none
+    std::string GetPipelineManifestPath() const;
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -256,13 +294,54 @@ private:
         FS = 1,
     };
 
+    /// Configuration and shader bound by the last draw for a stage
+    template <typename Config>
+    struct LastShader {
+        Config config{};
+        u64 hash{};
+        Shader* shader{};
+        bool valid{};
+    };
+
+    /// Shader configuration along with its hash, so lookups don't hash the configuration again
+    template <typename Config>
+    struct ShaderKey {
+        Config config;
+        u64 hash;
+
+        bool operator==(const ShaderKey& other) const {
+            return hash == other.hash && config == other.config;
+        }
+    };
+
+    struct ShaderKeyHash {
+        template <typename Config>
+        std::size_t operator()(const ShaderKey<Config>& key) const noexcept {
+            return static_cast<std::size_t>(key.hash);
+        }
+    };
+
+    template <typename Config, typename T>
+    using ShaderMap = std::unordered_map<ShaderKey<Config>, T, ShaderKeyHash>;
+
     std::array<u64, MAX_SHADER_STAGES> shader_hashes;
     std::array<Shader*, MAX_SHADER_STAGES> current_shaders;
-    std::unordered_map<PicaVSConfig, Shader*> programmable_vertex_map;
+    ShaderMap<PicaVSConfig, Shader*> programmable_vertex_map;
     std::unordered_map<std::string, Shader> programmable_vertex_cache;
-    std::unordered_map<PicaFixedGSConfig, Shader> fixed_geometry_shaders;
-    std::unordered_map<PicaFSConfig, Shader> fragment_shaders;
+    ShaderMap<PicaFixedGSConfig, Shader> fixed_geometry_shaders;
+    ShaderMap<PicaFSConfig, Shader> fragment_shaders;
     Shader trivial_vertex_shader;
+
+    LastShader<PicaVSConfig> last_vertex_shader;
+    LastShader<PicaFixedGSConfig> last_geometry_shader;
+    LastShader<PicaFSConfig> last_fragment_shader;
+    GraphicsPipeline* last_pipeline{};
+    PipelineInfo last_pipeline_info{};
+    std::array<u64, MAX_SHADER_STAGES> last_shader_hashes{};
+    LookupStats lookup_stats{};
+    LookupStats last_lookup_stats{};
+    std::unique_ptr<PipelineManifest> manifest;
+    std::string manifest_path;
 };
 
 } // namespace Vulkan
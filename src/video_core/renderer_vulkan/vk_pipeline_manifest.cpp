@@ -0,0 +1,215 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "video_core/renderer_vulkan/vk_pipeline_manifest.h"
+
+namespace Vulkan {
+
+namespace {
+
+constexpr u32 MANIFEST_VERSION = 1;
+
+// Generated shaders change between builds, so manifests are only valid for the build that
+// recorded them.
+using BuildVersion = std::array<char, 64>;
+
+BuildVersion GetBuildVersion() {
+    BuildVersion version{};
+    const char* scm_version = Common::g_shader_cache_version;
+    const std::size_t length = std::min(std::strlen(scm_version), version.size());
+    std::memcpy(version.data(), scm_version, length);
+    return version;
+}
+
+template <typename T>
+bool ReadEntries(FileUtil::IOFile& file, PipelineManifest::Map<T>& entries) {
+    static_assert(std::is_trivially_copyable_v<T>, "Manifest entries are stored as raw bytes");
+    u64 count{};
+    if (file.ReadBytes(&count, sizeof(u64)) != sizeof(u64)) {
+        return false;
+    }
+    entries.reserve(count);
+    for (u64 i = 0; i < count; i++) {
+        u64 hash{};
+        T entry{};
+        if (file.ReadBytes(&hash, sizeof(u64)) != sizeof(u64) ||
+            file.ReadBytes(&entry, sizeof(T)) != sizeof(T)) {
+            return false;
+        }
+        entries.emplace(hash, entry);
+    }
+    return true;
+}
+
+template <typename T>
+bool WriteEntries(FileUtil::IOFile& file, const PipelineManifest::Map<T>& entries) {
+    if (file.WriteObject(static_cast<u64>(entries.size())) != 1) {
+        return false;
+    }
+    for (const auto& [hash, entry] : entries) {
+        if (file.WriteObject(hash) != 1 || file.WriteObject(entry) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadPrograms(FileUtil::IOFile& file, PipelineManifest::Map<std::string>& programs) {
+    u64 count{};
+    if (file.ReadBytes(&count, sizeof(u64)) != sizeof(u64)) {
+        return false;
+    }
+    programs.reserve(count);
+    for (u64 i = 0; i < count; i++) {
+        u64 hash{};
+        u64 length{};
+        if (file.ReadBytes(&hash, sizeof(u64)) != sizeof(u64) ||
+            file.ReadBytes(&length, sizeof(u64)) != sizeof(u64)) {
+            return false;
+        }
+        std::string program(length, '\0');
+        if (file.ReadArray(program.data(), length) != length) {
+            return false;
+        }
+        programs.emplace(hash, std::move(program));
+    }
+    return true;
+}
+
+bool WritePrograms(FileUtil::IOFile& file, const PipelineManifest::Map<std::string>& programs) {
+    if (file.WriteObject(static_cast<u64>(programs.size())) != 1) {
+        return false;
+    }
+    for (const auto& [hash, program] : programs) {
+        const u64 length = program.size();
+        if (file.WriteObject(hash) != 1 || file.WriteObject(length) != 1 ||
+            file.WriteString(program) != length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+bool PipelineManifest::Load(const std::string& path) {
+    FileUtil::IOFile file{path, "rb"};
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    u32 version{};
+    BuildVersion build_version{};
+    if (file.ReadBytes(&version, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(build_version.data(), build_version.size()) != build_version.size()) {
+        LOG_WARNING(Render_Vulkan, "Pipeline manifest is truncated, ignoring");
+        return false;
+    }
+    if (version != MANIFEST_VERSION || build_version != GetBuildVersion()) {
+        LOG_INFO(Render_Vulkan, "Pipeline manifest was recorded by another build, ignoring");
+        return false;
+    }
+
+    const bool loaded = file.ReadBytes(&boot, sizeof(u32)) == sizeof(u32) &&
+                        ReadPrograms(file, vertex_programs) &&
+                        ReadEntries(file, vertex_shaders) && ReadEntries(file, geometry_shaders) &&
+                        ReadEntries(file, fragment_shaders) && ReadEntries(file, pipelines);
+    if (!loaded) {
+        LOG_WARNING(Render_Vulkan, "Pipeline manifest is corrupted, ignoring");
+        *this = {};
+        return false;
+    }
+
+    boot++;
+    return true;
+}
+
+bool PipelineManifest::Save(const std::string& path) {
+    Expire();
+
+    FileUtil::IOFile file{path, "wb"};
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "Unable to open pipeline manifest for writing");
+        return false;
+    }
+
+    const BuildVersion build_version = GetBuildVersion();
+    const bool saved = file.WriteObject(MANIFEST_VERSION) == 1 &&
+                       file.WriteObject(build_version) == 1 && file.WriteObject(boot) == 1 &&
+                       WritePrograms(file, vertex_programs) && WriteEntries(file, vertex_shaders) &&
+                       WriteEntries(file, geometry_shaders) &&
+                       WriteEntries(file, fragment_shaders) && WriteEntries(file, pipelines);
+    if (!saved) {
+        LOG_WARNING(Render_Vulkan, "Error during pipeline manifest write");
+        return false;
+    }
+
+    LOG_INFO(Render_Vulkan, "Saved {} pipelines to the pipeline manifest", pipelines.size());
+    return true;
+}
+
+void PipelineManifest::RecordVertexShader(u64 hash, const PicaVSConfig& config,
+                                          const std::string& program) {
+    const u64 program_hash = Common::ComputeHash64(program.data(), program.size());
+    vertex_programs.try_emplace(program_hash, program);
+    vertex_shaders.insert_or_assign(hash, VertexShader{config, program_hash});
+}
+
+void PipelineManifest::RecordGeometryShader(u64 hash, const PicaFixedGSConfig& config) {
+    geometry_shaders.insert_or_assign(hash, config);
+}
+
+void PipelineManifest::RecordFragmentShader(u64 hash, const PicaFSConfig& config) {
+    fragment_shaders.insert_or_assign(hash, config);
+}
+
+void PipelineManifest::RecordPipeline(u64 pipeline_hash, const PipelineInfo& info,
+                                      const std::array<u64, MAX_SHADER_STAGES>& shader_hashes) {
+    pipelines.insert_or_assign(pipeline_hash, Pipeline{info, shader_hashes, boot});
+}
+
+void PipelineManifest::Expire() {
+    const std::size_t num_pipelines = pipelines.size();
+    std::erase_if(pipelines, [this](const auto& entry) {
+        return boot - entry.second.last_used_boot >= MAX_UNUSED_BOOTS;
+    });
+
+    std::array<std::unordered_set<u64>, MAX_SHADER_STAGES> used_shaders;
+    for (const auto& [pipeline_hash, pipeline] : pipelines) {
+        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+            used_shaders[i].insert(pipeline.shader_hashes[i]);
+        }
+    }
+
+    // The stage indices match PipelineCache::ProgramType
+    const auto is_unused = [&used_shaders](u32 stage) {
+        return [&used = used_shaders[stage]](const auto& entry) {
+            return !used.contains(entry.first);
+        };
+    };
+    std::erase_if(vertex_shaders, is_unused(0));
+    std::erase_if(fragment_shaders, is_unused(1));
+    std::erase_if(geometry_shaders, is_unused(2));
+
+    std::unordered_set<u64> used_programs;
+    for (const auto& [hash, vertex_shader] : vertex_shaders) {
+        used_programs.insert(vertex_shader.program_hash);
+    }
+    std::erase_if(vertex_programs, [&used_programs](const auto& entry) {
+        return !used_programs.contains(entry.first);
+    });
+
+    if (pipelines.size() != num_pipelines) {
+        LOG_INFO(Render_Vulkan, "Expired {} pipelines unused for {} boots",
+                 num_pipelines - pipelines.size(), MAX_UNUSED_BOOTS);
+    }
+}
+
+} // namespace Vulkan
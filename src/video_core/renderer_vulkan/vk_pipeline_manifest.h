@@ -0,0 +1,89 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+
+namespace Vulkan {
+
+/**
+ * Records the pipelines a title binds along with the shader configurations they are made of, so
+ * that they can be built before the title starts the next time it boots. Pipelines that have not
+ * been bound for MAX_UNUSED_BOOTS boots are dropped when the manifest is saved.
+ */
+class PipelineManifest {
+public:
+    static constexpr u32 MAX_UNUSED_BOOTS = 16;
+
+    struct VertexShader {
+        PicaVSConfig config;
+        u64 program_hash;
+    };
+
+    struct Pipeline {
+        PipelineInfo info;
+        /// Hashes of the shader configurations, indexed like the pipeline stages
+        std::array<u64, MAX_SHADER_STAGES> shader_hashes;
+        /// The boot in which the pipeline was last bound
+        u32 last_used_boot;
+    };
+
+    template <typename T>
+    using Map = std::unordered_map<u64, T, Common::IdentityHash<u64>>;
+
+    /// Loads the manifest at path and starts a new boot. Returns false when no manifest was loaded
+    bool Load(const std::string& path);
+
+    /// Saves the manifest to path after dropping expired pipelines
+    bool Save(const std::string& path);
+
+    void RecordVertexShader(u64 hash, const PicaVSConfig& config, const std::string& program);
+    void RecordGeometryShader(u64 hash, const PicaFixedGSConfig& config);
+    void RecordFragmentShader(u64 hash, const PicaFSConfig& config);
+
+    /// Records a pipeline as bound during the current boot
+    void RecordPipeline(u64 pipeline_hash, const PipelineInfo& info,
+                        const std::array<u64, MAX_SHADER_STAGES>& shader_hashes);
+
+    [[nodiscard]] const std::string* FindVertexProgram(u64 program_hash) const {
+        const auto it = vertex_programs.find(program_hash);
+        return it != vertex_programs.end() ? &it->second : nullptr;
+    }
+
+    [[nodiscard]] const Map<VertexShader>& VertexShaders() const noexcept {
+        return vertex_shaders;
+    }
+
+    [[nodiscard]] const Map<PicaFixedGSConfig>& GeometryShaders() const noexcept {
+        return geometry_shaders;
+    }
+
+    [[nodiscard]] const Map<PicaFSConfig>& FragmentShaders() const noexcept {
+        return fragment_shaders;
+    }
+
+    [[nodiscard]] const Map<Pipeline>& Pipelines() const noexcept {
+        return pipelines;
+    }
+
+private:
+    /// Drops the pipelines that were not used recently and the shaders no pipeline refers to
+    void Expire();
+
+private:
+    u32 boot = 0;
+    Map<std::string> vertex_programs;
+    Map<VertexShader> vertex_shaders;
+    Map<PicaFixedGSConfig> geometry_shaders;
+    Map<PicaFSConfig> fragment_shaders;
+    Map<Pipeline> pipelines;
+};
+
+} // namespace Vulkan
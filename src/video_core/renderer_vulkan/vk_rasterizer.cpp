@@ -24,6 +24,7 @@ MICROPROFILE_DEFINE(Vulkan_GS, "Vulkan", "Geometry Shader Setup", MP_RGB(128, 19
 MICROPROFILE_DEFINE(Vulkan_Drawing, "Vulkan", "Drawing", MP_RGB(128, 128, 192));
 
 using TriangleTopology = Pica::PipelineRegs::TriangleTopology;
+using VideoCore::DirtyRegs;
 using VideoCore::SurfaceType;
 
 constexpr u64 STREAM_BUFFER_SIZE = 64 * 1024 * 1024;
@@ -33,14 +34,6 @@ constexpr u64 TEXTURE_BUFFER_SIZE = 2 * 1024 * 1024;
 constexpr vk::BufferUsageFlags BUFFER_USAGE =
     vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
 
-struct DrawParams {
-    u32 vertex_count;
-    s32 vertex_offset;
-    u32 binding_count;
-    std::array<u32, 16> bindings;
-    bool is_indexed;
-};
-
 [[nodiscard]] u64 TextureBufferSize(const Instance& instance) {
     // Use the smallest texel size from the texel views
     // which corresponds to eR32G32Sfloat
@@ -133,7 +126,7 @@ RasterizerVulkan::~RasterizerVulkan() {
 
 void RasterizerVulkan::LoadDiskResources(const std::atomic_bool& stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
-    pipeline_cache.LoadDiskCache();
+    pipeline_cache.LoadDiskCache(stop_loading, callback);
 }
 
 void RasterizerVulkan::SyncFixedState() {
@@ -213,6 +206,23 @@ void RasterizerVulkan::SetupVertexArray() {
             base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
         const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
         u32 data_size = loader.byte_count * vertex_num;
+        const u32 aligned_stride =
+            Common::AlignUp(static_cast<u32>(loader.byte_count), stride_alignment);
+
+        // Create the binding associated with this loader
+        VertexBinding& binding = layout.bindings[layout.binding_count];
+        binding.binding.Assign(layout.binding_count);
+        binding.fixed.Assign(0);
+        binding.stride.Assign(aligned_stride);
+
+        // Static geometry is drawn from the same guest range every frame, so reuse the previous
+        // upload until the guest writes to the range.
+        const UploadKey key = {data_addr, data_size, aligned_stride, loader.byte_count};
+        if (const CachedUpload* cached = FindCachedUpload(key)) {
+            binding_offsets[layout.binding_count++] = static_cast<u32>(cached->offset);
+            upload_stats.vertex_bytes_reused += data_size;
+            continue;
+        }
         res_cache.FlushRegion(data_addr, data_size);
 
         const MemoryRef src_ref = memory.GetPhysicalRef(data_addr);
@@ -221,13 +231,10 @@ void RasterizerVulkan::SetupVertexArray() {
                       "Vertex buffer size {} exceeds available space {} at address {:#016X}",
                       data_size, src_ref.GetSize(), data_addr);
         }
-
         const u8* src_ptr = src_ref.GetPtr();
-        u8* dst_ptr = array_ptr + buffer_offset;
 
         // Align stride up if required by Vulkan implementation.
-        const u32 aligned_stride =
-            Common::AlignUp(static_cast<u32>(loader.byte_count), stride_alignment);
+        u8* dst_ptr = array_ptr + buffer_offset;
         if (aligned_stride == loader.byte_count) {
             std::memcpy(dst_ptr, src_ptr, data_size);
         } else {
@@ -236,12 +243,8 @@ void RasterizerVulkan::SetupVertexArray() {
                             loader.byte_count);
             }
         }
-
-        // Create the binding associated with this loader
-        VertexBinding& binding = layout.bindings[layout.binding_count];
-        binding.binding.Assign(layout.binding_count);
-        binding.fixed.Assign(0);
-        binding.stride.Assign(aligned_stride);
+        InsertCachedUpload(key, array_offset + buffer_offset);
+        upload_stats.vertex_bytes_uploaded += data_size;
 
         // Keep track of the binding offsets so we can bind the vertex buffer later
         binding_offsets[layout.binding_count++] = array_offset + buffer_offset;
@@ -254,6 +257,63 @@ void RasterizerVulkan::SetupVertexArray() {
     SetupFixedAttribs();
 }
 
+const RasterizerVulkan::CachedUpload* RasterizerVulkan::FindCachedUpload(const UploadKey& key) {
+    // Uploads from previous cycles may have been overwritten by the stream buffer. They are left
+    // in place so that their ranges stay tracked while they are uploaded again.
+    const auto it = upload_cache.find(key);
+    if (it == upload_cache.end() || it->second.cycle != stream_buffer.Cycle() ||
+        it->second.write_tick != GetWriteTick(key.addr, key.size)) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void RasterizerVulkan::InsertCachedUpload(const UploadKey& key, u64 offset) {
+    const auto [it, inserted] = upload_cache.try_emplace(key);
+    if (inserted) {
+        TrackRegion(key.addr, key.size, true);
+    }
+    it->second = CachedUpload{
+        .offset = offset,
+        .write_tick = GetWriteTick(key.addr, key.size),
+        .cycle = stream_buffer.Cycle(),
+    };
+}
+
+void RasterizerVulkan::EvictCachedUploads() {
+    const u64 cycle = stream_buffer.Cycle();
+    std::erase_if(upload_cache, [this, cycle](const auto& entry) {
+        const auto& [key, upload] = entry;
+        if (upload.cycle + 1 >= cycle) {
+            return false;
+        }
+        TrackRegion(key.addr, key.size, false);
+        return true;
+    });
+}
+
+void RasterizerVulkan::ClearCachedUploads() {
+    for (const auto& [key, upload] : upload_cache) {
+        TrackRegion(key.addr, key.size, false);
+    }
+    upload_cache.clear();
+}
+
+void RasterizerVulkan::TickFrame() {
+    LOG_TRACE(Render_Vulkan,
+              "Vertex data: {} bytes uploaded, {} reused. Index data: {} uploaded, {} reused",
+              upload_stats.vertex_bytes_uploaded, upload_stats.vertex_bytes_reused,
+              upload_stats.index_bytes_uploaded, upload_stats.index_bytes_reused);
+    LOG_TRACE(Render_Vulkan, "Draws: {} submitted, {} issued", draw_stats.submitted,
+              draw_stats.issued);
+    last_upload_stats = std::exchange(upload_stats, {});
+    last_draw_stats = std::exchange(draw_stats, {});
+    pipeline_cache.TickFrame();
+    EvictCachedUploads();
+    TickIndexRanges();
+    res_cache.TickFrame();
+}
+
 void RasterizerVulkan::SetupFixedAttribs() {
     const auto& vertex_attributes = regs.pipeline.vertex_attributes;
     VertexLayout& layout = pipeline_info.vertex_layout;
@@ -317,8 +377,10 @@ void RasterizerVulkan::SetupFixedAttribs() {
 
 bool RasterizerVulkan::SetupVertexShader() {
     MICROPROFILE_SCOPE(Vulkan_VS);
+    const bool config_dirty = True(dirty_regs & DirtyRegs::VertexConfig);
+    dirty_regs &= ~DirtyRegs::VertexConfig;
     return pipeline_cache.UseProgrammableVertexShader(regs, Pica::g_state.vs,
-                                                      pipeline_info.vertex_layout);
+                                                      pipeline_info.vertex_layout, config_dirty);
 }
 
 bool RasterizerVulkan::SetupGeometryShader() {
@@ -329,10 +391,16 @@ bool RasterizerVulkan::SetupGeometryShader() {
         return false;
     }
 
-    return pipeline_cache.UseFixedGeometryShader(regs);
+    const bool config_dirty = True(dirty_regs & DirtyRegs::GeometryConfig);
+    dirty_regs &= ~DirtyRegs::GeometryConfig;
+    return pipeline_cache.UseFixedGeometryShader(regs, config_dirty);
 }
 
 bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
+    if (!vertex_batch.empty()) {
+        DrawPendingTriangles();
+    }
+
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
         if (regs.pipeline.gs_config.mode != Pica::PipelineRegs::GSMode::Point) {
             return false;
@@ -353,6 +421,15 @@ bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
     // Vertex data setup might involve scheduler flushes so perform it
     // early to avoid invalidating our state in the middle of the draw.
     vertex_info = AnalyzeVertexArray(is_indexed, instance.GetMinVertexStrideAlignment());
+
+    // The merged data is uploaded once the batch is drawn, which must not wrap the stream buffer
+    // around as that could end the renderpass of the held back draw.
+    if (CanMergeDraw(is_indexed) && stream_buffer.CanMap(MergedUploadSize(), 4)) {
+        MergeDraw();
+        return true;
+    }
+    DrawPendingTriangles();
+
     SetupVertexArray();
 
     if (!SetupVertexShader()) {
@@ -362,6 +439,7 @@ bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
 
+    draw_stats.submitted++;
     return Draw(true, is_indexed);
 }
 
@@ -382,6 +460,48 @@ bool RasterizerVulkan::AccelerateDrawBatchInternal(bool is_indexed) {
         .is_indexed = is_indexed,
     };
 
+    if (HoldMergedDraw(is_indexed, instance.GetMinVertexStrideAlignment())) {
+        held_draw = params;
+        return true;
+    }
+    RecordDraw(params);
+
+    return true;
+}
+
+void RasterizerVulkan::DrawMergedBatch() {
+    if (merged_draw.draws == 1) {
+        RecordDraw(held_draw);
+        return;
+    }
+
+    // The only attribute loader has the first binding, its data is reused from the held back
+    // draw and only the vertices of the appended draws are uploaded
+    const u64 vertex_size = merged_draw.vertices.size() + merged_draw.stride;
+    const u64 index_size = merged_draw.indices.size() * sizeof(u32);
+    const u64 index_start = Common::AlignUp(vertex_size, 4);
+    const u64 upload_size = index_start + index_size;
+    auto [buffer, offset, _] = stream_buffer.Map(upload_size, 4);
+
+    const MergedUpload upload = UploadMergedVertices(buffer, offset, held_draw.bindings[0]);
+    WriteMergedIndices(reinterpret_cast<u32*>(buffer + index_start), upload);
+    stream_buffer.Commit(upload_size);
+    upload_stats.vertex_bytes_uploaded += merged_draw.vertices.size();
+    upload_stats.index_bytes_uploaded += index_size;
+
+    scheduler.Record([this, index_offset = offset + index_start](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindIndexBuffer(stream_buffer.Handle(), index_offset, vk::IndexType::eUint32);
+    });
+
+    // The fixed attributes stay as uploaded
+    DrawParams params = held_draw;
+    params.vertex_count = static_cast<u32>(merged_draw.indices.size());
+    params.vertex_offset = 0;
+    params.bindings[0] = static_cast<u32>(upload.base_offset);
+    RecordDraw(params);
+}
+
+void RasterizerVulkan::RecordDraw(const DrawParams& params) {
     scheduler.Record([this, params](vk::CommandBuffer cmdbuf) {
         std::array<u64, 16> offsets;
         std::copy(params.bindings.begin(), params.bindings.end(), offsets.begin());
@@ -393,8 +513,6 @@ bool RasterizerVulkan::AccelerateDrawBatchInternal(bool is_indexed) {
             cmdbuf.draw(params.vertex_count, 1, 0, 0);
         }
     });
-
-    return true;
 }
 
 void RasterizerVulkan::SetupIndexArray() {
@@ -403,9 +521,20 @@ void RasterizerVulkan::SetupIndexArray() {
     const u32 index_buffer_size = regs.pipeline.num_vertices * (native_u8 ? 1 : 2);
     const vk::IndexType index_type = native_u8 ? vk::IndexType::eUint8EXT : vk::IndexType::eUint16;
 
-    const u8* index_data =
-        memory.GetPhysicalPointer(regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
-                                  regs.pipeline.index_array.offset);
+    const PAddr index_addr = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
+                             regs.pipeline.index_array.offset;
+    const u8* index_data = memory.GetPhysicalPointer(index_addr);
+
+    const u32 index_data_size = regs.pipeline.num_vertices * (index_u8 ? 1 : 2);
+    const UploadKey key = {index_addr, index_data_size, index_u8 ? 1U : 2U, 0};
+    if (const CachedUpload* cached = FindCachedUpload(key)) {
+        upload_stats.index_bytes_reused += index_data_size;
+        scheduler.Record([this, index_offset = cached->offset,
+                          index_type = index_type](vk::CommandBuffer cmdbuf) {
+            cmdbuf.bindIndexBuffer(stream_buffer.Handle(), index_offset, index_type);
+        });
+        return;
+    }
 
     auto [index_ptr, index_offset, _] = stream_buffer.Map(index_buffer_size, 2);
 
@@ -419,6 +548,8 @@ void RasterizerVulkan::SetupIndexArray() {
     }
 
     stream_buffer.Commit(index_buffer_size);
+    InsertCachedUpload(key, index_offset);
+    upload_stats.index_bytes_uploaded += index_data_size;
 
     scheduler.Record(
         [this, index_offset = index_offset, index_type = index_type](vk::CommandBuffer cmdbuf) {
@@ -426,11 +557,7 @@ void RasterizerVulkan::SetupIndexArray() {
         });
 }
 
-void RasterizerVulkan::DrawTriangles() {
-    if (vertex_batch.empty()) {
-        return;
-    }
-
+void RasterizerVulkan::DrawVertexBatch() {
     pipeline_info.rasterization.topology.Assign(Pica::PipelineRegs::TriangleTopology::List);
     pipeline_info.vertex_layout = software_layout;
 
@@ -442,6 +569,7 @@ void RasterizerVulkan::DrawTriangles() {
 
 bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(Vulkan_Drawing);
+    draw_stats.issued++;
 
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
     const bool has_stencil = regs.framebuffer.HasStencil();
@@ -492,9 +620,9 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
     SyncTextureUnits(framebuffer);
 
     // Sync and bind the shader
-    if (shader_dirty) {
+    if (True(dirty_regs & DirtyRegs::FragmentConfig)) {
         pipeline_cache.UseFragmentShader(regs);
-        shader_dirty = false;
+        dirty_regs &= ~DirtyRegs::FragmentConfig;
     }
 
     // Sync the LUTs within the texture buffer
@@ -734,6 +862,18 @@ void RasterizerVulkan::FlushRegion(PAddr addr, u32 size) {
     res_cache.FlushRegion(addr, size);
 }
 
+bool RasterizerVulkan::IsRegionDirty(PAddr addr, u32 size) const {
+    return res_cache.IsRegionDirty(addr, size);
+}
+
+void RasterizerVulkan::TrackRegion(PAddr addr, u32 size, bool track) {
+    res_cache.TrackRegion(addr, size, track);
+}
+
+u64 RasterizerVulkan::GetWriteTick(PAddr addr, u32 size) const {
+    return res_cache.GetWriteTick(addr, size);
+}
+
 void RasterizerVulkan::InvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size);
 }
@@ -744,6 +884,8 @@ void RasterizerVulkan::FlushAndInvalidateRegion(PAddr addr, u32 size) {
 }
 
 void RasterizerVulkan::ClearAll(bool flush) {
+    ClearCachedUploads();
+    ClearIndexRanges();
     res_cache.ClearAll(flush);
 }
 
@@ -860,7 +1002,7 @@ void RasterizerVulkan::SyncBlendColor() {
 void RasterizerVulkan::SyncLogicOp() {
     if (instance.NeedsLogicOpEmulation()) {
         // We need this in the fragment shader to emulate logic operations
-        shader_dirty = true;
+        dirty_regs |= DirtyRegs::FragmentConfig;
     }
 
     pipeline_info.blending.logic_op = regs.framebuffer.output_merger.logic_op;
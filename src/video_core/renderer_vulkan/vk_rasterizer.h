@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <unordered_map>
+#include "common/hash.h"
 #include "core/hw/gpu.h"
 #include "video_core/rasterizer_accelerated.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
@@ -32,6 +34,14 @@ class RasterizerVulkan : public VideoCore::RasterizerAccelerated {
     friend class RendererVulkan;
 
 public:
+    /// Bytes of guest vertex and index data that were copied to or reused from the GPU.
+    struct UploadStats {
+        u64 vertex_bytes_uploaded{};
+        u64 vertex_bytes_reused{};
+        u64 index_bytes_uploaded{};
+        u64 index_bytes_reused{};
+    };
+
     explicit RasterizerVulkan(Memory::MemorySystem& memory,
                               VideoCore::CustomTexManager& custom_tex_manager,
                               Frontend::EmuWindow& emu_window, const Instance& instance,
@@ -42,7 +52,6 @@ public:
     void LoadDiskResources(const std::atomic_bool& stop_loading,
                            const VideoCore::DiskResourceLoadCallback& callback) override;
 
-    void DrawTriangles() override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
@@ -57,8 +66,53 @@ public:
 
     void SyncFixedState() override;
 
+    /// Marks the end of a frame, resets the upload and draw counters and trims the texture cache
+    void TickFrame();
+
+    /// Returns the upload counters of the last completed frame
+    const UploadStats& GetUploadStats() const noexcept {
+        return last_upload_stats;
+    }
+
 private:
+    /// Guest memory range of a vertex or index upload
+    struct UploadKey {
+        PAddr addr;
+        u32 size;
+        u32 stride;
+        u32 byte_count;
+
+        bool operator==(const UploadKey&) const noexcept = default;
+    };
+
+    struct UploadKeyHash {
+        std::size_t operator()(const UploadKey& key) const noexcept {
+            return Common::ComputeStructHash64(key);
+        }
+    };
+
+    /// Location of a previous upload inside the stream buffer
+    struct CachedUpload {
+        u64 offset;
+        u64 write_tick;
+        u64 cycle; ///< Stream buffer cycle the upload was made in
+    };
+
+    /// Arguments of the commands that draw an accelerated batch
+    struct DrawParams {
+        u32 vertex_count;
+        s32 vertex_offset;
+        u32 binding_count;
+        std::array<u32, 16> bindings;
+        bool is_indexed;
+    };
+
     void NotifyFixedFunctionPicaRegisterChanged(u32 id) override;
+    void DrawVertexBatch() override;
+    void DrawMergedBatch() override;
+    bool IsRegionDirty(PAddr addr, u32 size) const override;
+    void TrackRegion(PAddr addr, u32 size, bool track) override;
+    u64 GetWriteTick(PAddr addr, u32 size) const override;
 
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
@@ -113,12 +167,15 @@ private:
     /// Upload the uniform blocks to the uniform buffer object
     void UploadUniforms(bool accelerate_draw);
 
-    /// Generic draw function for DrawTriangles and AccelerateDrawBatch
+    /// Generic draw function for DrawVertexBatch and AccelerateDrawBatch
     bool Draw(bool accelerate, bool is_indexed);
 
     /// Internal implementation for AccelerateDrawBatch
     bool AccelerateDrawBatchInternal(bool is_indexed);
 
+    /// Records the binding of the vertex buffers and the draw of an accelerated batch
+    void RecordDraw(const DrawParams& params);
+
     /// Setup index array for AccelerateDrawBatch
     void SetupIndexArray();
 
@@ -128,6 +185,18 @@ private:
     /// Setup the fixed attribute emulation in vulkan
     void SetupFixedAttribs();
 
+    /// Returns the previous upload of the range if the guest has not written to it since
+    const CachedUpload* FindCachedUpload(const UploadKey& key);
+
+    /// Records an upload of the range at the provided stream buffer offset
+    void InsertCachedUpload(const UploadKey& key, u64 offset);
+
+    /// Drops the uploads not reused since before the previous stream buffer cycle
+    void EvictCachedUploads();
+
+    /// Drops the previous uploads and stops tracking the guest writes to their ranges
+    void ClearCachedUploads();
+
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
 
@@ -150,6 +219,7 @@ private:
     std::array<u32, 16> binding_offsets{};
     std::array<bool, 16> enable_attributes{};
     std::array<vk::Buffer, 16> vertex_buffers;
+    DrawParams held_draw{};
     PipelineInfo pipeline_info;
 
     StreamBuffer stream_buffer;     ///< Vertex+Index buffer
@@ -163,6 +233,10 @@ private:
     u64 uniform_size_aligned_vs;
     u64 uniform_size_aligned_fs;
     bool async_shaders{false};
+
+    std::unordered_map<UploadKey, CachedUpload, UploadKeyHash> upload_cache;
+    UploadStats upload_stats{};
+    UploadStats last_upload_stats{};
 };
 
 } // namespace Vulkan
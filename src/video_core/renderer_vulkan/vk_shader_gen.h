@@ -132,6 +132,7 @@ struct PicaFSConfigState {
  * two separate shaders sharing the same key.
  */
 struct PicaFSConfig : Common::HashableStruct<PicaFSConfigState> {
+    PicaFSConfig() = default;
     PicaFSConfig(const Pica::Regs& regs, const Instance& instance);
 
     bool TevStageUpdatesCombinerBufferColor(unsigned stage_index) const {
@@ -189,6 +190,7 @@ struct PicaShaderConfigCommon {
  * shader.
  */
 struct PicaVSConfig : Common::HashableStruct<PicaShaderConfigCommon> {
+    PicaVSConfig() = default;
     explicit PicaVSConfig(const Pica::RasterizerRegs& rasterizer, const Pica::ShaderRegs& regs,
                           Pica::Shader::ShaderSetup& setup, const Instance& instance);
     bool use_clip_planes;
@@ -214,6 +216,7 @@ struct PicaGSConfigCommonRaw {
  * shader pipeline
  */
 struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigCommonRaw> {
+    PicaFixedGSConfig() = default;
     explicit PicaFixedGSConfig(const Pica::Regs& regs, const Instance& instance);
     bool use_clip_planes;
 };
@@ -58,6 +58,7 @@ std::tuple<u8*, u64, bool> StreamBuffer::Map(u64 size, u64 alignment) {
     if (offset + size > stream_buffer_size) {
         // The buffer would overflow, save the amount of used watches and reset the state.
         invalidate = true;
+        ++cycle;
         invalidation_mark = current_watch_cursor;
         current_watch_cursor = 0;
         offset = 0;
@@ -74,6 +75,29 @@ std::tuple<u8*, u64, bool> StreamBuffer::Map(u64 size, u64 alignment) {
     return std::make_tuple(mapped + offset, offset, invalidate);
 }
 
+bool StreamBuffer::CanMap(u64 size, u64 alignment) const {
+    const u64 mapped_offset = alignment > 0 ? Common::AlignUp(offset, alignment) : offset;
+    const u64 mapped_upper_bound = mapped_offset + size;
+    if (mapped_upper_bound > stream_buffer_size) {
+        return false;
+    }
+    if (!invalidation_mark) {
+        return true;
+    }
+
+    // Waiting for a watch of the commands being recorded submits them
+    u64 bound = wait_bound;
+    for (std::size_t cursor = wait_cursor;
+         mapped_upper_bound > bound && cursor < *invalidation_mark; ++cursor) {
+        const Watch& watch = previous_watches[cursor];
+        if (watch.tick >= scheduler.CurrentTick()) {
+            return false;
+        }
+        bound = watch.upper_bound;
+    }
+    return true;
+}
+
 void StreamBuffer::Commit(u64 size) {
     ASSERT_MSG(size <= mapped_size, "Reserved size {} is too small compared to {}", mapped_size,
                size);
@@ -39,6 +39,10 @@ public:
      */
     std::tuple<u8*, u64, bool> Map(u64 size, u64 alignment);
 
+    /// Returns true if Map can reserve "size" bytes without wrapping around or submitting the
+    /// commands being recorded.
+    bool CanMap(u64 size, u64 alignment) const;
+
     /// Ensures that "size" bytes of memory are available to the GPU, potentially recording a copy.
     void Commit(u64 size);
 
@@ -50,6 +54,12 @@ public:
         return 0;
     }
 
+    /// Returns the number of times the buffer has wrapped around. Data committed during the
+    /// current cycle stays intact until the cycle changes.
+    u64 Cycle() const noexcept {
+        return cycle;
+    }
+
 private:
     struct Watch {
         u64 tick{};
@@ -77,6 +87,7 @@ private:
 
     u64 offset{};      ///< Buffer iterator.
     u64 mapped_size{}; ///< Size reserved for the current copy.
+    u64 cycle{};       ///< Number of times the buffer has wrapped around.
 
     std::vector<Watch> current_watches;           ///< Watches recorded in the current iteration.
     std::size_t current_watch_cursor{};           ///< Count of watches, reset on invalidation.
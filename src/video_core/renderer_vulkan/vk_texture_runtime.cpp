@@ -149,6 +149,16 @@ void TextureRuntime::Finish() {
     scheduler.Finish();
 }
 
+u64 TextureRuntime::Submit() {
+    const u64 tick = scheduler.CurrentTick();
+    scheduler.Flush();
+    return tick;
+}
+
+void TextureRuntime::Wait(u64 tick) {
+    scheduler.Wait(tick);
+}
+
 void TextureRuntime::Clear() {
     scheduler.Finish();
 
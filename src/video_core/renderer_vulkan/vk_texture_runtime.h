@@ -86,6 +86,9 @@ class TextureRuntime {
     friend class Sampler;
 
 public:
+    /// Downloads are recorded to the scheduler and can be waited on later
+    static constexpr bool ASYNC_DOWNLOADS = true;
+
     explicit TextureRuntime(const Instance& instance, Scheduler& scheduler,
                             RenderpassCache& renderpass_cache, DescriptorManager& desc_manager);
     ~TextureRuntime();
@@ -93,6 +96,18 @@ public:
     /// Causes a GPU command flush
     void Finish();
 
+    /// Submits the recorded commands without waiting and returns the tick they complete at
+    [[nodiscard]] u64 Submit();
+
+    /// Waits for the commands submitted before the provided tick to complete
+    void Wait(u64 tick);
+
+    /// Returns the number of times the download staging buffer has wrapped around.
+    /// Downloaded data stays intact as long as it does not change.
+    [[nodiscard]] u64 DownloadCycle() const noexcept {
+        return download_buffer.Cycle();
+    }
+
     /// Destroys runtime cached resources
     void Clear();
 